@@ -0,0 +1,147 @@
+// bench/bench_index.cpp
+
+/**
+ * @file bench_index.cpp
+ * @brief Memory footprint and lookup latency of @ref FlatIndex and
+ *        @ref EpochIndex against the `std::unordered_map<bytes, bytes>` they
+ *        replaced as the store's index.
+ *
+ * Loads the same small keys and values into each, counting the heap bytes
+ * each holds afterwards (through a replaced global `operator new`), then
+ * times random hits and misses.  Small records are where the map's node and
+ * two vector buffers per entry cost the most.  @ref EpochIndex lookups are
+ * timed with a pin each, as the store takes them.
+ *
+ * Usage: `bench_index [keys] [value_size]` (defaults: 1000000 keys, 16-byte values).
+ */
+
+#include "kv/epoch_index.h"
+#include "kv/flat_index.h"
+#include "core/types.h"     // bytes, to_bytes
+#include <algorithm>        // std::shuffle
+#include <chrono>           // std::chrono::steady_clock
+#include <cstddef>          // std::max_align_t
+#include <cstdio>           // std::printf
+#include <cstdlib>          // std::malloc, std::free
+#include <new>              // std::bad_alloc
+#include <random>           // std::mt19937_64
+#include <string>           // std::string, std::to_string, std::stoul
+#include <string_view>      // std::string_view
+#include <unordered_map>    // std::unordered_map
+#include <vector>           // std::vector
+
+namespace {
+
+/// Bytes currently allocated through the global `operator new`.
+size_t g_heap = 0;
+
+struct ByteVectorHash {
+    size_t operator()(const bytes &v) const noexcept {
+        return std::hash<std::string_view>{}({ reinterpret_cast<const char *>(v.data()), v.size() });
+    }
+};
+
+using Map = std::unordered_map<bytes, bytes, ByteVectorHash>;
+
+/// Keeps the optimiser from discarding a lookup.
+volatile size_t g_sink = 0;
+
+/**
+ * @brief Times @p lookup over every key of @p keys.
+ * @return Mean nanoseconds per lookup.
+ */
+template <typename F> double time_lookups(const std::vector<bytes> &keys, F &&lookup) {
+    auto start = std::chrono::steady_clock::now();
+    size_t found = 0;
+    for (const auto &key : keys) found += lookup(key);
+    auto stop = std::chrono::steady_clock::now();
+    g_sink = g_sink + found;
+    return std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(keys.size());
+}
+
+} // namespace
+
+// Size-prefixed so operator delete knows how much to subtract.  GCC traces
+// the pointer from operator new into the free() below and warns about it
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(size_t size) {
+    auto *p = static_cast<size_t *>(std::malloc(size + sizeof(std::max_align_t)));
+    if (!p) throw std::bad_alloc();
+    *p = size;
+    g_heap += size;
+    return reinterpret_cast<std::byte *>(p) + sizeof(std::max_align_t);
+}
+
+void operator delete(void *ptr) noexcept {
+    if (!ptr) return;
+    auto *p = reinterpret_cast<size_t *>(static_cast<std::byte *>(ptr) - sizeof(std::max_align_t));
+    g_heap -= *p;
+    std::free(p);
+}
+
+void operator delete(void *ptr, size_t) noexcept { operator delete(ptr); }
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete[](void *ptr) noexcept { operator delete(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { operator delete(ptr); }
+
+int main(int argc, char **argv) {
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const size_t value_size = argc > 2 ? std::stoul(argv[2]) : 16;
+
+    std::vector<bytes> keys, misses;
+    keys.reserve(count);
+    misses.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys.push_back(to_bytes("user:" + std::to_string(i * 7919)));
+        misses.push_back(to_bytes("miss:" + std::to_string(i)));
+    }
+    const bytes val(value_size, std::byte{'v'});
+    std::mt19937_64 rng(1);
+    std::vector<bytes> probes = keys;
+    std::shuffle(probes.begin(), probes.end(), rng);
+
+    size_t map_mem = 0, flat_mem = 0, epoch_mem = 0;
+    double map_hit = 0, map_miss = 0, flat_hit = 0, flat_miss = 0, epoch_hit = 0, epoch_miss = 0;
+    {
+        const size_t before = g_heap;
+        Map map;
+        for (const auto &key : keys) map.emplace(key, val);
+        map_mem = g_heap - before;
+        map_hit  = time_lookups(probes, [&](const bytes &key) { return map.find(key) != map.end(); });
+        map_miss = time_lookups(misses, [&](const bytes &key) { return map.find(key) != map.end(); });
+    }
+    {
+        const size_t before = g_heap;
+        FlatIndex index;
+        for (const auto &key : keys) index.put(key, val);
+        flat_mem = g_heap - before;
+        flat_hit  = time_lookups(probes, [&](const bytes &key) { return index.find(key).has_value(); });
+        flat_miss = time_lookups(misses, [&](const bytes &key) { return index.find(key).has_value(); });
+    }
+    {
+        const size_t before = g_heap;
+        EpochIndex index;
+        for (const auto &key : keys) index.put(key, val);
+        epoch_mem = g_heap - before;
+        auto pinned = [&](const bytes &key) {
+            auto pin = index.pin();
+            return index.find(key).has_value();
+        };
+        epoch_hit  = time_lookups(probes, pinned);
+        epoch_miss = time_lookups(misses, pinned);
+    }
+
+    std::printf("%zu keys, %zu-byte values\n", count, value_size);
+    std::printf("%-14s %10s %12s %10s %10s\n", "index", "MiB", "bytes/key", "hit ns", "miss ns");
+    auto row = [&](const char *name, size_t mem, double hit, double miss) {
+        std::printf("%-14s %10.1f %12.1f %10.1f %10.1f\n", name, static_cast<double>(mem) / (1024 * 1024),
+                    static_cast<double>(mem) / static_cast<double>(count), hit, miss);
+    };
+    row("unordered_map", map_mem, map_hit, map_miss);
+    row("FlatIndex", flat_mem, flat_hit, flat_miss);
+    row("EpochIndex", epoch_mem, epoch_hit, epoch_miss);
+    return 0;
+}
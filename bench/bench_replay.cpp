@@ -0,0 +1,68 @@
+// bench/bench_replay.cpp
+
+/**
+ * @file bench_replay.cpp
+ * @brief Time taken by @ref KeyValue::open to replay a log of small records.
+ *
+ * Restart time is dominated by replay, and replay by how the log is read.
+ * Writes the records once without syncing, then reopens the store a few
+ * times and reports the best and mean open time.
+ *
+ * Usage: `bench_replay [records] [dir] [threads]` (defaults: 1000000 records
+ * in the temp directory, replayed on one thread per core; `1` replays
+ * sequentially).
+ */
+
+#include "kv/kv.h"
+#include <algorithm>        // std::min
+#include <chrono>           // std::chrono::steady_clock
+#include <cstdio>           // std::printf, std::fprintf
+#include <filesystem>       // std::filesystem::temp_directory_path
+#include <string>           // std::string, std::to_string, std::stoul
+#include <thread>           // std::thread::hardware_concurrency
+
+int main(int argc, char **argv) {
+    size_t records = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    std::filesystem::path dir = argc > 2 ? argv[2] : std::filesystem::temp_directory_path();
+    const std::string path = (dir / "kvdb_bench_replay").string();
+    const unsigned threads = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : 0;
+    constexpr int RUNS = 5;
+
+    KeyValue::destroy(path);
+    {
+        KeyValue kv(path, { .sync_ = SyncPolicy::none(), .compaction_ = CompactionPolicy::manual() });
+        if (auto err = kv.open(); err) {
+            std::fprintf(stderr, "open: %s\n", err.message().c_str());
+            return 1;
+        }
+        const bytes val(32, std::byte{'v'});
+        for (size_t i = 0; i < records; ++i) {
+            if (auto result = kv.set(to_bytes("key" + std::to_string(i)), val); !result.has_value()) {
+                std::fprintf(stderr, "set: %s\n", result.error().message().c_str());
+                return 1;
+            }
+        }
+        kv.close();
+    }
+
+    double best = 1e300, sum = 0;
+    for (int run = 0; run < RUNS; ++run) {
+        KeyValue kv(path, { .sync_ = {}, .compaction_ = CompactionPolicy::manual(), .replay_threads_ = threads });
+        auto start = std::chrono::steady_clock::now();
+        auto err = kv.open();
+        auto stop = std::chrono::steady_clock::now();
+        if (err) {
+            std::fprintf(stderr, "open: %s\n", err.message().c_str());
+            return 1;
+        }
+        double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+        best = std::min(best, ms);
+        sum += ms;
+    }
+    KeyValue::destroy(path);
+
+    std::printf("%zu records, %u replay threads: open best %.1f ms, mean %.1f ms (%.0f ns/record)\n",
+                records, threads ? threads : std::thread::hardware_concurrency(), best, sum / RUNS,
+                best * 1e6 / static_cast<double>(records));
+    return 0;
+}
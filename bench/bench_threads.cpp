@@ -0,0 +1,117 @@
+// bench/bench_threads.cpp
+
+/**
+ * @file bench_threads.cpp
+ * @brief Throughput of a mixed get/set workload from 1 to 32 threads.
+ *
+ * Every thread draws random keys from a preloaded set and reads or writes
+ * them in the given proportion, with writes fully durable
+ * (@ref SyncMode::PerWrite).  Each thread count is run twice: calling the
+ * store directly, and through one outer mutex around every call, which is
+ * how a caller had to share a store before it was thread-safe.  Under the
+ * outer mutex a reader waits for whatever `fsync` is in progress; called
+ * directly, readers do not, and concurrent writers share one `fsync`.
+ *
+ * Usage: `bench_threads [seconds] [read_pct] [dir]` (defaults: 1 second per
+ * run, 90% reads, in the temp directory).
+ */
+
+#include "kv/kv.h"
+#include <atomic>           // std::atomic
+#include <chrono>           // std::chrono::steady_clock
+#include <cstdint>          // uint64_t
+#include <cstdio>           // std::printf, std::fprintf
+#include <filesystem>       // std::filesystem::temp_directory_path
+#include <mutex>            // std::mutex, std::unique_lock
+#include <random>           // std::mt19937_64
+#include <string>           // std::string, std::to_string
+#include <thread>           // std::thread
+#include <vector>           // std::vector
+
+namespace {
+
+constexpr size_t KEYS       = 10000;    ///< Keys preloaded and then drawn from.
+constexpr size_t VALUE_SIZE = 100;
+
+/**
+ * @brief Runs @p threads workers against @p kv for @p seconds.
+ * @param outer Mutex taken around every call, or null to call directly.
+ * @return Operations per second, or a negative number if the store failed.
+ */
+double run(KeyValue &kv, const std::vector<bytes> &keys, unsigned threads, double seconds, unsigned read_pct,
+           std::mutex *outer) {
+    std::atomic<bool> stop{ false };
+    std::atomic<bool> failed{ false };
+    std::atomic<uint64_t> ops{ 0 };
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937_64 rng(t + 1);
+            const bytes val(VALUE_SIZE, std::byte{ static_cast<unsigned char>('a' + t % 26) });
+            bytes out;
+            uint64_t done = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                const auto &key = keys[rng() % keys.size()];
+                const bool read = rng() % 100 < read_pct;
+                std::unique_lock<std::mutex> lock;
+                if (outer) lock = std::unique_lock(*outer);
+                const bool ok = read ? kv.get(key, out).has_value() : kv.set(key, val).has_value();
+                if (!ok) failed = true;
+                ++done;
+            }
+            ops += done;
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto &worker : workers) worker.join();
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return failed ? -1 : ops / elapsed;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const double seconds  = argc > 1 ? std::stod(argv[1]) : 1.0;
+    const unsigned read_pct = argc > 2 ? static_cast<unsigned>(std::stoul(argv[2])) : 90;
+    std::filesystem::path dir = argc > 3 ? argv[3] : std::filesystem::temp_directory_path();
+    const std::string path = (dir / "kvdb_bench_threads").string();
+    if (seconds <= 0 || read_pct > 100) return 1;
+
+    KeyValue::destroy(path);
+    KeyValue kv(path, { .sync_ = SyncPolicy::per_write(), .compaction_ = CompactionPolicy::manual() });
+    if (auto err = kv.open(); err) {
+        std::fprintf(stderr, "open: %s\n", err.message().c_str());
+        return 1;
+    }
+    std::vector<bytes> keys;
+    keys.reserve(KEYS);
+    WriteBatch load;
+    for (size_t i = 0; i < KEYS; ++i) {
+        keys.push_back(to_bytes("key" + std::to_string(i)));
+        load.put(keys.back(), bytes(VALUE_SIZE, std::byte{ 'v' }));
+    }
+    if (auto err = kv.write(load); err) {
+        std::fprintf(stderr, "write: %s\n", err.message().c_str());
+        return 1;
+    }
+
+    std::printf("%u%% reads, %zu keys, %zu-byte values, sync per write\n", read_pct, KEYS, VALUE_SIZE);
+    std::printf("%8s  %14s  %14s  %8s\n", "threads", "outer(ops/s)", "direct(ops/s)", "speedup");
+    std::mutex outer;
+    // Untimed pass so the first row does not pay for cold caches
+    run(kv, keys, 1, seconds, read_pct, nullptr);
+    for (unsigned threads : { 1u, 2u, 4u, 8u, 16u, 32u }) {
+        const double locked = run(kv, keys, threads, seconds, read_pct, &outer);
+        const double direct = run(kv, keys, threads, seconds, read_pct, nullptr);
+        if (locked < 0 || direct < 0) {
+            std::fprintf(stderr, "store failed\n");
+            return 1;
+        }
+        std::printf("%8u  %14.0f  %14.0f  %7.2fx\n", threads, locked, direct, direct / locked);
+    }
+    kv.close();
+    KeyValue::destroy(path);
+    return 0;
+}
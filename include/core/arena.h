@@ -0,0 +1,105 @@
+// include/core/arena.h
+#pragma once
+
+/**
+ * @file arena.h
+ * @brief Bump allocator that packs many small objects into large blocks.
+ */
+
+#include <cstddef>      // std::byte, size_t, std::max_align_t
+#include <cstdint>      // uintptr_t
+#include <memory>       // std::unique_ptr
+#include <utility>      // std::exchange
+#include <vector>       // std::vector
+
+/**
+ * @brief Hands out memory by bumping a pointer through large blocks.
+ *
+ * There is no per-object free: memory is returned all at once by
+ * @ref clear or by destroying the arena.  Owners that overwrite or drop
+ * objects track the garbage themselves and copy the survivors into a fresh
+ * arena when it is worth it (see @ref FlatIndex).  A request larger than a
+ * quarter block gets a block of its own, so the current block keeps
+ * serving small ones and nothing is ever split.
+ *
+ * @note Movable, not copyable; moving keeps every handed-out pointer valid.
+ */
+class Arena {
+    std::vector<std::unique_ptr<std::byte[]>> blocks_;
+    std::byte *cur_  = nullptr;     ///< Next free byte of the current block.
+    std::byte *end_  = nullptr;     ///< End of the current block.
+    size_t     used_     = 0;       ///< Bytes handed out, alignment padding included.
+    size_t     reserved_ = 0;       ///< Bytes held in blocks.
+
+public:
+    /** @brief Size of a regular block. */
+    static constexpr size_t BLOCK_SIZE = 256 * 1024;
+
+    Arena() = default;
+    /** @brief Takes over @p other's blocks, leaving it empty. */
+    Arena(Arena &&other) noexcept
+        : blocks_(std::move(other.blocks_)),
+          cur_(std::exchange(other.cur_, nullptr)),
+          end_(std::exchange(other.end_, nullptr)),
+          used_(std::exchange(other.used_, 0)),
+          reserved_(std::exchange(other.reserved_, 0)) {}
+
+    /** @brief Frees this arena's blocks and takes over @p other's. */
+    Arena &operator=(Arena &&other) noexcept {
+        if (this != &other) {
+            clear();
+            blocks_   = std::move(other.blocks_);
+            cur_      = std::exchange(other.cur_, nullptr);
+            end_      = std::exchange(other.end_, nullptr);
+            used_     = std::exchange(other.used_, 0);
+            reserved_ = std::exchange(other.reserved_, 0);
+        }
+        return *this;
+    }
+    /** @brief Deleted – blocks are owned uniquely. */
+    Arena(const Arena &)                = delete;
+    /** @brief Deleted – see copy constructor. */
+    Arena &operator=(const Arena &)     = delete;
+
+    /**
+     * @brief Returns @p size bytes aligned to @p align.
+     * @param size  Number of bytes; may be zero.
+     * @param align A power of two no larger than `alignof(std::max_align_t)`.
+     * @return Uninitialised memory that lives as long as the arena (or until @ref clear).
+     */
+    std::byte *allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        if (size > BLOCK_SIZE / 4) {
+            // Blocks are aligned for any type
+            blocks_.push_back(std::make_unique_for_overwrite<std::byte[]>(size));
+            reserved_ += size;
+            used_ += size;
+            return blocks_.back().get();
+        }
+
+        auto pad = static_cast<size_t>(-reinterpret_cast<uintptr_t>(cur_) & (align - 1));
+        if (static_cast<size_t>(end_ - cur_) < pad + size) {
+            blocks_.push_back(std::make_unique_for_overwrite<std::byte[]>(BLOCK_SIZE));
+            cur_ = blocks_.back().get();
+            end_ = cur_ + BLOCK_SIZE;
+            reserved_ += BLOCK_SIZE;
+            pad = 0;
+        }
+        std::byte *out = cur_ + pad;
+        cur_ = out + size;
+        used_ += pad + size;
+        return out;
+    }
+
+    /** @brief Frees every block; all pointers handed out become invalid. */
+    void clear() noexcept {
+        blocks_.clear();
+        cur_ = end_ = nullptr;
+        used_ = reserved_ = 0;
+    }
+
+    /** @return Bytes handed out so far. */
+    size_t used() const noexcept { return used_; }
+
+    /** @return Bytes of memory held, including the unused end of the current block. */
+    size_t reserved() const noexcept { return reserved_; }
+};
@@ -3,8 +3,8 @@
 
 /**
  * @file bit_utils.h
- * @brief Low-level serialisation helpers: little-endian integer packing,
- *        length-prefixed string encoding, and IEEE 802.3 CRC-32 hashing.
+ * @brief Low-level serialisation helpers: little- and big-endian integer
+ *        packing, length-prefixed string encoding, and IEEE 802.3 CRC-32 hashing.
  */
 
 #include <bit>          // std::bit_cast, std::endian, std::byteswap
@@ -47,6 +47,36 @@ T unpack_le(std::span<const std::byte, sizeof(T)> buf) {
     return val;
 }
 
+// ---- Big-endian integer packing ----
+
+/**
+ * @brief Serialises an integral value to a fixed-size big-endian byte array,
+ *        so unsigned values compare with `memcmp` as they do numerically.
+ * @tparam T Any integral type.
+ * @param val The value to serialise.
+ * @return `std::array<std::byte, sizeof(T)>` in big-endian order.
+ */
+template <std::integral T>
+std::array<std::byte, sizeof(T)> pack_be(T val) {
+    if constexpr (std::endian::native != std::endian::big)
+        val = std::byteswap(val);
+    return std::bit_cast<std::array<std::byte, sizeof(T)>>(val);
+}
+
+/**
+ * @brief Deserialises a big-endian byte span into an integral value.
+ * @tparam T Any integral type.
+ * @param buf A fixed-size span of exactly `sizeof(T)` bytes.
+ * @return The deserialised value in native byte order.
+ */
+template <std::integral T>
+T unpack_be(std::span<const std::byte, sizeof(T)> buf) {
+    auto val = std::bit_cast<T>(*reinterpret_cast<const std::array<std::byte, sizeof(T)> *>(buf.data()));
+    if constexpr (std::endian::native != std::endian::big)
+        val = std::byteswap(val);
+    return val;
+}
+
 // ---- Byte buffer append helpers ----
 
 /**
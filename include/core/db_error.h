@@ -37,6 +37,13 @@ enum class db_error {
     unsupported_type,       // The handling of given type is not provided
     table_not_found,        // Seeking table does not exist
     table_already_exists,   // Seeking table already exists
+    bad_record_type,        // Log record carries an unknown type flag
+    bad_manifest,           // Segment manifest is truncated or fails its checksum
+    missing_segment,        // A segment listed in the manifest does not exist
+    bad_checkpoint,         // Index checkpoint is truncated or fails its checksum
+    bad_hint,               // Segment hint file is truncated, stale or fails its checksum
+    index_not_found,        // Seeking secondary index does not exist
+    row_not_found,          // Row named by an index entry no longer exists
 };
 
 /**
@@ -59,7 +66,7 @@ struct DBErrorCategory : std::error_category {
             case db_error::value_too_large:     return "Value size exceeds limit";
             case db_error::io_failure:          return "I/O failure";
             case db_error::bad_magic:           return "File is not a valid kvdb log (magic number mismatch)";
-            case db_error::unsupported_version: return "Log file format version is newer than this build supports";
+            case db_error::unsupported_version: return "File or key format version is newer than this build supports";
             case db_error::bad_checksum:        return "Entry checksum mismatch, data is possibly corrupt";
             case db_error::bad_key:             return "Key prefix does not match table ID";
             case db_error::trailing_garbage:    return "Unexpected bytes remain after decoding";
@@ -70,6 +77,13 @@ struct DBErrorCategory : std::error_category {
             case db_error::unsupported_type:    return "This Cell type is not supported, add proper implementation";
             case db_error::table_not_found:     return "The table with given ID is not found";
             case db_error::table_already_exists:return "The table with given ID already exists";
+            case db_error::bad_record_type:     return "Log record carries an unknown type flag";
+            case db_error::bad_manifest:        return "Segment manifest is truncated or fails its checksum";
+            case db_error::missing_segment:     return "A log segment listed in the manifest does not exist";
+            case db_error::bad_checkpoint:      return "Index checkpoint is truncated or fails its checksum";
+            case db_error::bad_hint:            return "Segment hint file is truncated, stale or fails its checksum";
+            case db_error::index_not_found:     return "The table has no secondary index with given name";
+            case db_error::row_not_found:       return "The row named by an index entry no longer exists";
             default:                            return "Unknown database error";
         }
     }
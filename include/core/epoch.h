@@ -0,0 +1,110 @@
+// include/core/epoch.h
+#pragma once
+
+/**
+ * @file epoch.h
+ * @brief Epoch-based reclamation: frees memory that lock-free readers may
+ *        still be looking at once none of them can be.
+ */
+
+#include <atomic>       // std::atomic
+#include <cstddef>      // size_t
+#include <cstdint>      // uint64_t
+#include <memory>       // std::unique_ptr
+#include <utility>      // std::exchange
+#include <vector>       // std::vector
+
+/**
+ * @brief Tracks which readers might still hold pointers to retired objects.
+ *
+ * A reader @ref pin "pins" the domain for the duration of a lookup: it
+ * announces the current global epoch in a slot of its own, on its own cache
+ * line, and clears it when the @ref Guard goes out of scope.  Nothing else
+ * is written on the read path, so concurrent readers share no written cache
+ * line.
+ *
+ * A writer first unpublishes an object (so no new reader can reach it),
+ * then hands it to @ref retire, which tags it with the current epoch and
+ * advances the epoch.  A reader that announced a later epoch pinned after
+ * the object was unpublished and cannot have seen it; so the object is
+ * freed once every announced epoch is later than its tag.  Unpublishing
+ * must be a sequentially consistent store, matching the one in @ref pin.
+ *
+ * @note @ref pin is thread-safe.  @ref retire, @ref collect and
+ *       @ref pending must be serialised by the caller (there is one writer
+ *       at a time).  Neither copyable nor movable: guards point at it.
+ */
+class EpochDomain {
+    /// A reader's announcement; zero when not pinned.
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch_{ 0 };
+    };
+
+    /// An object waiting to be freed.
+    struct Retired {
+        uint64_t epoch_;            ///< Epoch when it was retired.
+        void    *ptr_;
+        void   (*free_)(void *);
+    };
+
+    std::atomic<uint64_t>   epoch_{ 1 };    ///< Global epoch; zero is reserved for "not pinned".
+    std::unique_ptr<Slot[]> slots_;
+    std::vector<Retired>    retired_;       ///< In retirement order, so in epoch order.
+
+    /** @brief Queues @p ptr, freed by @p free, and runs @ref collect. */
+    void retire(void *ptr, void (*free)(void *));
+
+public:
+    /** @brief Reader slots; more concurrent readers than this wait for a free one. */
+    static constexpr size_t SLOTS = 128;
+
+    /** @brief Keeps everything reachable at the time of @ref pin alive until destroyed. */
+    class Guard {
+        friend class EpochDomain;
+        EpochDomain::Slot *slot_;
+        explicit Guard(EpochDomain::Slot *slot) noexcept : slot_(slot) {}
+
+    public:
+        /** @brief Takes over @p other's pin. */
+        Guard(Guard &&other) noexcept : slot_(std::exchange(other.slot_, nullptr)) {}
+        /** @brief Deleted – a pin has a single owner. */
+        Guard(const Guard &)            = delete;
+        /** @brief Deleted – see copy constructor. */
+        Guard &operator=(const Guard &) = delete;
+        Guard &operator=(Guard &&)      = delete;
+        /** @brief Unpins. */
+        ~Guard() {
+            if (slot_) slot_->epoch_.store(0, std::memory_order_release);
+        }
+    };
+
+    EpochDomain();
+    /** @brief Frees every retired object; no @ref Guard may be alive. */
+    ~EpochDomain();
+    EpochDomain(const EpochDomain &)            = delete;
+    EpochDomain &operator=(const EpochDomain &) = delete;
+
+    /**
+     * @brief Pins the calling thread.
+     *
+     * Each thread starts at a slot of its own, so it usually finds it free
+     * and claims it with one uncontended compare-and-swap.  Pins may nest.
+     *
+     * @return A guard; pointers loaded after this call stay valid until it is destroyed.
+     */
+    [[nodiscard]] Guard pin() noexcept;
+
+    /**
+     * @brief Hands over @p obj, already unreachable for new readers, to be
+     *        deleted once no reader can still be using it.
+     */
+    template <typename T> void retire(std::unique_ptr<T> obj) {
+        retire(obj.release(), [](void *ptr) { delete static_cast<T *>(ptr); });
+    }
+
+    /** @brief Frees every retired object that no pinned reader can reach. */
+    void collect() noexcept;
+
+    /** @return Number of retired objects not yet freed. */
+    size_t pending() const noexcept { return retired_.size(); }
+};
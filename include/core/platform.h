@@ -14,6 +14,7 @@
 #include <system_error> // std::error_code
 #include <string>       // std::string
 #include <span>         // std::span
+#include <cstdint>      // uint64_t
 #include "core/reader.h"
 
 #if defined(_WIN32)
@@ -38,6 +39,20 @@ std::error_code platform_open_file(const std::string &path, FileHandle &out);
  */
 std::error_code platform_write(FileHandle &fh, std::span<const std::byte> buf);
 
+/**
+ * @brief Writes every buffer in @p bufs, back to back, at the current file position.
+ *
+ * Scatter-gather counterpart of @ref platform_write: the pieces of a record
+ * (or of a whole group of records) reach the file without first being
+ * copied into one contiguous buffer.  Short writes are resumed until
+ * everything is written.
+ *
+ * @param fh   An open file handle.
+ * @param bufs Buffers to write in order; empty buffers are allowed.
+ * @return Empty error code on success; OS error otherwise.
+ */
+std::error_code platform_writev(FileHandle &fh, std::span<const std::span<const std::byte>> bufs);
+
 /**
  * @brief Reads up to `buf.size()` bytes from @p fh into @p buf.
  * @param fh         An open file handle.
@@ -47,6 +62,53 @@ std::error_code platform_write(FileHandle &fh, std::span<const std::byte> buf);
  */
 std::error_code platform_read(FileHandle &fh, std::span<std::byte> buf, size_t &bytes_read);
 
+/**
+ * @brief Reads up to `buf.size()` bytes starting at byte @p offset of @p fh.
+ *
+ * Positional: the shared file position is neither used nor (on POSIX)
+ * moved, so reads at independent offsets need no seek.  Returns fewer than
+ * `buf.size()` bytes only at end of file.
+ *
+ * @param fh         An open file handle.
+ * @param buf        Destination span.
+ * @param offset     Absolute byte offset to read from.
+ * @param bytes_read Set to the number of bytes actually read (0 at or past EOF).
+ * @return Empty error code on success or EOF; OS error otherwise.
+ */
+std::error_code platform_pread(FileHandle &fh, std::span<std::byte> buf, uint64_t offset, size_t &bytes_read);
+
+/**
+ * @brief Writes all bytes in @p buf at byte @p offset of @p fh.
+ *
+ * Positional counterpart of @ref platform_write; short writes are resumed.
+ *
+ * @param fh     An open file handle.
+ * @param buf    Data to write; must be written in full.
+ * @param offset Absolute byte offset to write at; the file grows as needed.
+ * @return Empty error code on success; OS error otherwise.
+ */
+std::error_code platform_pwrite(FileHandle &fh, std::span<const std::byte> buf, uint64_t offset);
+
+/**
+ * @brief Writes every buffer in @p bufs, back to back, starting at byte @p offset.
+ *
+ * Positional counterpart of @ref platform_writev.
+ *
+ * @param fh     An open file handle.
+ * @param bufs   Buffers to write in order; empty buffers are allowed.
+ * @param offset Absolute byte offset of the first byte.
+ * @return Empty error code on success; OS error otherwise.
+ */
+std::error_code platform_pwritev(FileHandle &fh, std::span<const std::span<const std::byte>> bufs, uint64_t offset);
+
+/**
+ * @brief Sets the size of @p fh to exactly @p size bytes.
+ * @param fh   An open file handle.
+ * @param size New file size; data past it is discarded.
+ * @return Empty error code on success; OS error otherwise.
+ */
+std::error_code platform_truncate(FileHandle &fh, uint64_t size);
+
 /**
  * @brief Repositions the file pointer of @p fh.
  * @param fh     An open file handle.
@@ -63,6 +125,88 @@ std::error_code platform_seek(FileHandle &fh, long offset, int whence);
  */
 std::error_code platform_sync(FileHandle &fh);
 
+/**
+ * @brief Flushes the data of @p fh, and only the metadata needed to read it
+ *        back (`fdatasync` / `FlushFileBuffers`).
+ *
+ * Cheaper than @ref platform_sync when the file size has not changed since
+ * the last sync, e.g. when writing into space reserved by
+ * @ref platform_allocate.  Falls back to a full sync where the OS has no
+ * data-only variant.
+ *
+ * @param fh An open file handle.
+ * @return Empty error code on success; OS error otherwise.
+ */
+std::error_code platform_datasync(FileHandle &fh);
+
+/**
+ * @brief Reserves disk space for `[offset, offset + len)` of @p fh and grows
+ *        the file to cover it.
+ *
+ * The new range reads back as zeros, and writes into it change no file
+ * size.  The blocks are only reserved, not written: the first write into
+ * each one still marks it written, and the next @ref platform_datasync has
+ * to journal that.  Callers that want data-only syncs afterwards write the
+ * range once themselves.
+ *
+ * @param fh     An open file handle.
+ * @param offset Start of the range.
+ * @param len    Length of the range in bytes.
+ * @return Empty error code on success; `std::errc::operation_not_supported`
+ *         where the filesystem cannot reserve space, or another OS error.
+ */
+std::error_code platform_allocate(FileHandle &fh, uint64_t offset, uint64_t len);
+
+/**
+ * @brief Tells the OS that @p fh is read front to back and that
+ *        `[offset, offset + len)` is about to be read.
+ *
+ * Purely a hint (`posix_fadvise` / `F_RDADVISE`): the kernel can start
+ * reading the range into the page cache while the caller is still busy with
+ * the data before it.  A no-op where the OS has no such hint.
+ *
+ * @param fh     An open file handle.
+ * @param offset Start of the range about to be read.
+ * @param len    Length of the range in bytes.
+ * @return Empty error code on success; OS error otherwise.  Callers may
+ *         ignore it: reads behave the same either way.
+ */
+std::error_code platform_readahead(FileHandle &fh, uint64_t offset, uint64_t len);
+
+/**
+ * @brief Maps the first @p size bytes of @p fh read-only into memory.
+ *
+ * Lets a caller decode a whole file in place instead of copying it through
+ * read buffers.  The mapping is advised for sequential access.  Mapping
+ * zero bytes succeeds without a syscall and yields an empty mapping.
+ *
+ * @param fh   An open file handle.
+ * @param size Number of bytes to map; must not exceed the file size.
+ * @param out  Receives the mapping; any previous mapping in it is released.
+ * @return Empty error code on success; OS error otherwise.
+ */
+std::error_code platform_map(FileHandle &fh, uint64_t size, FileMapping &out);
+
+/**
+ * @brief Releases the mapping held by @p map.
+ * @param map The mapping to release; left empty.
+ * @return Empty error code on success; OS error otherwise.
+ */
+std::error_code platform_unmap(FileMapping &map);
+
+/**
+ * @brief Atomically replaces the file at @p to with the file at @p from.
+ *
+ * On success the rename itself is durable: the directory entry change is
+ * flushed (`fsync` on the parent directory / `MOVEFILE_WRITE_THROUGH`).
+ * Neither file should be open on Windows.
+ *
+ * @param from Existing file to rename.
+ * @param to   Destination path; replaced if it exists.
+ * @return Empty error code on success; OS error otherwise.
+ */
+std::error_code platform_rename(const std::string &from, const std::string &to);
+
 /**
  * @brief Closes @p fh and releases the underlying OS resource.
  * @param fh The handle to close; left in a safe, unopened state.
@@ -10,8 +10,11 @@
 #include <span>         // std::span
 #include <system_error> // std::error_code
 #include <cstddef>      // std::byte
+#include <cstdint>      // uint64_t
 #include <string>       // std::string (forward-used by friend declarations)
 
+class FileMapping;
+
 /**
  * @brief Owns a POSIX file descriptor and exposes the platform I/O interface.
  *
@@ -60,10 +63,56 @@ public:
 private:
     friend std::error_code platform_open_file(const std::string &, FileHandle &);
     friend std::error_code platform_write    (FileHandle &, std::span<const std::byte>);
+    friend std::error_code platform_writev   (FileHandle &, std::span<const std::span<const std::byte>>);
     friend std::error_code platform_read     (FileHandle &, std::span<std::byte>, size_t &);
+    friend std::error_code platform_pread    (FileHandle &, std::span<std::byte>, uint64_t, size_t &);
+    friend std::error_code platform_pwrite   (FileHandle &, std::span<const std::byte>, uint64_t);
+    friend std::error_code platform_pwritev  (FileHandle &, std::span<const std::span<const std::byte>>, uint64_t);
+    friend std::error_code platform_truncate (FileHandle &, uint64_t);
     friend std::error_code platform_seek     (FileHandle &, long, int);
     friend std::error_code platform_sync     (FileHandle &);
+    friend std::error_code platform_datasync (FileHandle &);
+    friend std::error_code platform_allocate (FileHandle &, uint64_t, uint64_t);
+    friend std::error_code platform_readahead(FileHandle &, uint64_t, uint64_t);
+    friend std::error_code platform_map      (FileHandle &, uint64_t, FileMapping &);
     friend std::error_code platform_close    (FileHandle &);
 };
 
 static_assert(Reader<FileHandle>, "FileHandle must satisfy the Reader concept");
+
+/**
+ * @brief Owns a read-only `mmap` of the start of a file.
+ *
+ * Non-copyable (a copy would unmap twice); movable.  The bytes stay
+ * readable after the @ref FileHandle they came from is closed, but reading
+ * past the end of a file that shrank since it was mapped raises `SIGBUS`.
+ */
+class FileMapping {
+    const std::byte *data_ = nullptr;
+    size_t           size_ = 0;
+
+    void swap(FileMapping &other) noexcept;
+
+public:
+    FileMapping() = default;
+
+    /** @brief Unmaps silently; prefer @ref platform_unmap for error handling. */
+    ~FileMapping();
+
+    /** @brief Deleted – two owners of one mapping would unmap it twice. */
+    FileMapping(const FileMapping &) = delete;
+    /** @brief Deleted – see copy constructor. */
+    FileMapping &operator=(const FileMapping &) = delete;
+
+    /** @brief Transfers ownership from @p other; leaves @p other empty. */
+    FileMapping(FileMapping &&other) noexcept;
+    /** @brief Move-assigns by swapping through a temporary; safely unmaps any existing mapping. */
+    FileMapping &operator=(FileMapping &&other) noexcept;
+
+    /** @return The mapped bytes; empty when nothing is mapped. */
+    std::span<const std::byte> data() const noexcept { return { data_, size_ }; }
+
+private:
+    friend std::error_code platform_map  (FileHandle &, uint64_t, FileMapping &);
+    friend std::error_code platform_unmap(FileMapping &);
+};
@@ -0,0 +1,141 @@
+// include/core/small_key.h
+#pragma once
+
+/**
+ * @file small_key.h
+ * @brief Owning byte-string key that keeps short keys inline.
+ */
+
+#include <algorithm>    // std::equal
+#include <cstddef>      // std::byte, size_t
+#include <cstdint>      // uint16_t
+#include <cstring>      // std::memcpy
+#include <functional>   // std::hash
+#include <span>         // std::span
+#include <string_view>  // std::string_view
+#include <utility>      // std::exchange
+
+/**
+ * @brief A copy of a binary key that needs no heap allocation when the key
+ *        is at most @ref INLINE_CAPACITY bytes long.
+ *
+ * The object is 24 bytes, the size of a `bytes` vector that would always
+ * allocate.  Short keys, such as the 13-byte keys of a table row, live in
+ * the object itself; longer ones are spilled to the heap and the pointer is
+ * kept in the inline buffer.  Keys are limited to 64 KiB, well above
+ * @ref EntryCodec::MAX_KEY_SIZE.
+ *
+ * Hashing with @ref SmallKeyHash and comparing with `==` agree with plain
+ * spans, so containers keyed by `SmallKey` can be probed without building one.
+ */
+class SmallKey {
+public:
+    /** @brief Longest key stored without a heap allocation. */
+    static constexpr size_t INLINE_CAPACITY = 22;
+
+private:
+    std::byte buf_[INLINE_CAPACITY];    ///< The key, or the address of its heap copy.
+    uint16_t  size_ = 0;
+
+    std::byte *heap() const noexcept {
+        std::byte *ptr;
+        std::memcpy(&ptr, buf_, sizeof(ptr));
+        return ptr;
+    }
+
+    void assign(std::span<const std::byte> key) {
+        size_ = static_cast<uint16_t>(key.size());
+        if (key.size() <= INLINE_CAPACITY) {
+            if (!key.empty()) std::memcpy(buf_, key.data(), key.size());
+            return;
+        }
+        auto *ptr = new std::byte[key.size()];
+        std::memcpy(ptr, key.data(), key.size());
+        std::memcpy(buf_, &ptr, sizeof(ptr));
+    }
+
+    void release() noexcept {
+        if (size_ > INLINE_CAPACITY) delete[] heap();
+        size_ = 0;
+    }
+
+public:
+    SmallKey() noexcept = default;
+
+    /** @brief Copies @p key. @pre `key.size()` fits in 16 bits. */
+    explicit SmallKey(std::span<const std::byte> key) { assign(key); }
+
+    SmallKey(const SmallKey &other) { assign(other.view()); }
+
+    /** @brief Takes over @p other's heap copy, if any, leaving it empty. */
+    SmallKey(SmallKey &&other) noexcept : size_(std::exchange(other.size_, 0)) {
+        std::memcpy(buf_, other.buf_, sizeof(buf_));
+    }
+
+    SmallKey &operator=(const SmallKey &other) {
+        if (this != &other) {
+            release();
+            assign(other.view());
+        }
+        return *this;
+    }
+
+    SmallKey &operator=(SmallKey &&other) noexcept {
+        if (this != &other) {
+            release();
+            std::memcpy(buf_, other.buf_, sizeof(buf_));
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ~SmallKey() { release(); }
+
+    /** @return Pointer to the first byte of the key. */
+    const std::byte *data() const noexcept { return size_ <= INLINE_CAPACITY ? buf_ : heap(); }
+
+    /** @return Length of the key in bytes. */
+    size_t size() const noexcept { return size_; }
+
+    /** @return `true` if the key is stored in the object itself. */
+    bool is_inline() const noexcept { return size_ <= INLINE_CAPACITY; }
+
+    /** @return The key as a span, valid while this object is unchanged. */
+    std::span<const std::byte> view() const noexcept { return { data(), size_ }; }
+
+    /** @brief Implicit conversion so a `SmallKey` can be passed wherever a key span is expected. */
+    operator std::span<const std::byte>() const noexcept { return view(); }
+
+    /** @brief Byte-wise equality with another key. */
+    friend bool operator==(const SmallKey &a, const SmallKey &b) noexcept { return a == b.view(); }
+
+    /** @brief Byte-wise equality with a key held elsewhere. */
+    friend bool operator==(const SmallKey &a, std::span<const std::byte> b) noexcept {
+        return a.size() == b.size() && std::equal(b.begin(), b.end(), a.data());
+    }
+};
+
+static_assert(sizeof(SmallKey) == 24);
+
+/**
+ * @brief Transparent hasher for @ref SmallKey: a key and a span of the same
+ *        bytes hash alike, so lookups by span need no temporary key.
+ */
+struct SmallKeyHash {
+    using is_transparent = void;
+
+    size_t operator()(std::span<const std::byte> key) const noexcept {
+        return std::hash<std::string_view>{}(
+            std::string_view(reinterpret_cast<const char *>(key.data()), key.size()));
+    }
+    size_t operator()(const SmallKey &key) const noexcept { return (*this)(key.view()); }
+};
+
+/** @brief Transparent equality matching @ref SmallKeyHash. */
+struct SmallKeyEqual {
+    using is_transparent = void;
+
+    bool operator()(const SmallKey &a, const SmallKey &b) const noexcept { return a == b; }
+    bool operator()(const SmallKey &a, std::span<const std::byte> b) const noexcept { return a == b; }
+    bool operator()(std::span<const std::byte> a, const SmallKey &b) const noexcept { return b == a; }
+};
@@ -0,0 +1,75 @@
+// include/kv/checkpoint.h
+#pragma once
+
+/**
+ * @file checkpoint.h
+ * @brief Snapshot of the @ref KeyValue index, so that open replays only
+ *        the log written after it.
+ *
+ * Wire format (all integers little-endian):
+ * ```
+ * [ magic(4) | version(2) | segment(8) | offset(8) | dead(8) | count(8)
+ *   | ( klen(4) | vlen(4) | key | val ) * count | cksum(4) ]
+ * ```
+ * `segment`/`offset` is the @ref LogPosition the snapshot covers and `dead`
+ * the dead-byte counter at that point.  The CRC-32 (IEEE 802.3) covers every
+ * byte before the checksum.  The file is written to a temporary, `fsync`ed
+ * and renamed, so it is always either the previous checkpoint or the new one.
+ */
+
+#include "kv/log.h"         // LogPosition, Log::Emit
+#include <cstdint>          // uint64_t, uint32_t, uint16_t
+#include <string>           // std::string
+#include <span>             // std::span
+#include <functional>       // std::function
+#include <expected>         // std::expected
+#include <system_error>     // std::error_code
+
+/**
+ * @brief Reads and writes index checkpoint files.
+ *
+ * Stateless; the struct groups the format constants with the two
+ * operations, like @ref EntryCodec.
+ */
+struct Checkpoint {
+    /** @brief Four-byte signature (`'K','V','C','P'` = `0x4B564350`). */
+    static constexpr uint32_t MAGIC   = 0x4B564350;
+    /** @brief Checkpoint format revision. */
+    static constexpr uint16_t VERSION = 1;
+
+    /** @brief What a checkpoint records besides the key-value pairs. */
+    struct Info {
+        LogPosition position_;      ///< Log position the snapshot covers.
+        uint64_t    dead_bytes_;    ///< Dead-byte counter at @ref position_.
+        uint64_t    count_;         ///< Number of key-value pairs.
+    };
+
+    /**
+     * @brief Writes a checkpoint to @p path, replacing any previous one.
+     * @param path    Destination file.
+     * @param info    Header fields; `count_` must match what @p produce emits.
+     * @param produce Emits every live key-value pair through the callback it
+     *                is given, stopping at the first error that returns.
+     * @return Empty on success; the producer's error, or an I/O error.
+     *         On failure the previous checkpoint is left in place.
+     */
+    static std::error_code write(const std::string &path, const Info &info,
+                                 const std::function<std::error_code(const Log::Emit &)> &produce);
+
+    /**
+     * @brief Loads the checkpoint at @p path.
+     *
+     * The whole file is verified before @p visit is called, so a damaged
+     * checkpoint hands out nothing.  Key and value spans point into a
+     * mapping of the file and are valid only during the call.
+     *
+     * @param path  Checkpoint file.
+     * @param visit Called with every key-value pair.
+     * @return The header fields; an I/O error (e.g. `no_such_file_or_directory`),
+     *         @ref db_error::bad_magic, @ref db_error::unsupported_version or
+     *         @ref db_error::bad_checkpoint otherwise.
+     */
+    static std::expected<Info, std::error_code> load(
+        const std::string &path,
+        const std::function<void(std::span<const std::byte>, std::span<const std::byte>)> &visit);
+};
@@ -7,6 +7,19 @@
  */
 
 #include "core/types.h" // bytes
+#include <span>         // std::span
+
+/**
+ * @brief A key-value record decoded in place: key and value point into the
+ *        buffer it was decoded from (see @ref EntryCodec::decode_view).
+ *
+ * Valid only as long as that buffer is; copy it into an @ref Entry to keep it.
+ */
+struct EntryView {
+    std::span<const std::byte> key_;            ///< The record's binary key.
+    std::span<const std::byte> val_;            ///< The record's binary value; empty for tombstones.
+    bool                       deleted_ = false; ///< `true` if this record is a deletion tombstone.
+};
 
 /**
  * @brief A single key-value record, optionally marked as a tombstone.
@@ -31,6 +44,13 @@ struct Entry {
     Entry(bytes key, bytes val, bool deleted)
         : key_(std::move(key)), val_(std::move(val)), deleted_(deleted) {}
 
+    /**
+     * @brief Copies the record @p view points at.
+     * @param view A decoded record whose buffer is still alive.
+     */
+    explicit Entry(const EntryView &view)
+        : key_(to_bytes(view.key_)), val_(to_bytes(view.val_)), deleted_(view.deleted_) {}
+
     /**
      * @brief Equality comparison; all three fields must match.
      * @param other The entry to compare against.
@@ -13,9 +13,18 @@
  * The CRC-32 (IEEE 802.3) covers every byte from `klen` onward (i.e. the
  * checksum field itself is excluded from the digest).
  * Deleted entries (tombstones) omit the value payload (`vlen` is written as 0).
+ *
+ * A @ref WriteBatch is framed as one record with `flag = FLAG_BATCH`,
+ * `klen = 0` and a `vlen`-byte body holding every operation:
+ * ```
+ * [ cksum(4) | 0(4) | vlen(4) | 2(1) | count(4) | ( klen(4) | vlen(4) | flag(1) | key | val ) * count ]
+ * ```
+ * The single checksum covers the whole body, so a batch decodes completely
+ * or not at all.
  */
 
 #include "kv/entry.h"
+#include "kv/write_batch.h"
 #include "core/types.h"
 #include "core/db_error.h"
 #include "core/bit_utils.h"
@@ -25,6 +34,7 @@
 #include <span>         // std::span
 #include <array>        // std::array
 #include <expected>     // std::expected
+#include <algorithm>    // std::all_of
 
 /** @brief Sentinel returned by @ref EntryCodec::decode when the stream is exhausted. */
 struct EntryEOF {};
@@ -32,10 +42,34 @@ struct EntryEOF {};
 /**
  * @brief Result type of @ref EntryCodec::decode.
  *
- * Contains either a decoded @ref Entry, an @ref EntryEOF sentinel, or an
- * `std::error_code` on failure.
+ * Contains either a decoded @ref Entry, a decoded @ref WriteBatch, an
+ * @ref EntryEOF sentinel, or an `std::error_code` on failure.
+ */
+using DecodeResult = std::expected<std::variant<Entry, WriteBatch, EntryEOF>, std::error_code>;
+
+/**
+ * @brief A batch record decoded in place by @ref EntryCodec::decode_view.
+ *
+ * Holds the already verified body; @ref for_each walks its operations as
+ * @ref EntryView objects pointing into the same buffer.
+ */
+struct BatchView {
+    std::span<const std::byte> body_;   ///< The batch body: `count(4) | op * count`.
+
+    /**
+     * @brief Calls @p fn with every operation of the batch, in order.
+     * @tparam F Callable as `fn(const EntryView &)`.
+     */
+    template <typename F> void for_each(F &&fn) const;
+};
+
+/**
+ * @brief Result type of @ref EntryCodec::decode_view.
+ *
+ * Like @ref DecodeResult, but the record points into the decoded buffer
+ * instead of owning a copy of it.
  */
-using DecodeResult = std::expected<std::variant<Entry, EntryEOF>, std::error_code>;
+using ViewResult = std::expected<std::variant<EntryView, BatchView, EntryEOF>, std::error_code>;
 
 /**
  * @brief Stateless codec for the Entry binary format.
@@ -52,11 +86,42 @@ struct EntryCodec {
     static constexpr size_t HEADER_SIZE  = FLAG_OFFSET  + 1;        ///< Total header size in bytes.
     /** @} */
 
+    /** @name Record flags (value of the byte at @ref FLAG_OFFSET) @{ */
+    static constexpr uint8_t FLAG_PUT    = 0;   ///< A regular key-value entry.
+    static constexpr uint8_t FLAG_DELETE = 1;   ///< A tombstone; carries no value bytes.
+    static constexpr uint8_t FLAG_BATCH  = 2;   ///< A @ref WriteBatch frame.
+    /** @} */
+
+    /** @brief Size of the operation count that opens a batch body. */
+    static constexpr size_t BATCH_COUNT_SIZE = 4;
+
+    /** @brief Size of a batch operation's header: `klen(4) | vlen(4) | flag(1)`. */
+    static constexpr size_t BATCH_OP_HEADER_SIZE = HEADER_SIZE - KLEN_OFFSET;
+
     /** @name Safety limits @{ */
-    static constexpr size_t MAX_KEY_SIZE = 1024;            ///< Maximum permitted key size (1 KiB).
-    static constexpr size_t MAX_VAL_SIZE = 1024 * 1024;     ///< Maximum permitted value size (1 MiB).
+    static constexpr size_t MAX_KEY_SIZE   = 1024;              ///< Maximum permitted key size (1 KiB).
+    static constexpr size_t MAX_VAL_SIZE   = 1024 * 1024;       ///< Maximum permitted value size (1 MiB).
+    static constexpr size_t MAX_BATCH_SIZE = 64 * 1024 * 1024;  ///< Maximum permitted batch body size (64 MiB).
     /** @} */
 
+    /** @brief A record header, built on the stack by @ref encode_header. */
+    using Header = std::array<std::byte, HEADER_SIZE>;
+
+    /**
+     * @brief Builds the header of a put or tombstone record without copying the payload.
+     *
+     * The CRC-32 is computed over the header fields from @ref KLEN_OFFSET on
+     * and then directly over @p key and @p val, so the complete record is the
+     * returned header followed by @p key and (unless @p deleted) @p val —
+     * ready for a scatter-gather write.
+     *
+     * @param key     Key bytes.
+     * @param val     Value bytes; ignored for tombstones.
+     * @param deleted `true` to build a tombstone header (`vlen = 0`).
+     * @return The filled 13-byte header.
+     */
+    static Header encode_header(std::span<const std::byte> key, std::span<const std::byte> val, bool deleted) noexcept;
+
     /**
      * @brief Serialises @p ent into a heap-allocated byte buffer.
      *
@@ -71,19 +136,67 @@ struct EntryCodec {
     static bytes encode(const Entry &ent);
 
     /**
-     * @brief Deserialises the next entry from @p reader.
+     * @brief Serialises every operation of @p batch into one batch record.
+     *
+     * @param batch The operations to frame; must not be empty.
+     * @return The complete on-disk representation, or @ref db_error::key_too_large /
+     *         @ref db_error::value_too_large if an operation or the whole body
+     *         exceeds the safety limits that @ref decode enforces.
+     */
+    static std::expected<bytes, std::error_code> encode(const WriteBatch &batch);
+
+    /**
+     * @brief Deserialises the next record from @p reader.
      *
      * Reads the fixed-size header first, then the variable-length payload.
-     * Validates the CRC-32 checksum before constructing the @ref Entry.
+     * Validates the CRC-32 checksum before constructing the @ref Entry or,
+     * for a batch frame, the @ref WriteBatch.
      * Returns @ref EntryEOF when the reader signals EOF on the very first
-     * byte of the header (i.e. a clean end-of-log).
+     * byte of the header (i.e. a clean end-of-log), or when the header bytes
+     * are all zero (the preallocated, unwritten tail of a log segment).
      *
      * @tparam R Any type satisfying the @ref Reader concept.
      * @param reader Source of raw bytes (typically a @ref FileHandle).
-     * @return A @ref DecodeResult holding the decoded @ref Entry, @ref EntryEOF,
-     *         or an `std::error_code` on failure.
+     * @return A @ref DecodeResult holding the decoded @ref Entry, @ref WriteBatch,
+     *         @ref EntryEOF, or an `std::error_code` on failure.
      */
     template <Reader R> static DecodeResult decode(R &reader);
+
+    /**
+     * @brief Decodes the record at @p offset of @p data without copying it.
+     *
+     * Same checks and results as @ref decode, but the returned
+     * @ref EntryView or @ref BatchView points into @p data.  This is the
+     * replay path over a memory-mapped segment: each byte is then copied
+     * once, into the index, instead of into a temporary payload and again
+     * into an @ref Entry.
+     *
+     * @param data   The whole buffer (typically a mapped log segment).
+     * @param offset Offset of the record; advanced past it on success.
+     * @return The record, @ref EntryEOF at the end of @p data or at an
+     *         all-zero header, or the error @ref decode would report.
+     */
+    static ViewResult decode_view(std::span<const std::byte> data, size_t &offset);
+
+    /**
+     * @brief Walks the operations of a batch body.
+     * @tparam F Callable as `fn(const EntryView &)`.
+     * @param body The batch body (after the record header).
+     * @param fn   Called with each operation in order.
+     * @return Empty on success; @ref db_error::truncated_payload,
+     *         @ref db_error::bad_record_type or @ref db_error::trailing_garbage
+     *         if the body is malformed (@p fn may have seen a prefix of it).
+     */
+    template <typename F> static std::error_code for_each_batch_op(std::span<const std::byte> body, F &&fn);
+
+private:
+    /**
+     * @brief Parses a verified batch body into its operations.
+     * @param body The checksummed bytes following a batch frame header.
+     * @return The decoded batch, or @ref db_error::truncated_payload /
+     *         @ref db_error::trailing_garbage if the body is malformed.
+     */
+    static std::expected<WriteBatch, std::error_code> decode_batch_body(std::span<const std::byte> body);
 };
 
 template <Reader R> DecodeResult EntryCodec::decode(R &reader) {
@@ -95,19 +208,26 @@ template <Reader R> DecodeResult EntryCodec::decode(R &reader) {
         return std::unexpected(err);
     if (bytes_read == 0)
         return EntryEOF{};
-    else if (bytes_read < EntryCodec::HEADER_SIZE)
+    // Zeros where a header should be: the preallocated, never-written tail
+    // of a log segment.  No real record has an all-zero header, because the
+    // checksum of its zero-length fields is non-zero.
+    if (std::all_of(header.begin(), header.begin() + bytes_read, [](std::byte b) { return b == std::byte{0}; }))
+        return EntryEOF{};
+    if (bytes_read < EntryCodec::HEADER_SIZE)
         return std::unexpected(db_error::truncated_header);
 
     // Unpack the header
     uint32_t stored_cksum = unpack_le<uint32_t>(std::span<const std::byte>(header).subspan<EntryCodec::CKSUM_OFFSET, 4>());
     uint32_t klen = unpack_le<uint32_t>(std::span<const std::byte>(header).subspan<EntryCodec::KLEN_OFFSET, 4>());
     uint32_t vlen = unpack_le<uint32_t>(std::span<const std::byte>(header).subspan<EntryCodec::VLEN_OFFSET, 4>());
-    uint32_t is_deleted = (header[EntryCodec::FLAG_OFFSET] != std::byte{0});
+    uint8_t  flag = static_cast<uint8_t>(header[EntryCodec::FLAG_OFFSET]);
+    bool is_batch   = (flag == FLAG_BATCH);
+    bool is_deleted = (flag == FLAG_DELETE);
 
     // Impose data limits
     if (klen > MAX_KEY_SIZE)
         return std::unexpected(db_error::key_too_large);
-    if (vlen > MAX_VAL_SIZE)
+    if (vlen > (is_batch ? MAX_BATCH_SIZE : MAX_VAL_SIZE))
         return std::unexpected(db_error::value_too_large);
 
     // Read the payload into a buffer
@@ -127,6 +247,15 @@ template <Reader R> DecodeResult EntryCodec::decode(R &reader) {
     if (crc32_final(c_cksum) != stored_cksum)
         return std::unexpected(db_error::bad_checksum);
 
+    // The flag is covered by the checksum, so an unknown value here is not corruption
+    if (flag > FLAG_BATCH || (is_batch && klen != 0))
+        return std::unexpected(db_error::bad_record_type);
+    if (is_batch) {
+        auto batch = decode_batch_body(payload);
+        if (!batch.has_value()) return std::unexpected(batch.error());
+        return std::move(batch.value());
+    }
+
     // Unpack the payload
     Entry ent;
     ent.deleted_ = is_deleted;
@@ -135,3 +264,35 @@ template <Reader R> DecodeResult EntryCodec::decode(R &reader) {
 
     return ent;
 }
+
+template <typename F> std::error_code EntryCodec::for_each_batch_op(std::span<const std::byte> body, F &&fn) {
+    auto count = read_u32(body);
+    if (!count) return db_error::truncated_payload;
+
+    for (uint32_t i = 0; i < *count; ++i) {
+        if (body.size() < BATCH_OP_HEADER_SIZE)
+            return db_error::truncated_payload;
+        uint32_t klen = *read_u32(body);
+        uint32_t vlen = *read_u32(body);
+        uint8_t  flag = static_cast<uint8_t>(body[0]);
+        body = body.subspan<1>();
+
+        if (flag != FLAG_PUT && flag != FLAG_DELETE)
+            return db_error::bad_record_type;
+        bool deleted = (flag == FLAG_DELETE);
+        size_t op_size = size_t{klen} + (deleted ? 0 : vlen);
+        if (body.size() < op_size)
+            return db_error::truncated_payload;
+
+        fn(EntryView{ body.first(klen), deleted ? std::span<const std::byte>{} : body.subspan(klen, vlen), deleted });
+        body = body.subspan(op_size);
+    }
+
+    if (!body.empty()) return db_error::trailing_garbage;
+    return {};
+}
+
+template <typename F> void BatchView::for_each(F &&fn) const {
+    // Verified by decode_view, so this cannot fail
+    EntryCodec::for_each_batch_op(body_, std::forward<F>(fn));
+}
@@ -0,0 +1,157 @@
+// include/kv/epoch_index.h
+#pragma once
+
+/**
+ * @file epoch_index.h
+ * @brief Hash index from binary keys to binary values whose lookups take
+ *        no lock, with memory reclaimed through an @ref EpochDomain.
+ */
+
+#include "core/arena.h"     // Arena
+#include "core/epoch.h"     // EpochDomain
+#include <atomic>           // std::atomic
+#include <cstddef>          // std::byte, size_t
+#include <cstdint>          // uint32_t
+#include <memory>           // std::unique_ptr
+#include <optional>         // std::optional
+#include <span>             // std::span
+
+/**
+ * @brief Chained hash index that one writer updates while any number of
+ *        readers look keys up without locking.
+ *
+ * Layout:
+ * - A *table* holds a power-of-two array of bucket heads and the @ref Arena
+ *   its *records* live in.  A record is `next | hash(4) | klen(4) |
+ *   vlen(4) | key | value`, one bump allocation, and is never modified
+ *   after it is linked in, apart from its `next` pointer.
+ * - An overwrite links a new record in place of the old one, an erase
+ *   unlinks it: one release store each, so a reader walking the chain sees
+ *   either the old or the new state, never a torn value.
+ *
+ * Replaced and erased records stay in the arena as garbage.  When the load
+ * passes one record per bucket, or garbage makes up half of the arena, the
+ * live records are copied into a fresh table, which is published with one
+ * store; the old table (buckets, arena and all) is retired to the
+ * index's @ref EpochDomain and freed once no reader can be inside it.  So
+ * only whole tables are ever reclaimed, never single records.
+ *
+ * Compared with @ref FlatIndex, a lookup follows a bucket pointer instead
+ * of probing control bytes, and an overwrite always appends; in exchange
+ * readers neither lock nor write any shared cache line.
+ *
+ * @note Writers (@ref put, @ref erase, @ref clear) must be serialised by
+ *       the caller.  @ref find is safe concurrently with them while the
+ *       caller holds a guard from @ref pin; spans it returns stay valid
+ *       until that guard is destroyed.  A caller that instead keeps
+ *       writers out (as the writer itself does) needs no guard.
+ *       Neither copyable nor movable.
+ */
+class EpochIndex {
+    /// Header of a record in the arena; the key and then the value follow it.
+    struct Record {
+        std::atomic<Record *> next_;    ///< Next record in the bucket.
+        uint32_t hash_;                 ///< Low bits of the key's hash, compared before the key.
+        uint32_t klen_;                 ///< Key length.
+        uint32_t vlen_;                 ///< Value length.
+
+        const std::byte *data() const noexcept { return reinterpret_cast<const std::byte *>(this + 1); }
+        std::span<const std::byte> key() const noexcept { return { data(), klen_ }; }
+        std::span<const std::byte> val() const noexcept { return { data() + klen_, vlen_ }; }
+        /// Arena bytes the record occupies.
+        size_t footprint() const noexcept { return sizeof(Record) + klen_ + vlen_; }
+    };
+
+    /// One version of the index; readers hold on to it through their pin.
+    struct Table {
+        std::unique_ptr<std::atomic<Record *>[]> buckets_;
+        size_t mask_;       ///< Bucket count minus one.
+        Arena  arena_;
+
+        explicit Table(size_t buckets);
+        /** @brief Copies @p key and @p val into a new record in @ref arena_, not yet linked. */
+        Record *make_record(std::span<const std::byte> key, std::span<const std::byte> val, size_t hash);
+    };
+
+    std::atomic<Table *> table_{ nullptr }; ///< Current table; null while empty.
+    size_t size_    = 0;                    ///< Live records.
+    size_t garbage_ = 0;                    ///< Arena bytes held by dead records.
+    mutable EpochDomain epochs_;
+
+    /**
+     * @brief Finds the link that points at @p key's record in @p table.
+     * @return The link, or the null link at the end of the chain if absent.
+     */
+    static std::atomic<Record *> &find_link(Table &table, std::span<const std::byte> key, size_t hash) noexcept;
+
+    /** @brief Copies the live records into a table of @p buckets, publishes it and retires the old one. */
+    void rebuild(size_t buckets);
+
+    /** @brief Notes that @p rec is dead and rebuilds once that pays off. */
+    void retire(const Record *rec);
+
+public:
+    /** @brief Smallest bucket count. */
+    static constexpr size_t MIN_BUCKETS = 16;
+
+    EpochIndex() = default;
+    /** @brief Frees every table; no reader may be pinned. */
+    ~EpochIndex();
+    EpochIndex(const EpochIndex &)            = delete;
+    EpochIndex &operator=(const EpochIndex &) = delete;
+
+    /**
+     * @brief Pins the calling thread for lock-free @ref find calls.
+     * @return A guard that keeps every record seen from now on alive until it is destroyed.
+     */
+    [[nodiscard]] EpochDomain::Guard pin() const noexcept { return epochs_.pin(); }
+
+    /**
+     * @brief Looks up @p key.
+     * @return A view of its value, or `std::nullopt` if absent.
+     */
+    std::optional<std::span<const std::byte>> find(std::span<const std::byte> key) const noexcept;
+
+    /** @return `true` if @p key is present. */
+    bool contains(std::span<const std::byte> key) const noexcept { return find(key).has_value(); }
+
+    /**
+     * @brief Inserts @p key with @p val, or overwrites its value.
+     * @return The length of the value it replaced, or `std::nullopt` if @p key was new.
+     */
+    std::optional<size_t> put(std::span<const std::byte> key, std::span<const std::byte> val);
+
+    /**
+     * @brief Removes @p key.
+     * @return The length of its value, or `std::nullopt` if it was absent.
+     */
+    std::optional<size_t> erase(std::span<const std::byte> key);
+
+    /** @brief Removes every entry; memory is freed once no reader is pinned. */
+    void clear();
+
+    /** @return Number of entries. */
+    size_t size() const noexcept { return size_; }
+
+    /** @return `true` if there are no entries. */
+    bool empty() const noexcept { return size_ == 0; }
+
+    /** @return Bytes of heap memory held by the current table: buckets and arena blocks. */
+    size_t memory_usage() const noexcept {
+        const Table *table = table_.load(std::memory_order_relaxed);
+        return table ? (table->mask_ + 1) * sizeof(std::atomic<Record *>) + table->arena_.reserved() : 0;
+    }
+
+    /**
+     * @brief Calls @p fn with every entry, in no particular order.  Caller keeps writers out.
+     * @tparam F Callable as `fn(std::span<const std::byte> key, std::span<const std::byte> val)`.
+     */
+    template <typename F> void for_each(F &&fn) const {
+        const Table *table = table_.load(std::memory_order_relaxed);
+        if (!table) return;
+        for (size_t i = 0; i <= table->mask_; ++i)
+            for (const Record *rec = table->buckets_[i].load(std::memory_order_relaxed); rec;
+                 rec = rec->next_.load(std::memory_order_relaxed))
+                fn(rec->key(), rec->val());
+    }
+};
@@ -0,0 +1,139 @@
+// include/kv/flat_index.h
+#pragma once
+
+/**
+ * @file flat_index.h
+ * @brief Open-addressing hash index from binary keys to binary values,
+ *        with both packed into an @ref Arena.
+ */
+
+#include "core/arena.h"     // Arena
+#include <cstddef>          // std::byte, size_t
+#include <cstdint>          // uint8_t, uint32_t
+#include <memory>           // std::unique_ptr
+#include <optional>         // std::optional
+#include <span>             // std::span
+#include <utility>          // std::move
+
+/**
+ * @brief Swiss-table style hash index over byte-string keys and values.
+ *
+ * Layout:
+ * - A *control byte* per slot: `EMPTY`, `DELETED`, or the low 7 bits of the
+ *   key's hash (`h2`).  Slots are probed in groups of @ref GROUP_SIZE, and
+ *   one SSE2 compare (a portable loop elsewhere) finds every slot of a group
+ *   whose `h2` matches, so a lookup usually touches one group and compares
+ *   one key.
+ * - A slot is a single pointer to a *record* `klen(4) | vlen(4) | vcap(4) |
+ *   key | value` in the arena: one allocation-free bump per insert instead
+ *   of a map node plus two vector buffers.
+ *
+ * Overwriting with a value that fits the record's capacity is done in
+ * place; otherwise a new record is appended and the old one becomes
+ * garbage, as does an erased one.  Once garbage makes up half of the arena
+ * the live records are copied into a fresh one.  The table grows at 7/8 load.
+ *
+ * Spans handed out point into the arena and stay valid until the next
+ * non-const call.
+ *
+ * @note Not thread-safe; callers serialise access.  Movable, not copyable.
+ */
+class FlatIndex {
+    /// Header of a record in the arena; the key and then the value follow it.
+    struct Record {
+        uint32_t klen_;     ///< Key length.
+        uint32_t vlen_;     ///< Value length.
+        uint32_t vcap_;     ///< Bytes reserved for the value.
+
+        std::byte *data() noexcept { return reinterpret_cast<std::byte *>(this + 1); }
+        const std::byte *data() const noexcept { return reinterpret_cast<const std::byte *>(this + 1); }
+        std::span<const std::byte> key() const noexcept { return { data(), klen_ }; }
+        std::span<const std::byte> val() const noexcept { return { data() + klen_, vlen_ }; }
+        /// Arena bytes the record occupies.
+        size_t footprint() const noexcept { return sizeof(Record) + klen_ + vcap_; }
+    };
+
+    std::unique_ptr<uint8_t[]>  ctrl_;      ///< Control byte per slot.
+    std::unique_ptr<Record *[]> slots_;     ///< Record of each full slot.
+    size_t capacity_   = 0;                 ///< Slot count; zero or a power of two ≥ @ref GROUP_SIZE.
+    size_t size_       = 0;                 ///< Full slots.
+    size_t tombstones_ = 0;                 ///< `DELETED` slots.
+    Arena  arena_;
+    size_t garbage_    = 0;                 ///< Arena bytes held by dead records.
+
+    /**
+     * @brief Finds the slot of @p key.
+     * @return Its index, or @ref capacity_ if the key is absent.
+     */
+    size_t find_slot(std::span<const std::byte> key, size_t hash) const noexcept;
+
+    /** @return Index of the first free slot on @p hash's probe sequence. @pre The table has a free slot. */
+    size_t free_slot(size_t hash) const noexcept;
+
+    /** @brief Copies @p key and @p val into a new arena record. */
+    Record *make_record(std::span<const std::byte> key, std::span<const std::byte> val);
+
+    /** @brief Rebuilds the table with @p capacity slots, dropping tombstones. */
+    void rehash(size_t capacity);
+
+    /** @brief Notes that @p rec is dead and copies the arena once that pays off. */
+    void retire(const Record *rec);
+
+public:
+    /** @brief Slots probed together; one SSE2 register of control bytes. */
+    static constexpr size_t GROUP_SIZE = 16;
+
+    FlatIndex() = default;
+    /** @brief Takes over @p other's entries, leaving it empty. */
+    FlatIndex(FlatIndex &&other) noexcept { *this = std::move(other); }
+    /** @brief Drops this index's entries and takes over @p other's. */
+    FlatIndex &operator=(FlatIndex &&other) noexcept;
+    /** @brief Deleted – records are owned by the arena. */
+    FlatIndex(const FlatIndex &)                = delete;
+    /** @brief Deleted – see copy constructor. */
+    FlatIndex &operator=(const FlatIndex &)     = delete;
+
+    /**
+     * @brief Looks up @p key.
+     * @return A view of its value, or `std::nullopt` if absent.
+     */
+    std::optional<std::span<const std::byte>> find(std::span<const std::byte> key) const noexcept;
+
+    /** @return `true` if @p key is present. */
+    bool contains(std::span<const std::byte> key) const noexcept { return find(key).has_value(); }
+
+    /**
+     * @brief Inserts @p key with @p val, or overwrites its value.
+     * @return The length of the value it replaced, or `std::nullopt` if @p key was new.
+     */
+    std::optional<size_t> put(std::span<const std::byte> key, std::span<const std::byte> val);
+
+    /**
+     * @brief Removes @p key.
+     * @return The length of its value, or `std::nullopt` if it was absent.
+     */
+    std::optional<size_t> erase(std::span<const std::byte> key);
+
+    /** @brief Removes every entry and frees all memory. */
+    void clear() noexcept;
+
+    /** @return Number of entries. */
+    size_t size() const noexcept { return size_; }
+
+    /** @return `true` if there are no entries. */
+    bool empty() const noexcept { return size_ == 0; }
+
+    /** @return Bytes of heap memory held: control bytes, slots and arena blocks. */
+    size_t memory_usage() const noexcept {
+        return capacity_ * (sizeof(uint8_t) + sizeof(Record *)) + arena_.reserved();
+    }
+
+    /**
+     * @brief Calls @p fn with every entry, in no particular order.
+     * @tparam F Callable as `fn(std::span<const std::byte> key, std::span<const std::byte> val)`.
+     */
+    template <typename F> void for_each(F &&fn) const {
+        for (size_t i = 0; i < capacity_; ++i)
+            if (ctrl_[i] < 0x80) fn(slots_[i]->key(), slots_[i]->val());
+    }
+};
@@ -0,0 +1,67 @@
+// include/kv/hint.h
+#pragma once
+
+/**
+ * @file hint.h
+ * @brief Hint files: the key directory of one sealed log segment, without
+ *        the values, so that a disk-resident store opens without reading them.
+ *
+ * Wire format (all integers little-endian):
+ * ```
+ * [ magic(4) | version(2) | segment_size(8) | count(8)
+ *   | ( flag(1) | klen(4) | vlen(4) | record(8) | record_size(4) | val_offset(4) | key ) * count
+ *   | cksum(4) ]
+ * ```
+ * Every entry is one operation of the segment in log order (a batch record
+ * contributes one per operation): its @ref EntryCodec flag, key and the
+ * @ref ValueRef fields of its value.  `segment_size` is the length of the
+ * segment the hint describes; a hint that does not match its segment's
+ * size is ignored.  The CRC-32 (IEEE 802.3) covers every byte before the
+ * checksum.  Hints are derived data: a missing or damaged one only means the
+ * segment is scanned instead, so they are written without `fsync`.
+ */
+
+#include "kv/log.h"         // KeyRecord
+#include "core/types.h"     // bytes
+#include <cstdint>          // uint64_t, uint32_t, uint16_t
+#include <string>           // std::string
+#include <span>             // std::span
+#include <functional>       // std::function
+#include <system_error>     // std::error_code
+
+/**
+ * @brief Encodes and loads hint files.
+ *
+ * Stateless, like @ref Checkpoint.
+ */
+struct HintFile {
+    /** @brief Four-byte signature (`'K','V','H','T'` = `0x4B564854`). */
+    static constexpr uint32_t MAGIC   = 0x4B564854;
+    /** @brief Hint format revision. */
+    static constexpr uint16_t VERSION = 1;
+
+    /**
+     * @brief Encodes the hint of a segment.
+     * @param segment_size Length of the segment file.
+     * @param records      Its operations in log order.
+     * @return The complete hint file contents.
+     */
+    static bytes encode(uint64_t segment_size, std::span<const KeyRecord> records);
+
+    /**
+     * @brief Loads the hint at @p path for segment @p segment.
+     *
+     * The whole file is verified before @p visit is called, so a damaged
+     * hint hands out nothing.
+     *
+     * @param path         Hint file.
+     * @param segment      Id of the segment it describes; fills `ref_.record_.segment_`.
+     * @param segment_size Current length of that segment.
+     * @param visit        Called with every operation in log order.
+     * @return Empty on success; an I/O error (e.g. `no_such_file_or_directory`),
+     *         @ref db_error::bad_magic, @ref db_error::unsupported_version or
+     *         @ref db_error::bad_hint otherwise.
+     */
+    static std::error_code load(const std::string &path, uint64_t segment, uint64_t segment_size,
+                                const std::function<void(const KeyRecord &)> &visit);
+};
@@ -6,46 +6,168 @@
  * @brief Public interface of the @ref KeyValue store.
  */
 
+#include "core/small_key.h" // SmallKey
 #include "core/types.h"     // bytes, to_bytes
+#include "kv/epoch_index.h" // EpochIndex
+#include "kv/flat_index.h"  // FlatIndex
 #include "kv/log.h"         // Log
-#include <unordered_map>    // std::unordered_map
+#include "kv/options.h"     // KVOptions, ScanOptions
+#include "kv/radix_tree.h"  // RadixTree
+#include "kv/write_batch.h" // WriteBatch
+#include <condition_variable> // std::condition_variable_any
+#include <mutex>            // std::mutex
+#include <shared_mutex>     // std::shared_mutex
+#include <stop_token>       // std::stop_token
+#include <thread>           // std::jthread, std::thread::hardware_concurrency
+#include <algorithm>        // std::max
+#include <array>            // std::array
+#include <cstdint>          // uint64_t
 #include <expected>         // std::expected
+#include <functional>       // std::function
 #include <optional>         // std::optional
+#include <string>           // std::string
+#include <vector>           // std::vector
 #include <system_error>     // std::error_code
 #include <span>             // std::span
 
 /**
  * @brief Persistent, log-structured key-value store with an in-memory index.
  *
- * `KeyValue` combines an append-only @ref Log with a hash-map index:
+ * `KeyValue` combines an append-only @ref Log with a hash index (@ref EpochIndex,
+ * or @ref FlatIndex under @ref ValueStorage::Disk):
  * - **Writes** append an encoded @ref Entry to the log *and* update the index atomically
  *   (log first; a crash before the index update is recovered on next @ref open).
  * - **Reads** are served entirely from the in-memory index — no disk I/O.
- * - **Recovery** replays the full log on @ref open to rebuild the index.
+ *   Under @ref ValueStorage::Disk the index keeps only the keys and a
+ *   @ref ValueRef per value, and a read costs one positional read of the
+ *   record, checksum verified (a Bitcask-style *keydir*).
+ * - **Recovery** replays the log on @ref open to rebuild the index, starting
+ *   from the last @ref checkpoint when one is usable.
+ * - **Durability** follows the @ref SyncPolicy in @ref KVOptions; weaker
+ *   policies than `PerWrite` can be made durable on demand with @ref sync.
+ *
+ * - **Compaction** runs on a background thread when the dead bytes tracked
+ *   per write cross the @ref CompactionPolicy thresholds, or on demand via
+ *   @ref compact.  Foreground calls keep running meanwhile.  Writers only
+ *   wait while the active segment is sealed and the index is copied, both
+ *   under every stripe lock; the copy takes @ref mu_ only shared, so no
+ *   read waits for the seal or its syncs.
+ * - **Concurrency**: point reads of in-memory values take no lock; they
+ *   pin the @ref EpochIndex, which frees nothing a pinned reader can
+ *   still reach.  Other reads take @ref mu_ shared.  Writers take it
+ *   exclusively only to update the index, never across the log append or
+ *   its `fsync`.  What orders writes is a stripe lock per key hash
+ *   (@ref stripes_), held from the existence check through the append to
+ *   the index update, so writes to one key reach the log and the index in
+ *   the same order while writes to other keys append – and group-commit –
+ *   in parallel.
  *
  * Binary keys and values of arbitrary content are supported.
  *
- * @note Not copyable (owns a @ref Log which owns a file handle).
- *       Move-construction and move-assignment are implicitly available.
- * @note Not thread-safe. Callers must serialise concurrent access externally.
+ * @note Neither copyable nor movable (owns a @ref Log, which owns a file
+ *       handle and the group-commit queue, and the compactor thread).
+ * @note Thread-safe, except that @ref open and @ref close must not overlap
+ *       any other call.
  */
 class KeyValue {
+    Log              log_;
+    std::string      path_;             ///< Path the store was constructed with.
+    CompactionPolicy compaction_;
+    unsigned         replay_threads_;   ///< Resolved @ref KVOptions::replay_threads_.
+    ValueStorage     values_;           ///< Which of the two indexes below is in use.
+    EpochIndex       mem_;              ///< In-memory key→value index; read without @ref mu_.
+    FlatIndex        refs_;             ///< Key→@ref ValueRef index under @ref ValueStorage::Disk.
+    bool             ordered_;          ///< Whether @ref order_ is maintained.
+    RadixTree        order_;            ///< The keys of the index in byte order, for @ref scan.
+
+    uint64_t        live_bytes_  = 0;   ///< Encoded size of the records in @ref mem_.
+    uint64_t        dead_bytes_  = 0;   ///< Encoded size of superseded records and tombstones.
+    uint64_t        compactions_ = 0;   ///< Completed compactions since construction.
+    std::error_code compact_err_;       ///< Outcome of the last background compaction.
+
+    /// Guards the indexes and the counters: shared by readers, exclusive while an index changes.
+    mutable std::shared_mutex mu_;
+    /// Number of @ref stripes_; at most 64, so a set of stripes fits in a `uint64_t` mask.
+    static constexpr size_t WRITE_STRIPES = 64;
+    /// Serialise writers by key hash from their existence check to their index
+    /// update.  Taken in ascending order and always before @ref mu_.
+    std::array<std::mutex, WRITE_STRIPES> stripes_;
+    /// Serialises compactions (background and @ref compact).
+    std::mutex compact_mu_;
+    std::condition_variable_any compact_cv_;
+    bool compact_pending_ = false;      ///< Set by writers once a trigger fires.
+    std::jthread compactor_;            ///< Last member: stopped before the others are destroyed.
+
+    /// Pause after a failed background compaction before the next attempt.
+    static constexpr std::chrono::seconds COMPACT_RETRY_DELAY{1};
+
     /**
-     * @brief FNV-inspired hash adapter so that @ref bytes can key an `std::unordered_map`.
-     *
-     * Reinterprets the byte vector as a `std::string_view` and delegates to
-     * the standard string-view hasher, which typically uses a fast platform hash.
+     * @brief Applies one replayed or committed operation to @ref mem_ and
+     *        updates the live/dead byte counters.  Caller holds @ref mu_ exclusively.
+     * @param op A put, or a tombstone when `deleted_` is `true`; copied into the index.
      */
-    struct ByteVectorHash {
-        size_t operator()(const bytes &v) const noexcept {
-            return std::hash<std::string_view>{}(
-                std::string_view(reinterpret_cast<const char*>(v.data()), v.size())
-            );
-        }
-    };
+    void apply(const EntryView &op);
 
-    Log log_;
-    std::unordered_map<bytes, bytes, ByteVectorHash> mem_; ///< In-memory key→value index.
+    /**
+     * @brief The @ref ValueStorage::Disk counterpart of @ref apply: points
+     *        @p key at @p ref in @ref refs_.  Caller holds @ref mu_ exclusively.
+     * @param key     The operation's key.
+     * @param deleted `true` for a tombstone; @p ref is ignored then.
+     * @param ref     Where the value was written.
+     */
+    void apply_ref(std::span<const std::byte> key, bool deleted, const ValueRef &ref);
+
+    /**
+     * @brief Records every operation of @p batch, written at @p at, in
+     *        @ref refs_.  Caller holds @ref mu_ exclusively.
+     */
+    void apply_batch_refs(const WriteBatch &batch, const LogPosition &at);
+
+    /**
+     * @brief Appends @p batch and applies it to the index.  Caller holds the
+     *        stripes of the batch's keys, but not @ref mu_.
+     */
+    std::error_code write_locked(const WriteBatch &batch);
+
+    /** @return The bit of the stripe that serialises writes to @p key. */
+    static uint64_t stripe_of(std::span<const std::byte> key) noexcept;
+
+    /** @return The stripes of every key in @p batch. */
+    static uint64_t stripes_of(const WriteBatch &batch) noexcept;
+
+    /** @brief Locks the stripes in @p mask, in ascending order. */
+    void lock_stripes(uint64_t mask);
+
+    /** @brief Unlocks the stripes in @p mask. */
+    void unlock_stripes(uint64_t mask) noexcept;
+
+    /** @brief Wakes the compactor if a @ref CompactionPolicy trigger fires.  Caller holds @ref mu_ exclusively. */
+    void maybe_schedule_compaction();
+
+    /**
+     * @brief Snapshots the index and rewrites the log from it.
+     * @param stop Aborts the rewrite with `operation_canceled` when requested;
+     *             the old log is left untouched in that case.
+     * @return Empty error code on success; an I/O error otherwise.
+     */
+    std::error_code compact_now(std::stop_token stop);
+
+    /** @brief Body of @ref compactor_: waits for a trigger, compacts, repeats. */
+    void compaction_loop(std::stop_token stop);
+
+    /**
+     * @brief Loads the checkpoint into @ref mem_ and the counters.  Caller holds @ref mu_ exclusively.
+     * @return The log position to resume replay from, or `std::nullopt` if
+     *         there is no checkpoint or it cannot be used; the index is left
+     *         empty in that case.
+     */
+    std::optional<LogPosition> load_checkpoint();
+
+    /** @brief Points @ref order_ at the change @p key just made to the index.  Caller holds @ref mu_ exclusively. */
+    void track_order(std::span<const std::byte> key, bool deleted, bool existed);
+
+    /** @return Path of the checkpoint file of the store at @p path. */
+    static std::string checkpoint_path(const std::string &path) { return path + ".checkpoint"; }
 
 public:
     /**
@@ -54,38 +176,194 @@ public:
      * Does not open the file; call @ref open to initialise the store.
      *
      * @param path Filesystem path to the log file.
+     * @param opts Store options; the defaults sync before every write returns.
      */
-    explicit KeyValue(const std::string &path) : log_(path) {}
+    explicit KeyValue(const std::string &path, KVOptions opts = {})
+        : log_(path, opts.sync_, opts.segment_size_, opts.prealloc_size_, opts.values_ == ValueStorage::Disk), path_(path), compaction_(opts.compaction_),
+          replay_threads_(opts.replay_threads_ ? opts.replay_threads_ : std::max(std::thread::hardware_concurrency(), 1u)),
+          values_(opts.values_), ordered_(opts.ordered_) {}
 
     /** @brief Deleted – the underlying @ref Log owns a non-copyable file handle. */
     KeyValue(const KeyValue &)            = delete;
     /** @brief Deleted – see copy constructor. */
     KeyValue &operator=(const KeyValue &) = delete;
 
+    /**
+     * @brief Position in an ordered walk over a key range; see @ref scan.
+     *
+     * Entries are copied out of the store in batches, each taken under the
+     * index lock, and the next batch resumes after the last key handed out.
+     * The cursor therefore never blocks writers between batches and is
+     * never invalidated by them: keys come back in strict order, each at
+     * most once, with the value current when its batch was taken.  Writes
+     * made during the walk are seen if they land past the resume point.
+     *
+     * ```
+     * for (auto it = kv.scan_prefix(prefix); it.valid(); it.next())
+     *     use(it.key(), it.value());
+     * if (it.error()) ...
+     * ```
+     *
+     * @note Must not outlive the store.  Not thread-safe itself.
+     */
+    class Cursor {
+        friend class KeyValue;
+
+        const KeyValue      *kv_ = nullptr;
+        bytes                lower_;            ///< Inclusive lower bound.
+        std::optional<bytes> upper_;            ///< Exclusive upper bound; unbounded if empty.
+        ScanOptions          opts_;
+        std::vector<SmallKey> keys_;            ///< Keys of the current batch.
+        bytes                values_;           ///< Values of the current batch, back to back.
+        std::vector<size_t>  ends_;             ///< End of each value in @ref values_.
+        size_t               pos_      = 0;     ///< Current entry within the batch.
+        size_t               returned_ = 0;     ///< Entries handed out before this batch.
+        bool                 done_     = true;  ///< The range has nothing past this batch.
+        std::error_code      err_;
+
+    public:
+        /** @brief An exhausted cursor. */
+        Cursor() = default;
+
+        /** @return `true` while positioned on an entry. */
+        bool valid() const noexcept { return !err_ && pos_ < keys_.size(); }
+
+        /** @return Key of the current entry. @pre @ref valid. */
+        std::span<const std::byte> key() const noexcept { return keys_[pos_].view(); }
+
+        /** @return Value of the current entry, valid until @ref next. @pre @ref valid. */
+        std::span<const std::byte> value() const noexcept {
+            const size_t begin = pos_ ? ends_[pos_ - 1] : 0;
+            return std::span<const std::byte>(values_).subspan(begin, ends_[pos_] - begin);
+        }
+
+        /** @brief Moves to the next entry, fetching another batch when needed. @pre @ref valid. */
+        void next();
+
+        /** @return Why the walk ended early (e.g. a read failed), or empty. */
+        std::error_code error() const noexcept { return err_; }
+    };
+
+    /** @brief Snapshot of the store's space accounting, see @ref stats. */
+    struct Stats {
+        uint64_t        live_bytes_;        ///< Bytes a freshly compacted log would hold (excluding its header).
+        uint64_t        dead_bytes_;        ///< Bytes of superseded records and tombstones.
+        uint64_t        disk_bytes_;        ///< Size of all log segments, headers included.
+        size_t          segments_;          ///< Number of log segments.
+        uint64_t        compactions_;       ///< Completed compactions since construction.
+        std::error_code compaction_error_;  ///< Error of the last background compaction, if it failed.
+    };
+
     /**
      * @brief Opens the backing log and replays it to rebuild the in-memory index.
      *
      * Clears any previously loaded state before replaying, so calling `open`
-     * a second time performs a full reload.
+     * a second time performs a full reload.  If a @ref checkpoint exists and
+     * its log position is still part of the log, the index is loaded from it
+     * and only the records after that position are replayed; a missing,
+     * damaged or stale checkpoint falls back to a full replay.  With more than one
+     * @ref KVOptions::replay_threads_ the log is decoded in parallel
+     * (@ref Log::replay_parallel) and merged in log order, so the result is
+     * identical to a sequential replay.  Under @ref ValueStorage::Disk the
+     * index is rebuilt with @ref Log::replay_keys: sealed segments are read
+     * from their hint files, which hold no values, and only segments without
+     * a usable hint are scanned.  Starts the background
+     * compactor when the @ref CompactionPolicy enables it.
      *
      * @return Empty error code on success; a log or I/O error otherwise.
      */
     std::error_code open();
 
     /**
-     * @brief Flushes and closes the backing log.
+     * @brief Stops the compactor, then flushes and closes the backing log.
+     *
+     * A background compaction still in progress is abandoned; the old log
+     * stays authoritative.
+     *
      * @return Empty error code on success; an I/O error otherwise.
      */
     std::error_code close();
 
+    /**
+     * @brief Durability barrier: every write that returned before this call
+     *        is on stable storage once it returns successfully.
+     *
+     * Needed only under a @ref SyncPolicy weaker than `PerWrite`.
+     *
+     * @return Empty error code on success; an I/O error otherwise.
+     */
+    std::error_code sync();
+
     /**
      * @brief Looks up @p key in the in-memory index.
+     *
+     * Under @ref ValueStorage::Disk the value is then read from the log
+     * (see @ref Log::read_value).
+     *
      * @param key Binary key to search for.
      * @return `std::optional<bytes>` with the associated value if the key exists,
-     *         `std::nullopt` if not found, or an `std::error_code` on failure.
+     *         `std::nullopt` if not found, or an `std::error_code` on failure
+     *         (e.g. @ref db_error::bad_checksum for a damaged record).
      */
     std::expected<std::optional<bytes>, std::error_code> get(std::span<const std::byte> key) const;
 
+    /**
+     * @brief @ref get into a caller-owned buffer.
+     *
+     * The lookup itself never allocates, and @p out keeps its capacity, so
+     * a loop reusing one buffer stops allocating once it has held the
+     * largest value.
+     *
+     * @param key Binary key to search for.
+     * @param out Receives the value; left untouched if the key is absent.
+     * @return `true` if the key exists, `false` if not, or an
+     *         `std::error_code` on failure (with @p out unspecified).
+     */
+    std::expected<bool, std::error_code> get(std::span<const std::byte> key, bytes &out) const;
+
+    /**
+     * @brief Hands @p visit a view of the value of @p key without copying it.
+     *
+     * For in-memory values @p visit runs under the lookup with the index
+     * pinned and no lock held.  Concurrent writers keep relinking records,
+     * but the table the view points into is not freed while pinned, so the
+     * view stays valid; it must not outlive the call.  Keep @p visit short:
+     * a long pin holds back freeing the index's memory.  Under
+     * @ref ValueStorage::Disk the value is read from the log into a
+     * temporary buffer under the lock, and @p visit runs on that buffer
+     * after the lock is released.
+     *
+     * @param key   Binary key to search for.
+     * @param visit Called once with the value if the key exists; an error it
+     *              returns is passed on.
+     * @return `true` if the key exists and @p visit succeeded, `false` if
+     *         the key is absent, or the error of the read or of @p visit.
+     */
+    std::expected<bool, std::error_code> get_view(
+        std::span<const std::byte> key,
+        const std::function<std::error_code(std::span<const std::byte>)> &visit) const;
+
+    /**
+     * @brief Walks the keys in `[begin, end)` in byte order.
+     *
+     * Needs @ref KVOptions::ordered_.  Point lookups never use the ordered
+     * index, so they cost the same with or without it.
+     *
+     * @param begin Inclusive lower bound.
+     * @param end   Exclusive upper bound; `std::nullopt` for no bound.
+     * @param opts  Direction and entry limit.
+     * @return A cursor on the first entry of the range; its @ref Cursor::error
+     *         is `std::errc::operation_not_supported` without an ordered index.
+     */
+    Cursor scan(std::span<const std::byte> begin, std::optional<std::span<const std::byte>> end,
+                ScanOptions opts = {}) const;
+
+    /**
+     * @brief Walks the keys that start with @p prefix in byte order.
+     * @see scan
+     */
+    Cursor scan_prefix(std::span<const std::byte> prefix, ScanOptions opts = {}) const;
+
     /**
      * @brief Controls the insertion/update behaviour of @ref set_ex.
      */
@@ -99,7 +377,8 @@ public:
      * @brief Conditionally writes @p val for @p key according to @p mode.
      *
      * Persists to the log and updates the index only when the mode condition
-     * is satisfied.
+     * is satisfied.  Under @ref ValueStorage::Disk, telling whether the value
+     * differs reads the old one if it has the same length.
      *
      * @param key  Binary key.
      * @param val  Binary value to store.
@@ -125,4 +404,93 @@ public:
      *         was not present, or an `std::error_code` on I/O failure.
      */
     std::expected<bool, std::error_code> del(std::span<const std::byte> key);
+
+    /**
+     * @brief Atomically applies every operation in @p batch.
+     *
+     * The batch is appended as one checksummed log record and made durable
+     * with one `fsync` (subject to the @ref SyncPolicy); the index is then
+     * updated in batch order.  After a crash, replay applies either the whole
+     * batch or none of it.  Operations are unconditional: puts overwrite and
+     * deletes of missing keys are harmless.
+     *
+     * @param batch The operations to commit; an empty batch is a no-op.
+     * @return Empty error code on success; @ref db_error::key_too_large /
+     *         @ref db_error::value_too_large if an operation exceeds the log
+     *         limits, or an I/O error.  On error the index is unchanged.
+     */
+    std::error_code write(const WriteBatch &batch);
+
+    /**
+     * @brief Reads @p key and commits the batch @p build makes from it, as one atomic step.
+     *
+     * @p build is called with the current value of @p key (`std::nullopt` if
+     * absent) and an empty batch to fill.  No other write can land between
+     * the read and the commit, so read-dependent updates – such as keeping a
+     * secondary index in step with the row it points at – cannot race.
+     * The callback runs under the stripe lock of @p key and a shared index
+     * lock: it must not keep the span or call back into the store.  If the
+     * batch touches keys of other stripes, those are locked as well and
+     * @p build is called again with the value read under all of them.
+     *
+     * @param key   Key whose value @p build depends on.
+     * @param build Fills the batch; an error it returns aborts without writing.
+     * @return `true` if a batch was committed, `false` if @p build left it
+     *         empty, or the error from @p build, the read or the write.
+     */
+    std::expected<bool, std::error_code> read_modify_write(
+        std::span<const std::byte> key,
+        const std::function<std::error_code(std::optional<std::span<const std::byte>>, WriteBatch &)> &build);
+
+    /**
+     * @brief Rewrites the backing log so it holds only the live key set.
+     *
+     * Seals the active segment, then writes the current contents of the
+     * index into fresh segments that replace every sealed one in a single
+     * manifest update: every overwritten value and every tombstone is
+     * dropped.  Records appended meanwhile go to the new active segment,
+     * and a crash at any point leaves either the old or the new segments
+     * in force.  The in-memory index is unaffected.  Waits for a background compaction
+     * that is already running.
+     *
+     * @return Empty error code on success; an I/O error otherwise.
+     */
+    std::error_code compact();
+
+    /**
+     * @brief Writes a snapshot of the index so that the next @ref open
+     *        replays only the log written after it.
+     *
+     * Makes the log durable up to its current end and copies the index
+     * while holding writers back (readers keep going), then writes the
+     * copy to `<path>.checkpoint` (temporary file, `fsync`, rename) while
+     * writers run again.  A compaction rewrites the segments a checkpoint points into,
+     * so it removes the checkpoint; waits for one that is already running.
+     *
+     * @return Empty error code on success; `std::errc::operation_not_supported`
+     *         under @ref ValueStorage::Disk, whose index holds no values;
+     *         an I/O error otherwise.  On failure the previous checkpoint,
+     *         if any, stays in place.
+     */
+    std::error_code checkpoint();
+
+    /** @return The current live/dead byte counters, log size and compaction status. */
+    Stats stats() const;
+
+    /**
+     * @brief Deletes every file of the store at @p path: its checkpoint and
+     *        the log (see @ref Log::destroy).
+     * @param path Path the store was constructed with; it must not be open.
+     * @return Empty error code on success; an I/O error otherwise.
+     */
+    static std::error_code destroy(const std::string &path);
+
+private:
+    /// Most entries a @ref Cursor copies per batch.
+    static constexpr size_t SCAN_BATCH = 64;
+    /// Value bytes after which a batch ends early, so large values do not pile up.
+    static constexpr size_t SCAN_BATCH_BYTES = 1024 * 1024;
+
+    /** @brief Replaces @p cursor's batch with the entries that follow it. */
+    void fill(Cursor &cursor) const;
 };
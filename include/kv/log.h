@@ -7,9 +7,25 @@
  */
 
 #include "core/platform.h"
+#include "core/buffered_reader.h"   // BufferedReader
 #include "kv/entry_codec.h"
-#include <string>       // std::string
-#include <system_error> // std::error_code
+#include "kv/manifest.h"        // Manifest
+#include "kv/options.h"         // SyncPolicy
+#include <string>               // std::string
+#include <vector>               // std::vector
+#include <system_error>         // std::error_code
+#include <mutex>                // std::mutex, std::unique_lock
+#include <condition_variable>   // std::condition_variable, std::condition_variable_any
+#include <deque>                // std::deque
+#include <thread>               // std::jthread, std::stop_token
+#include <functional>           // std::function
+#include <variant>              // std::variant
+#include <cstdint>              // uint64_t
+#include <array>                // std::array
+#include <optional>             // std::optional
+#include <memory>               // std::shared_ptr
+#include <unordered_map>        // std::unordered_map
+#include <expected>             // std::expected
 
 /** @brief Sentinel returned by @ref Log::read when the end of the log is reached. */
 struct LogEOF {};
@@ -17,54 +33,400 @@ struct LogEOF {};
 /**
  * @brief Result type of @ref Log::read.
  *
- * Contains either a decoded @ref Entry, a @ref LogEOF sentinel on clean
- * end-of-log, or an `std::error_code` on a hard read failure.
+ * Contains either a decoded @ref Entry, a decoded @ref WriteBatch, a
+ * @ref LogEOF sentinel on clean end-of-log, or an `std::error_code` on a
+ * hard read failure.
  */
-using ReadResult = std::expected<std::variant<Entry, LogEOF>, std::error_code>;
+using ReadResult = std::expected<std::variant<Entry, WriteBatch, LogEOF>, std::error_code>;
+
+/**
+ * @brief A point in the log: a record boundary inside one segment.
+ */
+struct LogPosition {
+    uint64_t segment_ = 0;  ///< Segment id.
+    uint64_t offset_  = 0;  ///< Byte offset within the segment, file header included.
+
+    /** @brief Two positions are equal when segment and offset match. */
+    bool operator==(const LogPosition &other) const noexcept = default;
+};
+
+/**
+ * @brief Where a value lives in the log, for reading it back with
+ *        @ref Log::read_value instead of keeping it in memory.
+ *
+ * Names the whole record so that its checksum can be verified on every
+ * read, plus the value's place inside it (a batch record holds several).
+ */
+struct ValueRef {
+    LogPosition record_;        ///< Start of the record holding the value.
+    uint32_t    size_       = 0;    ///< Length of that record.
+    uint32_t    val_offset_ = 0;    ///< Offset of the value within the record.
+    uint32_t    val_size_   = 0;    ///< Length of the value.
+};
+
+/**
+ * @brief One operation of the log reduced to what a key directory needs:
+ *        the key and where its value lives, but not the value itself.
+ *
+ * Handed out by @ref Log::replay_keys; the key points into a mapping of a
+ * segment or hint file and is valid only for the duration of the call.
+ */
+struct KeyRecord {
+    std::span<const std::byte> key_;            ///< The operation's key.
+    bool                       deleted_ = false; ///< `true` for a tombstone.
+    ValueRef                   ref_;            ///< Where the value lives; unused for tombstones.
+};
+
+/**
+ * @brief A record handed to a @ref Log::replay visitor.
+ *
+ * Points into the mapped segment; valid only for the duration of the call.
+ */
+using RecordView = std::variant<EntryView, BatchView>;
 
 /**
  * @brief Append-only, file-backed log of @ref Entry records.
  *
- * Manages a single file whose layout is:
+ * The log is a sequence of *segments*, each a file laid out as:
  * ```
  * [ file_header(6) | entry ... | entry ... | ... ]
  * ```
+ * Segment 0 is the file at the log's path itself; segment `N > 0` lives
+ * beside it as `<path>.N`.  Appends go to the last (*active*) segment.
+ * Once it would grow past the configured segment size it is synced and
+ * sealed, and a new active segment is started.  Sealed segments are never
+ * written again.  `<path>.manifest` lists the segments in replay order;
+ * until the first segment is sealed it does not exist and the log is just
+ * segment 0, which is exactly the older single-file layout.
+ *
  * New entries are always appended; existing entries are never mutated.
- * On open, the file header is validated (magic number + format version).
- * If the file does not yet exist it is created and the header is written.
+ * On open, the active segment's header is validated (magic number + format
+ * version); if it does not yet exist it is created and the header written.
+ * Files that look like segments but are not in the manifest (left behind by
+ * a crash during a roll or compaction) are deleted.
+ *
+ * Tail corruption (bad checksum, truncated header/payload, or a zeroed
+ * header with more bytes after it) in the last segment is treated silently
+ * as EOF on @ref read so that a crash mid-write does not permanently poison
+ * the log.  Sealed segments were synced before being sealed, so corruption
+ * there is reported as an error.
+ *
+ * **Group commit**: @ref write may be called from several threads at once.
+ * Records that arrive while another thread is inside `fsync` are queued;
+ * the first queued writer then appends the whole group with a single
+ * @ref platform_pwritev at the cached tail offset (no seek) and makes it
+ * durable with a single @ref platform_datasync, waking every writer in the
+ * group with the shared result.  A lone writer forms a group of one, so
+ * single-threaded callers see exactly the old behaviour.
+ *
+ * **Preallocation**: the active segment is grown half a chunk ahead of
+ * the appends in large chunks.  A background filler writes zeros over each
+ * reserved chunk and syncs it, off the commit path.  A commit therefore
+ * normally overwrites blocks that are already allocated and written and
+ * changes no file size, so the @ref platform_datasync that makes it durable
+ * has no metadata to journal.  Replay treats the zeroed space as end of
+ * log; a clean @ref close (or sealing the segment) trims it off again, and
+ * @ref open finds the real end after a crash.
+ *
+ * **Durability**: the @ref SyncPolicy given at construction decides when a
+ * group is synced.  Under `PerWrite` the leader syncs every group; under
+ * `Bytes` it syncs once enough unsynced data has accumulated; under
+ * `Interval` a background flusher thread (started by @ref open) syncs
+ * periodically; under `None` only @ref sync and @ref close do.
  *
- * Tail corruption (bad checksum, truncated header/payload) is treated
- * silently as EOF on @ref read so that a crash mid-write does not
- * permanently poison the log.
+ * **Compaction**: @ref seal closes off the current contents; @ref compact
+ * then writes the live entries into fresh segments while appends keep
+ * flowing into the active one, and swaps them in for the sealed segments
+ * with one manifest update.
  *
- * @note Not thread-safe. Callers must serialise concurrent access externally.
+ * **Hints**: when enabled, every segment that is sealed or written by a
+ * compaction gets a hint file (see @ref HintFile) listing its keys and the
+ * places of their values, written by a background thread.  @ref replay_keys
+ * reads those instead of the segments.
+ *
+ * @note Only @ref write, @ref sync, @ref seal, @ref compact, @ref segments,
+ *       @ref read_value and @ref disk_size are thread-safe. Every
+ *       other member must be serialised externally and must not overlap
+ *       with them.
+ * @note Neither copyable nor movable: queued writers hold pointers into
+ *       the log's synchronisation state.
  */
 class Log {
+    /**
+     * @brief A slot in the group-commit queue; lives on the caller's stack.
+     *
+     * Either an encoded record to append, or — when @ref action_ is set — a
+     * barrier that runs alone with exclusive access to the file.
+     */
+    struct Writer {
+        /// The record as pieces written back to back (e.g. header, key, value); unused ones are empty.
+        std::array<std::span<const std::byte>, 3> parts_;
+        size_t                                  size_;          ///< Total bytes in @ref parts_.
+        const std::function<std::error_code()> *action_;        ///< Barrier action, or `nullptr`.
+        std::error_code                         err_;           ///< Result shared by the whole group.
+        bool                                    done_ = false;  ///< Set by the group leader once complete.
+        LogPosition                            *at_   = nullptr; ///< Receives where the record landed, if set.
+    };
+
     std::string filename_;
-    FileHandle  fh_;
+    FileHandle  fh_;                ///< Active segment.
+    FileHandle  rfh_;               ///< Segment being replayed by @ref read.
+    SyncPolicy  policy_;
+    uint64_t    segment_size_;
+    uint64_t    active_id_ = 0;     ///< Id of the active segment; leader-owned.
+    uint64_t    tail_ = 0;          ///< Offset of the next append in the active segment; leader-owned.
+    uint64_t    allocated_ = 0;     ///< Size of the active segment file, preallocation included; leader-owned.
+    uint64_t    prealloc_size_;     ///< Preallocation chunk; `0` once the filesystem refuses it.
+    size_t      unsynced_ = 0;  ///< Bytes written but not yet covered by an `fsync`; leader-owned.
+    std::vector<std::span<const std::byte>> iov_;   ///< Gathered pieces of the current group; leader-owned.
+    std::error_code flush_err_; ///< Background sync failure, reported by the next @ref sync; leader-owned.
+
+    std::mutex                  write_mu_;  ///< Guards @ref writers_.
+    std::condition_variable     write_cv_;  ///< Signalled when a group completes.
+    std::deque<Writer *>        writers_;   ///< Pending writers; the front one leads the next group.
+    std::condition_variable_any flush_cv_;  ///< Lets @ref close interrupt the flusher's sleep.
+    std::jthread                flusher_;   ///< Background flusher; only runs under `SyncMode::Interval`.
+
+    /// Guards @ref manifest_: only the leader changes it, anyone may read it.
+    mutable std::mutex manifest_mu_;
+    Manifest           manifest_;
+    std::mutex         compact_mu_;         ///< Serialises @ref compact calls.
+
+    std::vector<uint64_t> replay_;          ///< Segments @ref read visits, captured by @ref seek_to_first_entry.
+    size_t                replay_pos_ = 0;  ///< Index into @ref replay_ of the segment open in @ref rfh_.
+    std::optional<BufferedReader> replay_reader_;   ///< Buffered view of @ref rfh_; only held while replaying.
+
+    bool                        hints_;         ///< Whether sealed segments get hint files.
+    std::mutex                  hint_mu_;       ///< Guards @ref hint_queue_.
+    std::condition_variable_any hint_cv_;       ///< Signalled when a segment is queued.
+    std::deque<uint64_t>        hint_queue_;    ///< Sealed segments still waiting for their hint.
+    std::jthread                hinter_;        ///< Writes the queued hints; runs while open if @ref hints_.
+
+    /// Guards the range below, and orders @ref filler_'s writes against the
+    /// leader's appends and truncations of the active segment.
+    std::mutex                  fill_mu_;
+    std::condition_variable_any fill_cv_;       ///< Signalled when a chunk is reserved.
+    uint64_t                    fill_id_   = 0; ///< Segment that @ref fill_from_ and @ref fill_to_ refer to.
+    uint64_t                    fill_from_ = 0; ///< Start of the reserved space not yet zeroed; never below an append.
+    uint64_t                    fill_to_   = 0; ///< End of the reserved space to zero.
+    std::jthread                filler_;        ///< Zeroes reserved chunks; runs while open if preallocating.
+
+    /// Guards @ref readers_.
+    mutable std::mutex readers_mu_;
+    /// Read handles of the segments @ref read_value has touched, by id.
+    mutable std::unordered_map<uint64_t, std::shared_ptr<FileHandle>> readers_;
+
+    /**
+     * @brief Queues @p self and, once it reaches the front, leads its group.
+     * @param self The caller's queue slot.
+     * @return The result of the group (or barrier) that covered @p self.
+     */
+    std::error_code commit(Writer &self);
+
+    /**
+     * @brief Appends one record, given as up to three pieces, through the
+     *        group-commit queue.
+     * @param parts Consecutive pieces of a fully encoded record; they must
+     *              stay alive until the call returns.
+     * @param at    Receives the position of the record on success, if set.
+     * @return The result of the write (and sync, if the policy requires one)
+     *         that covered the record.
+     */
+    std::error_code append(std::array<std::span<const std::byte>, 3> parts, LogPosition *at = nullptr);
+
+    /**
+     * @brief Runs @p action as a barrier in the group-commit queue.
+     *
+     * The action starts once every earlier append has completed and runs
+     * with sole access to @ref fh_; later appends wait for it to finish.
+     *
+     * @param action Work to perform; its result is returned.
+     * @return Whatever @p action returned.
+     */
+    std::error_code exclusive(const std::function<std::error_code()> &action);
+
+    /**
+     * @brief Runs @ref SyncPolicy::on_sync_ and `fdatasync`s the active
+     *        segment if anything is unsynced.  @pre Called by the current leader.
+     */
+    std::error_code sync_file();
+
+    /**
+     * @brief Body of @ref flusher_: syncs pending data every `interval_`.
+     * @param stop Requested by @ref close.
+     */
+    void flush_loop(std::stop_token stop);
+
+    /**
+     * @brief Seals the active segment and starts the next one.
+     *
+     * Syncs the active segment, creates the new one with a header, and
+     * records it in the manifest before switching appends over to it.
+     *
+     * @pre Called by the current leader.
+     */
+    std::error_code roll();
+
+    /**
+     * @brief Preallocates the active segment so that it covers @p need bytes.
+     *
+     * Grows it by a whole @ref prealloc_size_ chunk (capped at the segment
+     * size) once @p need comes within half a chunk of its end, and hands
+     * the chunk to @ref filler_.  The reservation alone leaves unwritten
+     * extents whose first write would still have to be journaled; the
+     * filler writes zeros over them off the commit path, so that the
+     * appends that follow are data-only.  Also moves @ref fill_from_ past
+     * @p need, so the filler never writes where the next append goes.
+     *
+     * @param need End of the append about to be written.
+     * @pre Called by the current leader.
+     */
+    std::error_code reserve(uint64_t need);
+
+    /**
+     * @brief Truncates the active segment to @p size and sets
+     *        @ref allocated_ to it, dropping any zero-fill still pending.
+     * @pre Called by the current leader, or while no other thread appends.
+     */
+    std::error_code truncate_active(uint64_t size);
+
+    /**
+     * @brief Body of @ref filler_: zeroes the reserved range in
+     *        @ref ZERO_FILL_SIZE steps through its own handle, and
+     *        `fdatasync`s each chunk once it has caught up.
+     *
+     * A step that fails gives up on the rest of the range; the appends
+     * then write into unzeroed space, which is only slower.
+     *
+     * @param stop Requested by @ref close.
+     */
+    void fill_loop(std::stop_token stop);
+
+    /** @brief Queues sealed segment @p id for @ref hinter_ if hints are enabled. */
+    void queue_hint(uint64_t id);
+
+    /**
+     * @brief Body of @ref hinter_: writes the hint of each queued segment.
+     * @param stop Requested by @ref close; queued segments are then dropped.
+     */
+    void hint_loop(std::stop_token stop);
+
+    /**
+     * @brief Replays segment `ids[index]` from @p offset; the body of @ref replay.
+     * @param ids    The segment list, to tell whether this one is the last.
+     * @param index  Index of the segment in @p ids.
+     * @param offset Offset of the first record to visit.
+     * @param visit  Called with each record and where it starts.
+     */
+    std::error_code replay_segment(const std::vector<uint64_t> &ids, size_t index, uint64_t offset,
+                                   const std::function<void(const RecordView &, const LogPosition &)> &visit);
+
+    /** @brief Cuts unused preallocated space off the active segment.  @pre Called by the current leader. */
+    std::error_code trim();
+
+    /**
+     * @brief Finds the end of the records in the active segment by decoding
+     *        it, for a segment left untrimmed by a crash.
+     *
+     * Cuts the segment there and sets @ref tail_ and @ref allocated_ to it,
+     * so that no stale bytes past a zeroed hole survive behind new appends.
+     */
+    std::error_code recover_tail();
+
+    /** @return A fresh segment id, never handed out before. */
+    uint64_t allocate_id();
+
+    /**
+     * @brief Durably replaces the manifest with @p next and adopts it.
+     * @pre Called by the current leader.
+     */
+    std::error_code store_manifest(const Manifest &next);
+
+    /** @brief Opens `replay_[replay_pos_]` in @ref rfh_ and validates its header. */
+    std::error_code open_replay_segment();
+
+    /** @brief Closes @ref rfh_ and frees the replay buffer. */
+    void end_replay();
+
+    /**
+     * @brief Maps segment @p id read-only after validating its file header.
+     * @return Empty on success; @ref db_error::missing_segment, a header
+     *         error, or an I/O error otherwise.
+     */
+    std::error_code map_segment(uint64_t id, FileMapping &out) const;
+
+    /**
+     * @brief Cuts a torn record starting at @p start off segment @p id if
+     *        that is still the active segment; see @ref read.
+     */
+    std::error_code cut_torn_tail(uint64_t id, uint64_t start);
+
+    /**
+     * @brief Returns a cached read handle for segment @p id, opening it on first use.
+     * @return The handle; @ref db_error::missing_segment or an I/O error otherwise.
+     */
+    std::expected<std::shared_ptr<FileHandle>, std::error_code> reader(uint64_t id) const;
+
+    /** @return Path of the manifest file. */
+    std::string manifest_path() const { return filename_ + ".manifest"; }
 
 public:
+    /**
+     * @brief Callback handed to the live-set producer of @ref compact.
+     *
+     * Each call appends one live key-value pair to the compacted log.
+     */
+    using Emit = std::function<std::error_code(std::span<const std::byte>, std::span<const std::byte>)>;
+
+    /** @brief Buffer size used when writing segments during @ref compact. */
+    static constexpr size_t COPY_CHUNK_SIZE = 1024 * 1024;
+
+    /** @brief Upper bound on the bytes a leader gathers into one group. */
+    static constexpr size_t MAX_GROUP_SIZE = 1024 * 1024;
+
+    /** @brief Size of the zero writes that @ref fill_loop makes, one at a time. */
+    static constexpr size_t ZERO_FILL_SIZE = 64 * 1024;
+
     /**
      * @brief Constructs a Log bound to the file at @p fname.
      *
      * Does not open the file; call @ref open before any I/O.
      *
-     * @param fname Path to the log file (stored by value).
+     * @param fname         Path of the log (segment 0); other files derive from it.
+     * @param policy        When appended records are forced to disk.
+     * @param segment_size  Size at which the active segment is sealed.
+     * @param prealloc_size Chunk by which the active segment is preallocated; `0` disables it.
+     * @param hints         Whether to write a hint file for every sealed segment.
      */
-    explicit Log(std::string fname) : filename_(std::move(fname)) {}
+    explicit Log(std::string fname, SyncPolicy policy = {},
+                 uint64_t segment_size = log_format::DEFAULT_SEGMENT_SIZE,
+                 uint64_t prealloc_size = log_format::DEFAULT_PREALLOC_SIZE,
+                 bool hints = false)
+        : filename_(std::move(fname)), policy_(policy), segment_size_(segment_size),
+          prealloc_size_(prealloc_size), hints_(hints) {}
 
-    Log(Log &&)            = default;
-    Log &operator=(Log &&) = default;
+    /** @brief Deleted – queued writers reference this object's mutex and queue. */
+    Log(const Log &)            = delete;
+    /** @brief Deleted – see copy constructor. */
+    Log &operator=(const Log &) = delete;
 
     /**
-     * @brief Opens (or creates) the log file and validates its header.
+     * @brief Loads the manifest, then opens (or creates) the active segment
+     *        and validates its header.
      *
-     * If the file already exists its magic number and format version are
-     * checked; a brand-new file gets a freshly written header.
+     * If the segment already exists its magic number and format version are
+     * checked, and a header from an older (compatible) format version is
+     * restamped with the current one before anything new is appended;
+     * a brand-new segment gets a freshly written header.  Stray segment
+     * files not listed in the manifest are removed.
      * Returns immediately without re-opening if the file is already open.
+     * Starts the background flusher when the policy is `SyncMode::Interval`.
+     *
+     * Starts the hint writer when hints are enabled.
      *
      * Possible errors: `std::errc::is_a_directory`, @ref db_error::bad_magic,
      * @ref db_error::unsupported_version, @ref db_error::truncated_header,
+     * @ref db_error::bad_manifest, @ref db_error::missing_segment,
      * or any OS-level I/O error.
      *
      * @return Empty error code on success; a descriptive error otherwise.
@@ -72,46 +434,288 @@ public:
     std::error_code open();
 
     /**
-     * @brief Flushes and closes the underlying file handle.
+     * @brief Stops the flusher and the hint writer, trims preallocated
+     *        space, syncs any pending data and closes the file handles.
+     *
+     * Hints still queued are not written; @ref replay_keys scans those
+     * segments instead and queues them again.
      * @return Empty error code on success; `std::errc::io_error` otherwise.
      */
     std::error_code close();
 
+    /**
+     * @brief Durability barrier: makes every write that has returned so far durable.
+     *
+     * A no-op under `SyncMode::PerWrite`, where nothing is ever left unsynced.
+     * Also reports (once) any failure of an earlier background sync.
+     *
+     * @return Empty error code on success; an I/O error otherwise.
+     */
+    std::error_code sync();
+
     /**
      * @brief Encodes @p ent and appends it to the log.
      *
-     * Seeks to EOF before writing so concurrent readers are not disturbed,
-     * then calls @ref platform_sync to make the write durable.
+     * Only the 13-byte header is built (on the stack); it is written
+     * together with the key and value straight from @p ent, so the record
+     * is never copied into an intermediate buffer.
+     *
+     * Writes at the cached tail of the active segment, first sealing it if
+     * the record would push it past the segment size, then calls
+     * @ref platform_datasync as the @ref SyncPolicy dictates.  Safe to call
+     * from several threads: concurrent calls are group-committed and share
+     * one `fsync`.  Under `SyncMode::PerWrite` it returns only once @p ent
+     * itself is durable.
      *
      * @param ent The entry to persist.
-     * @return Empty error code on success; an I/O error otherwise.
+     * @param at  Receives the position of the record on success, if set.
+     * @return Empty error code on success; an I/O error otherwise.  Every
+     *         writer in a failed group receives the same error.
      * @pre The log must be open; calling this on a closed log is undefined behaviour.
      */
-    std::error_code write(const Entry &ent);
+    std::error_code write(const Entry &ent, LogPosition *at = nullptr);
+
+    /**
+     * @brief @ref write(const Entry &) for a record held in caller buffers:
+     *        the key and value are handed to `pwritev` where they are, so
+     *        nothing is copied.
+     */
+    std::error_code write(const EntryView &ent, LogPosition *at = nullptr);
 
     /**
-     * @brief Decodes and returns the next @ref Entry from the current file position.
+     * @brief Encodes @p batch as a single record and appends it to the log.
      *
-     * Tail corruption (@ref db_error::bad_checksum, @ref db_error::truncated_header,
-     * @ref db_error::truncated_payload) is silently converted to @ref LogEOF so
-     * that a crash-interrupted final write does not prevent the log from loading.
+     * The whole batch shares one checksum and one group-commit slot, so it
+     * costs one `fsync` and is replayed all-or-nothing.  Same threading and
+     * durability guarantees as @ref write(const Entry &).
      *
-     * @return A @ref ReadResult containing an @ref Entry, @ref LogEOF, or an error.
+     * @param batch The operations to persist; an empty batch is a no-op.
+     * @param at    Receives the position of the record on success, if set.
+     * @return Empty error code on success; a size-limit or I/O error otherwise.
+     * @pre The log must be open.
      */
-    ReadResult read();
+    std::error_code write(const WriteBatch &batch, LogPosition *at = nullptr);
+
+    /**
+     * @brief Seals the active segment unless it is empty.
+     *
+     * Every record written before the call lies in a segment that precedes
+     * the returned one.  Runs as a queue barrier, so it is ordered with
+     * respect to concurrent @ref write calls.
+     *
+     * @return Id of the (new) active segment, or an I/O error.
+     */
+    std::expected<uint64_t, std::error_code> seal();
+
+    /**
+     * @brief Atomically replaces every segment before @p keep_from with a
+     *        compacted copy.
+     *
+     * @p live is called once with an @ref Emit sink and must emit every live
+     * key-value pair of the state held by those segments (typically the
+     * in-memory index together with the result of @ref seal, taken at the
+     * same moment).  The pairs are written into new segments of at most the
+     * configured segment size, each `fsync`ed.  One manifest update then puts
+     * them in place of the old segments, which are deleted afterwards.
+     * Segments from @p keep_from onwards — including records that arrive
+     * while @p live runs — are untouched.  On failure the log is unchanged.
+     *
+     * A caller that indexes values by @ref ValueRef learns where each pair
+     * went through @p placed, and moves its references over in @p installed,
+     * which runs once the new segments are in force but before the old ones
+     * are deleted, so that a reference is never left dangling.
+     *
+     * @param keep_from First segment to keep, as returned by @ref seal.
+     * @param live      Producer of the live set.
+     * @param placed    Called after each emitted pair with the position of its record.
+     * @param installed Called after the manifest update, before the old segments go.
+     * @return Empty error code on success; `std::errc::invalid_argument` if
+     *         @p keep_from is not in the log, an I/O error, or the first
+     *         error returned by the sink otherwise.
+     * @pre The log must be open and no @ref read may be in progress.
+     */
+    std::error_code compact(uint64_t keep_from, const std::function<std::error_code(const Emit &)> &live,
+                            const std::function<void(const LogPosition &)> &placed = {},
+                            const std::function<void()> &installed = {});
+
+    /** @return The segment ids in replay order; the last one is active. */
+    std::vector<uint64_t> segments() const;
+
+    /**
+     * @brief Path of segment @p id; sealed segments may be copied for backup.
+     * @param id A segment id, as listed by @ref segments.
+     */
+    std::string segment_path(uint64_t id) const {
+        return id == 0 ? filename_ : filename_ + "." + std::to_string(id);
+    }
+
+    /** @brief Path of the hint file of segment @p id. */
+    std::string hint_path(uint64_t id) const { return segment_path(id) + ".hint"; }
+
+    /**
+     * @brief Writes the hint file of sealed segment @p id now.
+     *
+     * Normally done in the background once a segment is sealed; exposed so
+     * that callers (and tests) can build hints on demand.
+     *
+     * @param id A sealed segment.
+     * @return Empty on success; `std::errc::invalid_argument` for the active
+     *         segment, @ref db_error::missing_segment if @p id is not (or no
+     *         longer) in the log, a decode error if the segment is damaged,
+     *         or an I/O error.
+     */
+    std::error_code write_hint(uint64_t id);
+
+    /**
+     * @brief Total size of all segment files, headers and preallocated space included.
+     * @return The byte count, or an I/O error.
+     */
+    std::expected<uint64_t, std::error_code> disk_size() const;
 
     /**
-     * @brief Seeks the file position to the first entry (just past the file header).
+     * @brief Deletes every file belonging to the log at @p fname.
      *
-     * Call this before iterating over entries with @ref read.
+     * Removes the manifest, all segments and any leftover temporaries.
+     * The log must not be open.
      *
+     * @param fname Path of the log, as passed to the constructor.
      * @return Empty error code on success; an I/O error otherwise.
      */
+    static std::error_code destroy(const std::string &fname);
+
+    /**
+     * @brief Reads the value @p ref points at with one positional read.
+     *
+     * The whole record is read and its checksum verified, so a damaged
+     * record is reported rather than returned.  Segment handles are opened
+     * once and cached.  Safe to call concurrently with writes, but not with
+     * a @ref compact that may delete the segment @p ref names.
+     *
+     * @param ref Location recorded when the value was written or replayed.
+     * @return The value; @ref db_error::bad_checksum (or another decode
+     *         error) if the record is damaged, @ref db_error::missing_segment
+     *         or an I/O error otherwise.
+     */
+    std::expected<bytes, std::error_code> read_value(const ValueRef &ref) const;
+
+    /**
+     * @brief @ref read_value into @p out, reusing its capacity; no
+     *        allocation once @p out has held a record as large.
+     * @return Empty error code on success, with the value in @p out; the
+     *         errors of @ref read_value otherwise, with @p out unspecified.
+     */
+    std::error_code read_value(const ValueRef &ref, bytes &out) const;
+
+    /**
+     * @brief Decodes and returns the next record from the current file position.
+     *
+     * Reads through a @ref BufferedReader, so replay costs one large read
+     * per megabyte rather than two syscalls per record, and never touches
+     * the offset that appends use.  Moves on to the next segment at the end
+     * of each one; the buffer is freed once the last one is done.  Tail
+     * corruption (@ref db_error::bad_checksum, @ref db_error::truncated_header,
+     * @ref db_error::truncated_payload, and @ref db_error::trailing_garbage
+     * for an all-zero header that is not at the end of the segment) in the
+     * last segment is silently converted to @ref LogEOF so that a
+     * crash-interrupted final write does not prevent the log from loading;
+     * in a sealed segment it is returned.
+     * A torn tail in the active segment is also truncated away so that later
+     * appends follow the last intact record instead of the garbage.
+     *
+     * @return A @ref ReadResult containing an @ref Entry, a @ref WriteBatch,
+     *         @ref LogEOF, or an error.
+     */
+    ReadResult read();
+
+    /**
+     * @brief Syncs the log and returns the position just past its last record.
+     *
+     * Runs as a queue barrier: every write that returned before the call
+     * lies before the position, and is durable.  A position stays valid
+     * until a compaction replaces its segment (see @ref contains).
+     *
+     * @return The position, or an I/O error.
+     */
+    std::expected<LogPosition, std::error_code> position();
+
+    /**
+     * @brief Whether @p pos still points into this log.
+     * @return `true` if its segment is listed and at least @p pos long.
+     */
+    bool contains(const LogPosition &pos) const;
+
+    /**
+     * @brief Replays every record of the log in place, from a memory map of
+     *        each segment.
+     *
+     * The zero-copy counterpart of @ref seek_to_first_entry + @ref read:
+     * records are decoded with @ref EntryCodec::decode_view and handed to
+     * @p visit as views into the mapping, so nothing is copied until the
+     * visitor copies what it keeps.  Tail corruption is handled as in
+     * @ref read.  Must not run concurrently with writes.
+     *
+     * @param visit Called with each record in log order, and where it starts.
+     * @param from  Where to start; the beginning of the log when empty.
+     * @return Empty error code at the end of the log; otherwise the first
+     *         decode or I/O error, after which @p visit is not called again;
+     *         @ref db_error::missing_segment if @p from is not in the log.
+     */
+    std::error_code replay(const std::function<void(const RecordView &, const LogPosition &)> &visit,
+                           std::optional<LogPosition> from = std::nullopt);
+
+    /**
+     * @brief Replays the key directory of the log: every operation's key
+     *        and the place of its value, without reading any value.
+     *
+     * A sealed segment with a valid hint file is replayed from the hint
+     * alone; the others, and the active segment, are scanned from a memory
+     * map as in @ref replay (tail corruption included).  A sealed segment
+     * whose hint is missing or damaged is queued for a new one.  Must not
+     * run concurrently with writes.
+     *
+     * @param visit Called with each operation in log order.
+     * @return Empty error code at the end of the log; otherwise the first
+     *         decode or I/O error of a scanned segment.
+     */
+    std::error_code replay_keys(const std::function<void(const KeyRecord &)> &visit);
+
+    /**
+     * @brief Replays the log on @p threads worker threads.
+     *
+     * Segments are split into ranges of about @p chunk_size bytes at record
+     * boundaries; workers decode and checksum the ranges concurrently into
+     * views of the mapped segments, and the calling thread hands them to
+     * @p apply in log order.  Nothing is copied until @p apply copies it.  @p apply therefore sees exactly the records
+     * @ref replay would visit, in the same order, and the same errors end
+     * the replay.  Must not run concurrently with writes.
+     *
+     * @param threads    Number of decoding threads (at least one).
+     * @param apply      Called on the calling thread with the records of each
+     *                   range, batches flattened.  The views point into the
+     *                   segment mappings and are valid until the call returns.
+     * @param from       Where to start; the beginning of the log when empty.
+     * @param chunk_size Target size of a range in bytes.
+     * @return Empty error code at the end of the log; otherwise the first
+     *         decode or I/O error in log order.
+     */
+    std::error_code replay_parallel(unsigned threads, const std::function<void(std::span<const EntryView>)> &apply,
+                                    std::optional<LogPosition> from = std::nullopt,
+                                    uint64_t chunk_size = log_format::REPLAY_CHUNK_SIZE);
+
+    /**
+     * @brief Positions @ref read at the first entry of the first segment.
+     *
+     * Call this before iterating over entries with @ref read.  The segment
+     * list is captured here; segments added later are not visited.
+     *
+     * @return Empty error code on success; @ref db_error::missing_segment,
+     *         a header error, or an I/O error otherwise.
+     */
     std::error_code seek_to_first_entry();
 
     /** @return `true` if the underlying file handle is currently open. */
     bool is_open() const noexcept { return fh_.is_open(); }
 
-    /** @brief Closes the file silently if still open; prefer @ref close for error handling. */
+    /** @brief Performs @ref close silently if still open; prefer @ref close for error handling. */
     ~Log();
 };
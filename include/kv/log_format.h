@@ -5,7 +5,7 @@
  * @file log_format.h
  * @brief Compile-time constants that define the on-disk log file header.
  *
- * Every valid kvdb log file begins with a 6-byte header:
+ * Every valid kvdb log segment begins with a 6-byte header:
  * ```
  * [ magic(4) | version(2) ]
  * ```
@@ -31,10 +31,33 @@ inline constexpr uint32_t MAGIC = 0x4B564442;
  * Must be incremented whenever the Entry wire format changes in a
  * backward-incompatible way.  Files whose stored version exceeds this
  * constant are rejected with @ref db_error::unsupported_version.
+ *
+ * History:
+ * - 2: checksummed entries.
+ * - 3: adds the @ref WriteBatch record (`flag = 2`).
  */
-inline constexpr uint16_t FORMAT_VERSION = 2;
+inline constexpr uint16_t FORMAT_VERSION = 3;
 
 /** @brief Size of the file header in bytes (`sizeof(magic) + sizeof(version)`). */
 inline constexpr size_t HEADER_SIZE = 6;
 
+/**
+ * @brief Default size at which the active segment is sealed and a new one begun.
+ *
+ * Every segment file starts with its own header; a record never spans two
+ * segments, so a segment may exceed this size by at most one group of records.
+ */
+inline constexpr uint64_t DEFAULT_SEGMENT_SIZE = 64 * 1024 * 1024;
+
+/**
+ * @brief Default chunk by which the active segment is preallocated.
+ *
+ * Preallocated space is zero-filled; an all-zero record header therefore
+ * marks the end of the records in a segment.
+ */
+inline constexpr uint64_t DEFAULT_PREALLOC_SIZE = 4 * 1024 * 1024;
+
+/** @brief Size of the ranges a parallel replay splits segments into. */
+inline constexpr uint64_t REPLAY_CHUNK_SIZE = 4 * 1024 * 1024;
+
 } // namespace log_format
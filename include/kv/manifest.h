@@ -0,0 +1,50 @@
+// include/kv/manifest.h
+#pragma once
+
+/**
+ * @file manifest.h
+ * @brief The list of segments that make up a segmented @ref Log.
+ *
+ * Wire format (all integers little-endian):
+ * ```
+ * [ magic(4) | version(2) | next_id(8) | count(4) | id(8) * count | cksum(4) ]
+ * ```
+ * The CRC-32 (IEEE 802.3) covers every byte before the checksum.  The
+ * manifest is always replaced as a whole (written to a temporary file,
+ * `fsync`ed and renamed), so a damaged one is reported, never tolerated.
+ */
+
+#include "core/types.h"     // bytes
+#include <cstdint>          // uint64_t, uint32_t, uint16_t
+#include <vector>           // std::vector
+#include <span>             // std::span
+#include <expected>         // std::expected
+#include <system_error>     // std::error_code
+
+/**
+ * @brief Ordered segment list of a @ref Log plus its id allocator.
+ */
+struct Manifest {
+    /** @brief Four-byte signature (`'K','V','M','F'` = `0x4B564D46`). */
+    static constexpr uint32_t MAGIC   = 0x4B564D46;
+    /** @brief Manifest format revision. */
+    static constexpr uint16_t VERSION = 1;
+
+    std::vector<uint64_t> segments_ = {0};  ///< Segment ids in replay order; the last one is active.
+    uint64_t              next_id_  = 1;    ///< Id that the next new segment receives.
+
+    /** @return The manifest in its wire format. */
+    bytes encode() const;
+
+    /**
+     * @brief Parses a manifest previously produced by @ref encode.
+     * @param data The complete manifest file contents.
+     * @return The manifest; @ref db_error::bad_magic,
+     *         @ref db_error::unsupported_version or @ref db_error::bad_manifest
+     *         if @p data is not a well-formed manifest.
+     */
+    static std::expected<Manifest, std::error_code> decode(std::span<const std::byte> data);
+
+    /** @brief Two manifests are equal when they list the same segments and next id. */
+    bool operator==(const Manifest &other) const noexcept = default;
+};
@@ -0,0 +1,125 @@
+// include/kv/options.h
+#pragma once
+
+/**
+ * @file options.h
+ * @brief Tunables accepted by @ref Log and @ref KeyValue at construction time.
+ */
+
+#include "kv/log_format.h"  // log_format::DEFAULT_SEGMENT_SIZE, DEFAULT_PREALLOC_SIZE
+#include <chrono>           // std::chrono::milliseconds
+#include <cstddef>          // size_t
+#include <cstdint>          // uint64_t
+#include <functional>       // std::function
+
+/**
+ * @brief When appended log records are forced to stable storage.
+ */
+enum class SyncMode {
+    PerWrite,   ///< `fsync` before every write returns (default; fully durable).
+    Interval,   ///< A background flusher `fsync`s every @ref SyncPolicy::interval_.
+    Bytes,      ///< `fsync` once @ref SyncPolicy::bytes_ unsynced bytes have accumulated.
+    None,       ///< Never `fsync` implicitly; data reaches disk when the OS decides.
+};
+
+/**
+ * @brief Durability policy applied by @ref Log to every append.
+ *
+ * Anything weaker than @ref SyncMode::PerWrite trades durability for write
+ * latency: a write may return before it is on disk, so a power failure can
+ * lose the most recent writes (never older ones, and never half a record).
+ * An explicit @ref Log::sync / @ref KeyValue::sync is a barrier that makes
+ * everything written so far durable, and a clean close always syncs.
+ */
+struct SyncPolicy {
+    SyncMode                  mode_     = SyncMode::PerWrite;               ///< Selected strategy.
+    std::chrono::milliseconds interval_ = std::chrono::milliseconds(100);   ///< Flush period for `Interval`.
+    size_t                    bytes_    = 1024 * 1024;                      ///< Flush threshold for `Bytes`.
+    /// Called on the syncing thread right before each sync of the active
+    /// segment, with the log's appends held back; for instrumentation, and
+    /// for tests that need a sync to take as long as they choose.  Must not
+    /// call back into the log.
+    std::function<void()>     on_sync_;
+
+    /** @return A policy that syncs before every write returns. */
+    static SyncPolicy per_write() { return {}; }
+
+    /**
+     * @brief A policy whose background flusher syncs every @p period.
+     * @param period Maximum age of unsynced data.
+     */
+    static SyncPolicy every(std::chrono::milliseconds period) {
+        return { SyncMode::Interval, period, 0, {} };
+    }
+
+    /**
+     * @brief A policy that syncs whenever @p threshold unsynced bytes accumulate.
+     * @param threshold Maximum amount of unsynced data in bytes.
+     */
+    static SyncPolicy every_bytes(size_t threshold) {
+        return { SyncMode::Bytes, std::chrono::milliseconds(0), threshold, {} };
+    }
+
+    /** @return A policy that leaves flushing entirely to the OS. */
+    static SyncPolicy none() {
+        return { SyncMode::None, std::chrono::milliseconds(0), 0, {} };
+    }
+};
+
+/**
+ * @brief When @ref KeyValue compacts its log on its own.
+ *
+ * The store tracks *live* bytes (records a compacted log would still hold)
+ * and *dead* bytes (overwritten values, deleted values and tombstones).  A
+ * background compaction is started once either trigger fires:
+ * - the dead share of the log reaches @ref dead_ratio_ and at least
+ *   @ref min_dead_bytes_ are dead (so small logs are not rewritten over and
+ *   over for a few bytes), or
+ * - @ref max_dead_bytes_ are dead regardless of the ratio (when non-zero).
+ */
+struct CompactionPolicy {
+    bool     enabled_        = true;                ///< Whether automatic compaction runs at all.
+    double   dead_ratio_     = 0.5;                 ///< Dead / (live + dead) share that triggers a run.
+    uint64_t min_dead_bytes_ = 4 * 1024 * 1024;     ///< Dead bytes required before the ratio counts.
+    uint64_t max_dead_bytes_ = 0;                   ///< Absolute dead-byte trigger; `0` disables it.
+
+    /** @return A policy that never compacts automatically; see @ref KeyValue::compact. */
+    static CompactionPolicy manual() {
+        return { false, 0.0, 0, 0 };
+    }
+};
+
+/**
+ * @brief Where @ref KeyValue keeps the values of its index.
+ */
+enum class ValueStorage {
+    Memory,     ///< The index holds every value; reads never touch the disk (default).
+    Disk,       ///< The index holds keys and each value's place in the log; reads fetch
+                ///< the value with one positional read, so the data set may exceed RAM.
+};
+
+/**
+ * @brief How @ref KeyValue::scan walks its key range.
+ */
+struct ScanOptions {
+    bool   reverse_ = false;    ///< Visit keys in descending order.
+    size_t limit_   = 0;        ///< Stop after this many entries; `0` means no limit.
+};
+
+/**
+ * @brief Construction-time options for @ref KeyValue.
+ *
+ * Designed for designated initialisers:
+ * ```
+ * KeyValue kv(path, { .sync_ = SyncPolicy::every(std::chrono::milliseconds(50)) });
+ * ```
+ */
+struct KVOptions {
+    SyncPolicy       sync_;         ///< Durability policy of the backing log.
+    CompactionPolicy compaction_;   ///< Automatic log compaction thresholds.
+    uint64_t         segment_size_  = log_format::DEFAULT_SEGMENT_SIZE;     ///< Size at which a log segment is sealed.
+    uint64_t         prealloc_size_ = log_format::DEFAULT_PREALLOC_SIZE;    ///< Log preallocation chunk; `0` disables it.
+    unsigned         replay_threads_ = 0;   ///< Threads decoding the log on open; `0` = one per core, `1` = sequential.
+    ValueStorage     values_        = ValueStorage::Memory;  ///< Whether values stay in memory or are read from the log.
+    bool             ordered_       = true;     ///< Keep the keys in order for @ref KeyValue::scan; costs memory per key.
+};
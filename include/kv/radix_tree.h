@@ -0,0 +1,93 @@
+// include/kv/radix_tree.h
+#pragma once
+
+/**
+ * @file radix_tree.h
+ * @brief Adaptive radix tree holding a set of binary keys in byte order.
+ */
+
+#include <cstddef>      // std::byte, size_t
+#include <functional>   // std::function
+#include <optional>     // std::optional
+#include <span>         // std::span
+
+/**
+ * @brief Ordered set of byte-string keys, stored as an adaptive radix tree
+ *        (ART, Leis et al. 2013).
+ *
+ * Each inner node branches on one key byte and comes in four sizes – 4, 16,
+ * 48 and 256 children – grown and shrunk as children come and go, so
+ * sparse levels stay small and dense ones are a direct array lookup.  A
+ * chain of single-child levels is collapsed into a prefix stored in the
+ * node below it.  A key that ends at an inner node (a prefix of longer
+ * keys) hangs off that node rather than a child, which sorts it first, as
+ * `memcmp` order wants.  Leaves hold the complete key.
+ *
+ * Lookups cost one node per distinguishing byte rather than `log n` key
+ * comparisons, and in-order walks from any key need no rebalancing
+ * structure.  @ref KeyValue keeps one beside its hash index purely for
+ * ordered scans; point lookups never touch it.
+ *
+ * @note Not thread-safe; callers serialise access.  Movable, not copyable.
+ */
+class RadixTree {
+public:
+    struct Node;
+
+private:
+    Node  *root_ = nullptr;
+    size_t size_ = 0;
+
+public:
+    RadixTree() = default;
+    /** @brief Takes over @p other's keys, leaving it empty. */
+    RadixTree(RadixTree &&other) noexcept;
+    /** @brief Drops this tree's keys and takes over @p other's. */
+    RadixTree &operator=(RadixTree &&other) noexcept;
+    /** @brief Deleted – nodes are owned uniquely. */
+    RadixTree(const RadixTree &)            = delete;
+    /** @brief Deleted – see copy constructor. */
+    RadixTree &operator=(const RadixTree &) = delete;
+    ~RadixTree();
+
+    /**
+     * @brief Adds @p key.
+     * @return `true` if it was not present before.
+     */
+    bool insert(std::span<const std::byte> key);
+
+    /**
+     * @brief Removes @p key.
+     * @return `true` if it was present.
+     */
+    bool erase(std::span<const std::byte> key);
+
+    /** @return `true` if @p key is present. */
+    bool contains(std::span<const std::byte> key) const noexcept;
+
+    /** @brief Removes every key. */
+    void clear() noexcept;
+
+    /** @return Number of keys. */
+    size_t size() const noexcept { return size_; }
+
+    /** @return `true` if there are no keys. */
+    bool empty() const noexcept { return size_ == 0; }
+
+    /**
+     * @brief Visits keys in order, starting at @p from.
+     *
+     * Forward walks visit the keys `>= from` (`> from` if not @p inclusive)
+     * in ascending order; reverse walks the keys `<= from` (`< from`) in
+     * descending order.  Without @p from the walk starts at the first key
+     * (last key in reverse).
+     *
+     * @param from      Where to start; need not be present.
+     * @param inclusive Whether a key equal to @p from is visited.
+     * @param reverse   Walk in descending order.
+     * @param visit     Called with each key, valid only during the call; the
+     *                  walk stops when it returns `false`.  Must not modify the tree.
+     */
+    void walk(std::optional<std::span<const std::byte>> from, bool inclusive, bool reverse,
+              const std::function<bool(std::span<const std::byte>)> &visit) const;
+};
@@ -0,0 +1,65 @@
+// include/kv/write_batch.h
+#pragma once
+
+/**
+ * @file write_batch.h
+ * @brief An ordered group of puts and deletes applied atomically by @ref KeyValue::write.
+ */
+
+#include "kv/entry.h"       // Entry
+#include "core/types.h"     // bytes, to_bytes
+#include <vector>           // std::vector
+#include <span>             // std::span
+
+/**
+ * @brief Collects puts and deletes so they can be committed as one unit.
+ *
+ * A batch is encoded as a single checksummed log record (see
+ * @ref EntryCodec::encode(const WriteBatch &)), so after a crash either every
+ * operation in it is replayed or none is.  Operations apply in insertion
+ * order; a later operation on the same key wins.
+ */
+class WriteBatch {
+    std::vector<Entry> ops_;
+
+public:
+    WriteBatch() = default;
+
+    /**
+     * @brief Queues an unconditional write of @p val under @p key.
+     * @param key Binary key.
+     * @param val Binary value.
+     */
+    void put(std::span<const std::byte> key, std::span<const std::byte> val) {
+        ops_.emplace_back(to_bytes(key), to_bytes(val), false);
+    }
+
+    /**
+     * @brief Queues the removal of @p key.
+     * @param key Binary key to delete.
+     */
+    void del(std::span<const std::byte> key) {
+        ops_.emplace_back(to_bytes(key), bytes{}, true);
+    }
+
+    /**
+     * @brief Appends an already-built operation; used by the decoder.
+     * @param ent Entry to append (a tombstone when `deleted_` is `true`).
+     */
+    void add(Entry ent) { ops_.push_back(std::move(ent)); }
+
+    /** @brief Removes every queued operation. */
+    void clear() noexcept { ops_.clear(); }
+
+    /** @return Number of queued operations. */
+    size_t size() const noexcept { return ops_.size(); }
+
+    /** @return `true` if no operation is queued. */
+    bool empty() const noexcept { return ops_.empty(); }
+
+    /** @return The queued operations in application order. */
+    const std::vector<Entry> &entries() const noexcept { return ops_; }
+
+    /** @brief Two batches are equal when they hold the same operations in the same order. */
+    bool operator==(const WriteBatch &other) const noexcept = default;
+};
@@ -12,6 +12,18 @@
  * | `i64`          | 8 raw bytes, little-endian `int64_t`      |
  * | `str`          | `uint32_t` length (LE) followed by data   |
  *
+ * Primary keys of @ref KeyFormat::ordered tables use @ref encode_key instead,
+ * whose output compares with `memcmp` in the same order as the cells:
+ * | Type           | Key encoding                                               |
+ * |----------------|------------------------------------------------------------|
+ * | `no_type`      | single @ref null_byte sentinel                             |
+ * | `i64`          | 8 bytes big-endian, sign bit flipped                       |
+ * | `str`          | data with `00` escaped as `00 FF`, terminated by `00 01`   |
+ *
+ * The terminator sorts below every escaped byte, so a string sorts before
+ * its extensions and the cells after it in a composite key compare only
+ * between equal strings.
+ *
  * @ref read_cell_type reads the 1-byte type tag that precedes a cell in
  * contexts where the type is not known from the schema (e.g. schema encoding).
  */
@@ -60,6 +72,27 @@ public:
      */
     static std::expected<Cell, std::error_code> decode(std::span<const std::byte> &buf, Cell::Type t);
 
+    /**
+     * @brief Appends the order-preserving key encoding of @p c to @p out.
+     *
+     * @param c        The cell to encode.
+     * @param expected The schema type expected for this key column.
+     * @param out      Destination buffer; bytes are appended in-place.
+     * @return Empty error code on success; @ref db_error::type_mismatch if
+     *         the cell's active type does not match @p expected.
+     */
+    static std::error_code encode_key(const Cell &c, Cell::Type expected, bytes &out);
+
+    /**
+     * @brief Decodes one cell written by @ref encode_key from the front of @p buf and advances it.
+     *
+     * @param buf In/out span; shrunk by the number of bytes consumed on success.
+     * @param t   The expected cell type (from the schema).
+     * @return The decoded @ref Cell; @ref db_error::expect_more_data if the
+     *         buffer ends early, `illegal_byte_sequence` for a malformed escape.
+     */
+    static std::expected<Cell, std::error_code> decode_key(std::span<const std::byte> &buf, Cell::Type t);
+
     /**
      * @brief Reads and advances past the 1-byte type tag at the front of @p buf.
      *
@@ -13,12 +13,26 @@
  * ```
  * Only primary-key columns are encoded into the KV key; this allows point
  * lookups directly from primary-key values.
+ * The key cells use @ref CellCodec::encode_key when the schema's
+ * @ref Schema::key_format_ is @ref KeyFormat::ordered, so the keys of a
+ * table sort by primary key, and @ref CellCodec::encode for the older
+ * @ref KeyFormat::raw tables.
  *
  * **Value** layout:
  * ```
  * [ non_pk_cell_0 | non_pk_cell_1 | ... ]
  * ```
  * Non-key columns are encoded in column-declaration order, skipping key columns.
+ *
+ * Each secondary index `i` of the schema adds one entry per row, with an
+ * empty value and the key:
+ * ```
+ * [ schema_id(4) | INDEX_TAG + i (1) | index_cell_0 | ... | pk_cell_0 | ... ]
+ * ```
+ * All of its cells use the ordered @ref CellCodec::encode_key, so the
+ * entries of one index value are a contiguous key range, sorted by primary
+ * key.  The tag byte keeps index entries out of the row key range, which
+ * ends at the separator byte.
  */
 
 #include "core/types.h"         // bytes
@@ -40,6 +54,10 @@ public:
     static constexpr size_t     KEY_PREFIX_SIZE = 5;
     /** @brief Byte written between the schema ID and the primary-key payload. */
     static constexpr std::byte  ID_SEPARATOR    = static_cast<std::byte>(0x00);
+    /** @brief Byte after the schema ID in the entries of the first secondary index. */
+    static constexpr uint8_t    INDEX_TAG       = 0x01;
+    /** @brief Most secondary indexes a schema can declare, one tag byte each. */
+    static constexpr size_t     MAX_INDEXES     = 0xFF;
 
     /**
      * @brief Builds the 5-byte key prefix for @p schema.
@@ -63,13 +81,68 @@ public:
 
     /**
      * @brief Encodes the primary-key columns of @p row into a KV key.
-     * @param schema Provides column types and primary-key indices.
+     * @param schema Provides column types, primary-key indices and key format.
      * @param row    Source row; size must equal `schema.cols_.size()`.
      * @return The encoded key bytes, or @ref db_error::inconsistent_length /
      *         @ref db_error::type_mismatch on failure.
      */
     static std::expected<bytes, std::error_code> encode_key(const Schema &schema, const Row &row);
 
+    /**
+     * @brief Encodes the leading primary-key values @p cells into a KV key prefix.
+     *
+     * Unlike @ref encode_key the cells are given in primary-key order, not at
+     * their column positions, and may cover only the first few key columns.
+     * Under @ref KeyFormat::ordered every row whose leading key cells equal
+     * @p cells has a key starting with the result, and the results sort
+     * like the cells do.
+     *
+     * @param schema Provides column types, primary-key indices and key format.
+     * @param cells  Values of the first `cells.size()` primary-key columns.
+     * @return The table's key prefix followed by the encoded cells, or
+     *         @ref db_error::inconsistent_length if there are more cells than
+     *         key columns, @ref db_error::type_mismatch on a wrong cell type.
+     */
+    static std::expected<bytes, std::error_code> encode_key_prefix(const Schema &schema, std::span<const Cell> cells);
+
+    /**
+     * @brief Builds the key of @p row's entry in secondary index @p index.
+     * @param schema Provides column types, primary-key indices and indexes.
+     * @param index  Position of the index in `schema.indexes_`.
+     * @param row    Source row; size must equal `schema.cols_.size()`.
+     * @return The encoded key, or @ref db_error::inconsistent_length /
+     *         @ref db_error::type_mismatch on failure.
+     */
+    static std::expected<bytes, std::error_code> encode_index_key(const Schema &schema, size_t index, const Row &row);
+
+    /**
+     * @brief Encodes leading values of secondary index @p index into a key prefix.
+     *
+     * Every entry whose first indexed columns equal @p values starts with the result.
+     *
+     * @param schema Provides column types and indexes.
+     * @param index  Position of the index in `schema.indexes_`.
+     * @param values Values of the first `values.size()` indexed columns, in index order.
+     * @return The prefix, or @ref db_error::inconsistent_length if there are more
+     *         values than indexed columns, @ref db_error::type_mismatch on a wrong type.
+     */
+    static std::expected<bytes, std::error_code> encode_index_prefix(const Schema &schema, size_t index,
+                                                                     std::span<const Cell> values);
+
+    /**
+     * @brief Decodes an entry key of secondary index @p index into @p row.
+     *
+     * Fills the indexed and primary-key columns, which is enough to look the row up.
+     *
+     * @param schema Provides column types, primary-key indices and indexes.
+     * @param index  Position of the index in `schema.indexes_`.
+     * @param row    Destination row (modified in-place); size must equal `schema.cols_.size()`.
+     * @param key    Raw index entry key.
+     * @return Empty error code on success; a @ref db_error otherwise.
+     */
+    static std::error_code decode_index_key(const Schema &schema, size_t index, Row &row,
+                                            std::span<const std::byte> key);
+
     /**
      * @brief Encodes the non-primary-key columns of @p row into a KV value.
      * @param schema Provides column types and primary-key membership.
@@ -85,7 +158,7 @@ public:
      * Validates the 4-byte schema ID and the separator byte before reading cell data.
      * Returns @ref db_error::trailing_garbage if bytes remain after all key columns are decoded.
      *
-     * @param schema Provides the expected schema ID and key-column types.
+     * @param schema Provides the expected schema ID, key-column types and key format.
      * @param row    Destination row (modified in-place); size must equal `schema.cols_.size()`.
      * @param key    Raw key bytes as stored in the @ref KeyValue layer.
      * @return Empty error code on success; a @ref db_error otherwise.
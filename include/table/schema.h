@@ -9,7 +9,8 @@
 #include "table/cell.h"  // Cell::Type
 #include <vector>        // std::vector
 #include <string>        // std::string
-#include <cstdint>       // uint32_t
+#include <string_view>   // std::string_view
+#include <cstdint>       // uint32_t, uint8_t
 
 /**
  * @brief Name and type descriptor for a single table column.
@@ -19,6 +20,29 @@ struct ColumnHeader {
     Cell::Type  type_;  ///< Value type stored in this column.
 };
 
+/**
+ * @brief Name and columns of a secondary index.
+ *
+ * Each row gets one extra KV entry per index, keyed by the row's values in
+ * @ref cols_ followed by its primary key, so rows can be found by those
+ * values with a prefix scan (see @ref RowCodec::encode_index_key).
+ */
+struct IndexHeader {
+    std::string         name_;  ///< Index name, unique within the table.
+    std::vector<size_t> cols_;  ///< Indexed column indices, most significant first; non-key columns.
+};
+
+/**
+ * @brief How a table's primary-key cells are encoded into its KV keys.
+ *
+ * Stored with the schema, so tables created before a format existed keep
+ * reading and writing the keys they already have.
+ */
+enum class KeyFormat : uint8_t {
+    raw     = 1,    ///< Same encoding as values (@ref CellCodec::encode); byte order does not follow value order.
+    ordered = 2,    ///< Order-preserving (@ref CellCodec::encode_key); keys compare with `memcmp` as their cells do.
+};
+
 /**
  * @brief Immutable description of a table's columns and primary key.
  *
@@ -34,6 +58,8 @@ struct Schema {
     std::vector<ColumnHeader> cols_;   ///< Ordered column definitions.
     std::vector<size_t>      pkey_;    ///< Ordered column indices that form the primary key.
     std::vector<bool>        pkey_map_; ///< `pkey_map_[i]` is `true` iff column `i` is part of the primary key. Derived from `pkey_` by @ref compute_metadata.
+    KeyFormat                key_format_;   ///< Encoding of the primary-key cells in row keys.
+    std::vector<IndexHeader> indexes_;      ///< Secondary indexes; declared before the table is created.
 
     /**
      * @brief Constructs a Schema and derives @ref pkey_map_.
@@ -41,9 +67,12 @@ struct Schema {
      * @param name Human-readable table name.
      * @param cols Column definitions in declaration order.
      * @param pkey Ordered indices into @p cols that form the primary key.
+     * @param key_format Encoding of the primary key; new tables use the ordered one.
      */
-    Schema(uint32_t id, std::string name, std::vector<ColumnHeader> cols, std::vector<size_t> pkey)
-        : id_(id), name_(std::move(name)), cols_(std::move(cols)), pkey_(std::move(pkey)) {
+    Schema(uint32_t id, std::string name, std::vector<ColumnHeader> cols, std::vector<size_t> pkey,
+           KeyFormat key_format = KeyFormat::ordered)
+        : id_(id), name_(std::move(name)), cols_(std::move(cols)), pkey_(std::move(pkey)),
+          key_format_(key_format) {
         compute_metadata();
     }
 
@@ -58,6 +87,16 @@ struct Schema {
         return pkey_map_[col_idx];
     }
 
+    /**
+     * @brief Finds the secondary index named @p name.
+     * @return Its position in @ref indexes_, or `indexes_.size()` if there is none.
+     */
+    size_t find_index(std::string_view name) const noexcept {
+        size_t pos = 0;
+        while (pos < indexes_.size() && indexes_[pos].name_ != name) ++pos;
+        return pos;
+    }
+
 private:
     /**
      * @brief Rebuilds @ref pkey_map_ from @ref pkey_.
@@ -17,8 +17,13 @@
  * ```
  * [ id(4) | name_len(4) | name | col_count(4)
  *   ( col_name_len(4) | col_name | col_type(1) ) * col_count
- *   pkey_count(4) | ( pkey_idx(4) ) * pkey_count ]
+ *   pkey_count(4) | ( pkey_idx(4) ) * pkey_count | key_format(1)
+   [ index_count(4) ( index_name_len(4) | index_name | index_col_count(4)
+     ( index_col_idx(4) ) * index_col_count ) * index_count ] ]
  * ```
+ * Schemas written before @ref KeyFormat existed end after the primary key
+ * and decode as @ref KeyFormat::raw.  The index list is written only when
+ * the table has secondary indexes.
  */
 
 #include "table/schema.h"   // Schema
@@ -51,7 +56,8 @@ public:
      * @param buf The raw bytes previously produced by @ref encode.
      * @return The decoded @ref Schema, or an `std::error_code` on failure:
      *         - @ref db_error::expect_more_data — buffer is too short.
-     *         - @ref db_error::bad_key          — a primary-key index exceeds the column count.
+     *         - @ref db_error::bad_key          — a primary-key or index column exceeds the column count.
+     *         - @ref db_error::unsupported_version — the key format is unknown to this build.
      *         - @ref db_error::trailing_garbage — unexpected bytes remain after decoding.
      */
     static std::expected<Schema, std::error_code> decode(std::span<const std::byte> buf);
@@ -13,13 +13,18 @@
 #include "table/schema_codec.h"     // SchemaCodec
 #include <system_error>             // std::error_code
 #include <string>                   // std::string
+#include <string_view>              // std::string_view
 #include <expected>                 // std::expected
+#include <optional>                 // std::optional
+#include <span>                     // std::span
 
 /**
  * @brief A named, schema-typed table that stores @ref Row objects in a @ref KeyValue store.
  *
  * `Table` provides the familiar CRUD operations (Select, Insert, Update, Upsert, Delete)
- * on top of the binary KV layer.  Each row is encoded by @ref RowCodec into a
+ * and primary-key range scans (Scan, ScanPrefix) on top of the binary KV layer.
+ * Secondary indexes declared in the schema (@ref Schema::indexes_) are kept
+ * in step with every write and queried with @ref Lookup.  Each row is encoded by @ref RowCodec into a
  * primary-key-derived KV key and a value containing the remaining columns.
  *
  * Instances are obtained exclusively through the static factory methods:
@@ -37,7 +42,55 @@ class Table {
     /** @brief Private constructor; use the static factory methods instead. */
     Table(KeyValue &kv, Schema schema) : kv_(kv), schema_(std::move(schema)) {}
 
+    /**
+     * @brief Writes @p row under @p mode together with its index entries, as
+     *        one atomic batch that also drops the entries of the row it replaces.
+     */
+    std::expected<bool, std::error_code> write_indexed(const Row &row, KeyValue::WriteMode mode);
+
 public:
+    /**
+     * @brief Lazy iterator over the rows of a @ref Scan, @ref ScanPrefix or @ref Lookup.
+     *
+     * Walks the underlying @ref KeyValue::Cursor and decodes a row only
+     * when @ref row is called, so skipping rows costs no decoding.  For a
+     * @ref Lookup the cursor walks index entries and @ref row fetches the
+     * row each one names.
+     *
+     * @note Refers to the `Table` that created it, which must outlive it.
+     */
+    class Cursor {
+        friend class Table;
+
+        const Schema         *schema_ = nullptr;
+        const KeyValue       *kv_     = nullptr;
+        std::optional<size_t> index_;           ///< Index whose entries @ref rows_ walks; rows if empty.
+        KeyValue::Cursor      rows_;
+
+        Cursor(const Schema &schema, const KeyValue &kv, std::optional<size_t> index, KeyValue::Cursor rows)
+            : schema_(&schema), kv_(&kv), index_(index), rows_(std::move(rows)) {}
+
+    public:
+        /** @return `true` while positioned on a row. */
+        bool valid() const noexcept { return rows_.valid(); }
+
+        /**
+         * @brief Decodes the current row into @p row, resized to the schema.
+         * @pre @ref valid.
+         * @return Empty error code on success; a @ref db_error if the stored
+         *         key or value does not match the schema, or
+         *         @ref db_error::row_not_found if a looked-up row was deleted
+         *         after its index entry was read.
+         */
+        std::error_code row(Row &row) const;
+
+        /** @brief Moves to the next row. @pre @ref valid. */
+        void next() { rows_.next(); }
+
+        /** @return Why the scan ended early, or empty. */
+        std::error_code error() const noexcept { return rows_.error(); }
+    };
+
     /**
      * @brief Opens an existing table by name.
      * @param kv   The backing key-value store.
@@ -50,10 +103,13 @@ public:
     /**
      * @brief Creates and registers a new table.
      * @param kv     The backing key-value store.
-     * @param schema Fully populated schema (name, columns, primary key).
+     * @param schema Fully populated schema (name, columns, primary key, indexes).
      *               The numeric `id_` is assigned by the store's counter.
      * @return A `Table` on success; @ref db_error::table_already_exists if
-     *         a table with the same name already exists, or another error on I/O failure.
+     *         a table with the same name already exists; `invalid_argument`
+     *         if an index is empty, repeats a name, names a missing or
+     *         primary-key column, or there are more than
+     *         @ref RowCodec::MAX_INDEXES; or another error on I/O failure.
      */
     static std::expected<Table, std::error_code> create(KeyValue &kv, Schema schema);
 
@@ -80,6 +136,9 @@ public:
 
     /**
      * @brief Inserts @p row as a new entry; fails if the primary key already exists.
+     *
+     * With secondary indexes, this and the other writes commit the row and
+     * its index entries in one atomic batch.
      * @param row Fully populated row.
      * @return `true` if the row was inserted; `false` if the key already existed;
      *         or an error on I/O failure.
@@ -103,13 +162,60 @@ public:
     std::expected<bool, std::error_code> Upsert(const Row &row);
 
     /**
-     * @brief Removes the row whose primary key matches @p row.
+     * @brief Removes the row whose primary key matches @p row, and its index entries.
      * @param row Only primary-key cells need to be populated.
      * @return `true` if the row existed and was deleted; `false` if it was
      *         not found; or an error on I/O failure.
      */
     std::expected<bool, std::error_code> Delete(const Row &row);
 
+    /**
+     * @brief Iterates over the rows whose primary key lies in `[lower, upper)`.
+     *
+     * Bounds are given as leading primary-key values in key order, so a
+     * bound may cover just the first key columns: a partial @p lower takes in
+     * every row starting with those values, a partial @p upper leaves them all out.
+     * An absent bound leaves that side open.  Rows come in primary-key order
+     * (descending with @ref ScanOptions::reverse_), which needs a table in
+     * @ref KeyFormat::ordered.
+     *
+     * @param lower   Inclusive lower bound, or `std::nullopt` for the first row.
+     * @param upper   Exclusive upper bound, or `std::nullopt` for past the last row.
+     * @param options Direction and row limit.
+     * @return A @ref Cursor on the first row in range; a @ref db_error if a
+     *         bound does not fit the key columns, or `operation_not_supported`
+     *         for a bounded scan of a @ref KeyFormat::raw table.
+     */
+    std::expected<Cursor, std::error_code> Scan(std::optional<std::span<const Cell>> lower,
+                                                std::optional<std::span<const Cell>> upper,
+                                                ScanOptions options = {}) const;
+
+    /**
+     * @brief Iterates over the rows whose leading primary-key values equal @p prefix.
+     *
+     * An empty @p prefix scans the whole table.
+     *
+     * @param prefix  Values of the first primary-key columns, in key order.
+     * @param options Direction and row limit.
+     * @return A @ref Cursor, or an error as for @ref Scan.
+     */
+    std::expected<Cursor, std::error_code> ScanPrefix(std::span<const Cell> prefix, ScanOptions options = {}) const;
+
+    /**
+     * @brief Iterates over the rows whose indexed columns start with @p values.
+     *
+     * Walks the entries of the secondary index named @p index that match,
+     * in order of the remaining indexed columns and then the primary key.
+     *
+     * @param index   Name of an index in @ref Schema::indexes_.
+     * @param values  Values of the first indexed columns, in index order.
+     * @param options Direction and row limit.
+     * @return A @ref Cursor; @ref db_error::index_not_found if there is no
+     *         such index, or an error as for @ref ScanPrefix.
+     */
+    std::expected<Cursor, std::error_code> Lookup(std::string_view index, std::span<const Cell> values,
+                                                  ScanOptions options = {}) const;
+
     /** @return Const reference to the table's schema. */
     const Schema &schema() const noexcept { return schema_; }
 
@@ -0,0 +1,52 @@
+// src/core/buffered_reader.cpp
+
+/**
+ * @file buffered_reader.cpp
+ * @brief Implementation of @ref BufferedReader.
+ */
+
+#include "core/buffered_reader.h"
+#include <algorithm>    // std::min
+#include <cstring>      // std::memcpy
+
+void BufferedReader::attach(FileHandle &fh, uint64_t offset) {
+    fh_ = &fh;
+    pos_ = len_ = 0;
+    file_off_ = offset;
+}
+
+std::error_code BufferedReader::fill() {
+    // Best effort: replay reads the same bytes with or without the hint
+    platform_readahead(*fh_, file_off_ + buf_.size(), buf_.size());
+
+    size_t n = 0;
+    if (auto err = platform_pread(*fh_, std::span(buf_), file_off_, n); err) return err;
+    pos_ = 0;
+    len_ = n;
+    file_off_ += n;
+    return {};
+}
+
+std::error_code BufferedReader::read(std::span<std::byte> buf, size_t &bytes_read) {
+    size_t done = 0;
+    while (done < buf.size()) {
+        if (pos_ == len_) {
+            // Large payloads skip the extra copy through the buffer
+            if (buf.size() - done >= buf_.size()) {
+                size_t n = 0;
+                if (auto err = platform_pread(*fh_, buf.subspan(done), file_off_, n); err) return err;
+                file_off_ += n;
+                done += n;
+                break;
+            }
+            if (auto err = fill(); err) return err;
+            if (len_ == 0) break;
+        }
+        size_t n = std::min(buf.size() - done, len_ - pos_);
+        std::memcpy(buf.data() + done, buf_.data() + pos_, n);
+        pos_ += n;
+        done += n;
+    }
+    bytes_read = done;
+    return {};
+}
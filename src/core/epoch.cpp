@@ -0,0 +1,60 @@
+// src/core/epoch.cpp
+
+/**
+ * @file epoch.cpp
+ * @brief Implementation of @ref EpochDomain pinning and reclamation.
+ */
+
+#include "core/epoch.h"
+#include <algorithm>    // std::min
+#include <thread>       // std::this_thread::yield
+
+namespace {
+
+/// Numbers threads in the order they first pin, to spread them over the slots.
+std::atomic<size_t> next_thread{ 0 };
+
+} // namespace
+
+EpochDomain::EpochDomain() : slots_(std::make_unique<Slot[]>(SLOTS)) {}
+
+EpochDomain::~EpochDomain() {
+    for (const auto &obj : retired_) obj.free_(obj.ptr_);
+}
+
+EpochDomain::Guard EpochDomain::pin() noexcept {
+    thread_local const size_t home = next_thread.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = home; ; ++i) {
+        Slot &slot = slots_[i % SLOTS];
+        // Announcing an epoch that is already stale is harmless: it only
+        // delays frees.  Acquire: seeing an epoch means seeing every
+        // unpublish that came before it was advanced.
+        uint64_t free = 0;
+        if (slot.epoch_.load(std::memory_order_relaxed) == 0 &&
+            slot.epoch_.compare_exchange_strong(free, epoch_.load(std::memory_order_acquire),
+                                                std::memory_order_seq_cst)) {
+            return Guard(&slot);
+        }
+        if ((i + 1 - home) % SLOTS == 0) std::this_thread::yield();
+    }
+}
+
+void EpochDomain::retire(void *ptr, void (*free)(void *)) {
+    retired_.push_back({ epoch_.fetch_add(1, std::memory_order_seq_cst), ptr, free });
+    collect();
+}
+
+void EpochDomain::collect() noexcept {
+    if (retired_.empty()) return;
+    uint64_t oldest = UINT64_MAX;
+    for (size_t i = 0; i < SLOTS; ++i)
+        if (const uint64_t e = slots_[i].epoch_.load(std::memory_order_seq_cst); e != 0) oldest = std::min(oldest, e);
+
+    // A reader pinned at `oldest` may hold anything retired at or after it
+    size_t done = 0;
+    while (done < retired_.size() && retired_[done].epoch_ < oldest) {
+        retired_[done].free_(retired_[done].ptr_);
+        ++done;
+    }
+    retired_.erase(retired_.begin(), retired_.begin() + static_cast<ptrdiff_t>(done));
+}
@@ -9,8 +9,15 @@
  */
 
 #include "core/platform_unix.h"
-#include <fcntl.h>   // ::open, O_RDWR, O_CREAT, O_RDONLY, O_DIRECTORY
-#include <unistd.h>  // ::read, ::write, ::close, ::lseek, ::fsync
+#include <fcntl.h>   // ::open, ::fallocate, ::posix_fallocate, ::posix_fadvise, O_RDWR, O_CREAT, O_RDONLY, O_DIRECTORY
+#include <sys/stat.h> // ::fstat
+#include <unistd.h>  // ::read, ::write, ::pread, ::pwrite, ::close, ::lseek, ::fsync, ::fdatasync, ::ftruncate
+#include <sys/uio.h> // ::writev, ::pwritev, struct iovec
+#include <sys/mman.h> // ::mmap, ::munmap, ::madvise
+#include <climits>   // IOV_MAX
+#include <array>     // std::array
+#include <algorithm> // std::min
+#include <cstdio>    // ::rename
 #include <cerrno>    // errno
 
 // ---- FileHandle ----
@@ -34,6 +41,27 @@ FileHandle &FileHandle::operator=(FileHandle &&other) noexcept {
     return *this;
 }
 
+// ---- FileMapping ----
+
+FileMapping::~FileMapping() {
+    if (data_) ::munmap(const_cast<std::byte *>(data_), size_);
+}
+
+void FileMapping::swap(FileMapping &other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+}
+
+FileMapping::FileMapping(FileMapping &&other) noexcept {
+    this->swap(other);
+}
+
+FileMapping &FileMapping::operator=(FileMapping &&other) noexcept {
+    FileMapping temp(std::move(other));
+    this->swap(temp);
+    return *this;
+}
+
 // ---- Helpers ----
 
 /**
@@ -44,6 +72,26 @@ inline std::error_code errno_to_error() {
     return std::make_error_code(static_cast<std::errc>(errno));
 }
 
+/**
+ * @brief `fsync`s the directory containing @p path so that entry changes are durable.
+ *
+ * Best effort: failures to open the directory are ignored, matching the
+ * behaviour of @ref platform_open_file.
+ *
+ * @param path Path of a file inside the directory.
+ */
+static void sync_parent_dir(const std::string &path) {
+    auto slash = path.find_last_of('/');
+    std::string dir = (slash == std::string::npos) ? "." : path.substr(0, slash);
+    if (dir.empty()) dir = "/";
+
+    int dirfd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dirfd >= 0) {
+        ::fsync(dirfd);
+        ::close(dirfd);
+    }
+}
+
 // ---- Platform functions ----
 
 /**
@@ -57,16 +105,7 @@ std::error_code platform_open_file(const std::string &path, FileHandle &out) {
     if (fd < 0) return errno_to_error();
 
     out.fd_ = fd;
-
-    std::string dir = path.substr(0, path.find_last_of('/'));
-    if (dir.empty()) dir = ".";
-
-    int dirfd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
-    if (dirfd >= 0) {
-        ::fsync(dirfd);
-        ::close(dirfd);
-    }
-
+    sync_parent_dir(path);
     return {};
 }
 
@@ -78,6 +117,105 @@ std::error_code platform_write(FileHandle &fh, std::span<const std::byte> buf) {
     return {};
 }
 
+/**
+ * @brief Drives a gathering write until every byte of @p bufs is written.
+ *
+ * The `iovec` array lives on the stack and holds at most `IOV_MAX` entries;
+ * after a short write the remaining buffers are resubmitted, starting
+ * inside the partially written one.
+ *
+ * @param bufs   Buffers to write in order.
+ * @param submit `(const iovec *, int count, size_t done) -> ssize_t`, where
+ *               `done` is the number of bytes already written.
+ * @return Empty error code on success; OS error otherwise.
+ */
+template <typename Submit>
+static std::error_code gather_write(std::span<const std::span<const std::byte>> bufs, Submit submit) {
+    constexpr size_t BATCH = IOV_MAX < 64 ? IOV_MAX : 64;
+    std::array<iovec, BATCH> iov;
+
+    size_t next = 0;    // first buffer not yet fully written
+    size_t skip = 0;    // bytes of bufs[next] already written
+    size_t done = 0;    // bytes written in total
+    while (next < bufs.size()) {
+        size_t count = 0;
+        for (size_t i = next; i < bufs.size() && count < BATCH; ++i, ++count) {
+            size_t offset = (i == next) ? skip : 0;
+            iov[count].iov_base = const_cast<std::byte *>(bufs[i].data() + offset);
+            iov[count].iov_len  = bufs[i].size_bytes() - offset;
+        }
+
+        ssize_t written = submit(iov.data(), static_cast<int>(count), done);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return errno_to_error();
+        }
+
+        auto left = static_cast<size_t>(written);
+        done += left;
+        while (next < bufs.size() && left >= bufs[next].size_bytes() - skip) {
+            left -= bufs[next].size_bytes() - skip;
+            skip = 0;
+            ++next;
+        }
+        skip += left;
+        if (written == 0 && next < bufs.size())
+            return std::make_error_code(std::errc::io_error);
+    }
+    return {};
+}
+
+/** @brief Writes @p bufs with `writev(2)` at the current file position. */
+std::error_code platform_writev(FileHandle &fh, std::span<const std::span<const std::byte>> bufs) {
+    return gather_write(bufs, [&](const iovec *iov, int count, size_t) {
+        return ::writev(fh.fd_, iov, count);
+    });
+}
+
+/** @brief Writes @p bufs with `pwritev(2)`; the file position is left untouched. */
+std::error_code platform_pwritev(FileHandle &fh, std::span<const std::span<const std::byte>> bufs, uint64_t offset) {
+    return gather_write(bufs, [&](const iovec *iov, int count, size_t done) {
+        return ::pwritev(fh.fd_, iov, count, static_cast<off_t>(offset + done));
+    });
+}
+
+/** @brief Writes @p buf in full with `pwrite(2)`, resuming short writes. */
+std::error_code platform_pwrite(FileHandle &fh, std::span<const std::byte> buf, uint64_t offset) {
+    size_t done = 0;
+    while (done < buf.size_bytes()) {
+        ssize_t n = ::pwrite(fh.fd_, buf.data() + done, buf.size_bytes() - done, static_cast<off_t>(offset + done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno_to_error();
+        }
+        if (n == 0) return std::make_error_code(std::errc::io_error);
+        done += static_cast<size_t>(n);
+    }
+    return {};
+}
+
+/** @brief Reads with `pread(2)` until @p buf is full or EOF; `at_eof_` is not touched. */
+std::error_code platform_pread(FileHandle &fh, std::span<std::byte> buf, uint64_t offset, size_t &bytes_read) {
+    size_t done = 0;
+    while (done < buf.size_bytes()) {
+        ssize_t n = ::pread(fh.fd_, buf.data() + done, buf.size_bytes() - done, static_cast<off_t>(offset + done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno_to_error();
+        }
+        if (n == 0) break;
+        done += static_cast<size_t>(n);
+    }
+    bytes_read = done;
+    return {};
+}
+
+/** @brief Resizes the file with `ftruncate(2)`. */
+std::error_code platform_truncate(FileHandle &fh, uint64_t size) {
+    if (::ftruncate(fh.fd_, static_cast<off_t>(size)) < 0) return errno_to_error();
+    return {};
+}
+
 /** @brief Reads up to `buf.size()` bytes; sets `at_eof_` when the syscall returns 0. */
 std::error_code platform_read(FileHandle &fh, std::span<std::byte> buf, size_t &bytes_read) {
     ssize_t n = ::read(fh.fd_, buf.data(), buf.size_bytes());
@@ -101,6 +239,93 @@ std::error_code platform_sync(FileHandle &fh) {
     return {};
 }
 
+/** @brief Flushes data via `fdatasync(2)`; Apple platforms fall back to `fsync(2)`. */
+std::error_code platform_datasync(FileHandle &fh) {
+#if defined(__APPLE__)
+    if (::fsync(fh.fd_) < 0) return errno_to_error();
+#else
+    if (::fdatasync(fh.fd_) < 0) return errno_to_error();
+#endif
+    return {};
+}
+
+/**
+ * @brief Reserves space with `fallocate(2)` on Linux, `posix_fallocate(3)`
+ *        elsewhere; Apple platforms only grow the file with `ftruncate(2)`.
+ *
+ * `fallocate` with mode `0` leaves the range as unwritten extents; it does
+ * not write the zeros.
+ */
+std::error_code platform_allocate(FileHandle &fh, uint64_t offset, uint64_t len) {
+#if defined(__linux__)
+    if (::fallocate(fh.fd_, 0, static_cast<off_t>(offset), static_cast<off_t>(len)) < 0) {
+        if (errno == EOPNOTSUPP || errno == ENOSYS)
+            return std::make_error_code(std::errc::operation_not_supported);
+        return errno_to_error();
+    }
+#elif defined(__APPLE__)
+    struct stat st;
+    if (::fstat(fh.fd_, &st) < 0) return errno_to_error();
+    if (static_cast<uint64_t>(st.st_size) < offset + len &&
+        ::ftruncate(fh.fd_, static_cast<off_t>(offset + len)) < 0)
+        return errno_to_error();
+#else
+    if (int rc = ::posix_fallocate(fh.fd_, static_cast<off_t>(offset), static_cast<off_t>(len)); rc != 0) {
+        if (rc == EOPNOTSUPP || rc == EINVAL)
+            return std::make_error_code(std::errc::operation_not_supported);
+        return std::make_error_code(static_cast<std::errc>(rc));
+    }
+#endif
+    return {};
+}
+
+/**
+ * @brief Marks the file sequential and asks for the range with
+ *        `posix_fadvise(2)`; Apple platforms use `fcntl(F_RDADVISE)`.
+ */
+std::error_code platform_readahead(FileHandle &fh, uint64_t offset, uint64_t len) {
+#if defined(__APPLE__)
+    struct radvisory ra{ static_cast<off_t>(offset), static_cast<int>(std::min<uint64_t>(len, INT_MAX)) };
+    if (::fcntl(fh.fd_, F_RDADVISE, &ra) < 0) return errno_to_error();
+#else
+    if (int rc = ::posix_fadvise(fh.fd_, 0, 0, POSIX_FADV_SEQUENTIAL); rc != 0)
+        return std::make_error_code(static_cast<std::errc>(rc));
+    if (int rc = ::posix_fadvise(fh.fd_, static_cast<off_t>(offset), static_cast<off_t>(len), POSIX_FADV_WILLNEED); rc != 0)
+        return std::make_error_code(static_cast<std::errc>(rc));
+#endif
+    return {};
+}
+
+/** @brief Maps with `mmap(2)` (`PROT_READ`, `MAP_SHARED`) and `madvise(MADV_SEQUENTIAL)`. */
+std::error_code platform_map(FileHandle &fh, uint64_t size, FileMapping &out) {
+    if (auto err = platform_unmap(out); err) return err;
+    if (size == 0) return {};
+
+    void *addr = ::mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_SHARED, fh.fd_, 0);
+    if (addr == MAP_FAILED) return errno_to_error();
+    ::madvise(addr, static_cast<size_t>(size), MADV_SEQUENTIAL);   // only a hint
+
+    out.data_ = static_cast<const std::byte *>(addr);
+    out.size_ = static_cast<size_t>(size);
+    return {};
+}
+
+/** @brief Unmaps with `munmap(2)`; no-op if nothing is mapped. */
+std::error_code platform_unmap(FileMapping &map) {
+    if (!map.data_) return {};
+    int rc = ::munmap(const_cast<std::byte *>(map.data_), map.size_);
+    map.data_ = nullptr;
+    map.size_ = 0;
+    return rc < 0 ? errno_to_error() : std::error_code{};
+}
+
+/** @brief Renames via `rename(2)`, then `fsync`s the parent directory. */
+std::error_code platform_rename(const std::string &from, const std::string &to) {
+    if (::rename(from.c_str(), to.c_str()) < 0) return errno_to_error();
+    sync_parent_dir(to);
+    return {};
+}
+
 /** @brief Closes the fd and resets it to -1; no-op if already closed. */
 std::error_code platform_close(FileHandle &fh) {
     if (fh.fd_ < 0) return {};
@@ -34,6 +34,29 @@ FileHandle &FileHandle::operator=(FileHandle &&other) noexcept {
     return *this;
 }
 
+// ---- FileMapping ----
+
+FileMapping::~FileMapping() {
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+}
+
+void FileMapping::swap(FileMapping &other) noexcept {
+    std::swap(mapping_, other.mapping_);
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+}
+
+FileMapping::FileMapping(FileMapping &&other) noexcept {
+    this->swap(other);
+}
+
+FileMapping &FileMapping::operator=(FileMapping &&other) noexcept {
+    FileMapping temp(std::move(other));
+    this->swap(temp);
+    return *this;
+}
+
 // --- Helpers ---
 
 /**
@@ -111,6 +134,83 @@ std::error_code platform_write(FileHandle &fh, std::span<const std::byte> buf) {
     return {};
 }
 
+/**
+ * @brief Writes each buffer in turn via @ref platform_write.
+ *
+ * `WriteFileGather` needs unbuffered, page-aligned I/O, so buffered handles
+ * fall back to one `WriteFile` per non-empty buffer.
+ */
+std::error_code platform_writev(FileHandle &fh, std::span<const std::span<const std::byte>> bufs) {
+    for (auto buf : bufs) {
+        if (buf.empty()) continue;
+        if (auto err = platform_write(fh, buf); err) return err;
+    }
+    return {};
+}
+
+/**
+ * @brief Builds an `OVERLAPPED` that addresses byte @p offset.
+ *
+ * Used with a synchronous handle, `ReadFile`/`WriteFile` then act at that
+ * offset (and also move the file pointer, which no caller relies on).
+ */
+static OVERLAPPED at_offset(uint64_t offset) {
+    OVERLAPPED ov{};
+    ov.Offset     = static_cast<DWORD>(offset & 0xFFFFFFFFu);
+    ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    return ov;
+}
+
+/** @brief Writes @p buf in full via `WriteFile` at @p offset, resuming short writes. */
+std::error_code platform_pwrite(FileHandle &fh, std::span<const std::byte> buf, uint64_t offset) {
+    size_t done = 0;
+    while (done < buf.size_bytes()) {
+        OVERLAPPED ov = at_offset(offset + done);
+        DWORD written = 0;
+        if (!WriteFile(fh.h_, buf.data() + done, static_cast<DWORD>(buf.size_bytes() - done), &written, &ov))
+            return last_win32_error();
+        if (written == 0) return std::make_error_code(std::errc::io_error);
+        done += written;
+    }
+    return {};
+}
+
+/** @brief Writes each buffer in turn via @ref platform_pwrite. */
+std::error_code platform_pwritev(FileHandle &fh, std::span<const std::span<const std::byte>> bufs, uint64_t offset) {
+    for (auto buf : bufs) {
+        if (buf.empty()) continue;
+        if (auto err = platform_pwrite(fh, buf, offset); err) return err;
+        offset += buf.size_bytes();
+    }
+    return {};
+}
+
+/** @brief Reads via `ReadFile` at @p offset until @p buf is full or EOF. */
+std::error_code platform_pread(FileHandle &fh, std::span<std::byte> buf, uint64_t offset, size_t &bytes_read) {
+    size_t done = 0;
+    while (done < buf.size_bytes()) {
+        OVERLAPPED ov = at_offset(offset + done);
+        DWORD n = 0;
+        if (!ReadFile(fh.h_, buf.data() + done, static_cast<DWORD>(buf.size_bytes() - done), &n, &ov)) {
+            if (GetLastError() == ERROR_HANDLE_EOF) break;
+            return last_win32_error();
+        }
+        if (n == 0) break;
+        done += n;
+    }
+    bytes_read = done;
+    return {};
+}
+
+/** @brief Resizes the file via `SetFileInformationByHandle(FileEndOfFileInfo)`. */
+std::error_code platform_truncate(FileHandle &fh, uint64_t size) {
+    FILE_END_OF_FILE_INFO info{};
+    info.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+    if (!SetFileInformationByHandle(fh.h_, FileEndOfFileInfo, &info, sizeof(info)))
+        return last_win32_error();
+    return {};
+}
+
 /** @brief Reads up to `buf.size()` bytes via `ReadFile`; sets `at_eof_` when 0 bytes return. */
 std::error_code platform_read(FileHandle &fh, std::span<std::byte> buf, size_t &bytes_read) {
     DWORD n = 0;
@@ -150,6 +250,69 @@ std::error_code platform_sync(FileHandle &fh) {
     return {};
 }
 
+/** @brief `FlushFileBuffers`; Win32 has no data-only flush for buffered handles. */
+std::error_code platform_datasync(FileHandle &fh) {
+    return platform_sync(fh);
+}
+
+/** @brief Grows the file to `offset + len` via `SetFileInformationByHandle(FileEndOfFileInfo)`. */
+std::error_code platform_allocate(FileHandle &fh, uint64_t offset, uint64_t len) {
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(fh.h_, &size))
+        return last_win32_error();
+    if (static_cast<uint64_t>(size.QuadPart) >= offset + len)
+        return {};
+    return platform_truncate(fh, offset + len);
+}
+
+/**
+ * @brief No-op: Win32 has no per-range hint for an open handle, and the
+ *        cache manager detects sequential reads on its own.
+ */
+std::error_code platform_readahead(FileHandle &, uint64_t, uint64_t) {
+    return {};
+}
+
+/** @brief Maps with `CreateFileMappingW(PAGE_READONLY)` and `MapViewOfFile(FILE_MAP_READ)`. */
+std::error_code platform_map(FileHandle &fh, uint64_t size, FileMapping &out) {
+    if (auto err = platform_unmap(out); err) return err;
+    if (size == 0) return {};
+
+    HANDLE mapping = CreateFileMappingW(fh.h_, nullptr, PAGE_READONLY,
+                                        static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+    if (!mapping) return last_win32_error();
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, static_cast<SIZE_T>(size));
+    if (!view) {
+        auto err = last_win32_error();
+        CloseHandle(mapping);
+        return err;
+    }
+
+    out.mapping_ = mapping;
+    out.data_ = static_cast<const std::byte *>(view);
+    out.size_ = static_cast<size_t>(size);
+    return {};
+}
+
+/** @brief Unmaps the view and closes the mapping object; no-op if nothing is mapped. */
+std::error_code platform_unmap(FileMapping &map) {
+    std::error_code err;
+    if (map.data_ && !UnmapViewOfFile(map.data_)) err = last_win32_error();
+    if (map.mapping_ && !CloseHandle(map.mapping_) && !err) err = last_win32_error();
+    map.mapping_ = nullptr;
+    map.data_ = nullptr;
+    map.size_ = 0;
+    return err;
+}
+
+/** @brief Renames via `MoveFileExW`, replacing the target and flushing before returning. */
+std::error_code platform_rename(const std::string &from, const std::string &to) {
+    if (!MoveFileExW(to_wide(from).c_str(), to_wide(to).c_str(),
+                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        return last_win32_error();
+    return {};
+}
+
 /** @brief Closes the handle and resets it to `INVALID_HANDLE_VALUE`; no-op if already closed. */
 std::error_code platform_close(FileHandle &fh) {
     if (!fh.is_open()) return {};
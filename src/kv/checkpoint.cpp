@@ -0,0 +1,141 @@
+// src/kv/checkpoint.cpp
+
+/**
+ * @file checkpoint.cpp
+ * @brief Implementation of @ref Checkpoint writing and loading.
+ */
+
+#include "kv/checkpoint.h"
+#include "core/bit_utils.h"
+#include "core/db_error.h"
+#include "core/platform.h"
+#include <filesystem>   // std::filesystem::remove, file_size
+
+namespace {
+
+/// Size of the fields before the first pair.
+constexpr size_t FIXED_SIZE = 4 + 2 + 8 + 8 + 8 + 8;
+
+/// Amount of encoded pairs buffered before each write.
+constexpr size_t FLUSH_SIZE = 1024 * 1024;
+
+/**
+ * @brief Appends to a file through a buffer, keeping a running CRC-32 of
+ *        everything appended.
+ */
+class ChecksumWriter {
+    FileHandle &fh_;
+    bytes       buf_;
+    uint32_t    crc_ = crc32_init();
+
+public:
+    explicit ChecksumWriter(FileHandle &fh) : fh_(fh) { buf_.reserve(FLUSH_SIZE); }
+
+    /** @brief The buffer to encode into; call @ref maybe_flush afterwards. */
+    bytes &buffer() noexcept { return buf_; }
+
+    /** @brief Writes the buffer out once it holds at least @ref FLUSH_SIZE bytes. */
+    std::error_code maybe_flush() { return buf_.size() >= FLUSH_SIZE ? flush() : std::error_code{}; }
+
+    /** @brief Writes out whatever is buffered. */
+    std::error_code flush() {
+        crc_ = crc32_update(crc_, buf_);
+        auto err = platform_write(fh_, std::span<const std::byte>(buf_));
+        buf_.clear();
+        return err;
+    }
+
+    /** @brief Flushes, then appends the checksum of everything written. */
+    std::error_code finish() {
+        if (auto err = flush(); err) return err;
+        push_u32(buf_, crc32_final(crc_));
+        auto err = platform_write(fh_, std::span<const std::byte>(buf_));
+        buf_.clear();
+        return err;
+    }
+};
+
+} // namespace
+
+std::error_code Checkpoint::write(const std::string &path, const Info &info,
+                                  const std::function<std::error_code(const Log::Emit &)> &produce) {
+    const std::string tmp = path + ".tmp";
+    std::error_code fs_err;
+    std::filesystem::remove(tmp, fs_err);   // never append to a stale temporary
+
+    FileHandle out;
+    if (auto err = platform_open_file(tmp, out); err) return err;
+
+    ChecksumWriter writer(out);
+    auto append = [&writer](const auto &arr) { writer.buffer().insert(writer.buffer().end(), arr.begin(), arr.end()); };
+    push_u32(writer.buffer(), MAGIC);
+    append(pack_le<uint16_t>(VERSION));
+    append(pack_le<uint64_t>(info.position_.segment_));
+    append(pack_le<uint64_t>(info.position_.offset_));
+    append(pack_le<uint64_t>(info.dead_bytes_));
+    append(pack_le<uint64_t>(info.count_));
+
+    uint64_t emitted = 0;
+    std::error_code err = produce([&](std::span<const std::byte> key, std::span<const std::byte> val) {
+        auto &buf = writer.buffer();
+        push_u32(buf, static_cast<uint32_t>(key.size()));
+        push_u32(buf, static_cast<uint32_t>(val.size()));
+        buf.insert(buf.end(), key.begin(), key.end());
+        buf.insert(buf.end(), val.begin(), val.end());
+        ++emitted;
+        return writer.maybe_flush();
+    });
+    if (!err && emitted != info.count_) err = std::make_error_code(std::errc::invalid_argument);
+    if (!err) err = writer.finish();
+    if (!err) err = platform_sync(out);
+    if (auto close_err = platform_close(out); close_err && !err) err = close_err;
+    if (!err) err = platform_rename(tmp, path);
+    if (err) std::filesystem::remove(tmp, fs_err);
+    return err;
+}
+
+std::expected<Checkpoint::Info, std::error_code> Checkpoint::load(
+    const std::string &path,
+    const std::function<void(std::span<const std::byte>, std::span<const std::byte>)> &visit) {
+    std::error_code fs_err;
+    const uint64_t size = std::filesystem::file_size(path, fs_err);
+    if (fs_err) return std::unexpected(fs_err);
+    if (size < FIXED_SIZE + 4) return std::unexpected(db_error::bad_checkpoint);
+
+    FileHandle fh;
+    if (auto err = platform_open_file(path, fh); err) return std::unexpected(err);
+    FileMapping map;
+    if (auto err = platform_map(fh, size, map); err) return std::unexpected(err);
+    platform_close(fh);
+
+    const auto data = map.data();
+    auto body = data.first(data.size() - 4);
+    if (crc32_ieee(body) != unpack_le<uint32_t>(data.last<4>()))
+        return std::unexpected(db_error::bad_checkpoint);
+    if (unpack_le<uint32_t>(body.subspan<0, 4>()) != MAGIC)
+        return std::unexpected(db_error::bad_magic);
+    if (unpack_le<uint16_t>(body.subspan<4, 2>()) > VERSION)
+        return std::unexpected(db_error::unsupported_version);
+
+    Info info{};
+    info.position_.segment_ = unpack_le<uint64_t>(body.subspan<6, 8>());
+    info.position_.offset_  = unpack_le<uint64_t>(body.subspan<14, 8>());
+    info.dead_bytes_        = unpack_le<uint64_t>(body.subspan<22, 8>());
+    info.count_             = unpack_le<uint64_t>(body.subspan<30, 8>());
+
+    // Walk the pairs once to check the framing, so a bad file hands out nothing
+    auto pairs = body.subspan(FIXED_SIZE);
+    for (int pass = 0; pass < 2; ++pass) {
+        auto rest = pairs;
+        for (uint64_t i = 0; i < info.count_; ++i) {
+            if (rest.size() < 8) return std::unexpected(db_error::bad_checkpoint);
+            uint32_t klen = *read_u32(rest);
+            uint32_t vlen = *read_u32(rest);
+            if (rest.size() < size_t{klen} + vlen) return std::unexpected(db_error::bad_checkpoint);
+            if (pass == 1) visit(rest.first(klen), rest.subspan(klen, vlen));
+            rest = rest.subspan(size_t{klen} + vlen);
+        }
+        if (!rest.empty()) return std::unexpected(db_error::bad_checkpoint);
+    }
+    return info;
+}
@@ -2,49 +2,160 @@
 
 /**
  * @file entry_codec.cpp
- * @brief Implementation of @ref EntryCodec::encode.
+ * @brief Implementation of @ref EntryCodec::encode, the batch-body parser and
+ *        the in-place decoder.
  *
- * The decode path is a function template defined entirely in entry_codec.h
- * and therefore has no corresponding translation unit.
+ * The streaming decode path is a function template defined entirely in
+ * entry_codec.h; only the non-template batch-body parser it calls lives
+ * here, next to the in-place decoder used for mapped replay.
  */
 
 #include "kv/entry_codec.h"
+#include <algorithm>    // std::min, std::all_of
 
 /**
  * @details
- * Layout written by this function:
+ * Layout of the record this header starts:
  * ```
  * [ cksum(4) | klen(4) | vlen(4) | flag(1) | key(klen) | val(vlen) ]
  * ```
  * Steps:
- * 1. Allocate the output buffer at the correct final size.
- * 2. Fill `klen`, `vlen`, and `flag` in the header.
- * 3. Copy key (and, for non-tombstones, value) into the payload region.
- * 4. Compute CRC-32 over `[KLEN_OFFSET, end)` and write it into `CKSUM_OFFSET`.
+ * 1. Fill `klen`, `vlen`, and `flag` in the header.
+ * 2. Run the CRC-32 over `[KLEN_OFFSET, HEADER_SIZE)`, then over the key
+ *    and (for non-tombstones) the value, where they already are.
+ * 3. Write the digest into `CKSUM_OFFSET`.
  */
+EntryCodec::Header EntryCodec::encode_header(std::span<const std::byte> key, std::span<const std::byte> val, bool deleted) noexcept {
+    Header header{};
+    if (deleted) val = {};
+
+    auto klen_bytes = pack_le<uint32_t>(static_cast<uint32_t>(key.size()));
+    auto vlen_bytes = pack_le<uint32_t>(static_cast<uint32_t>(val.size()));
+    std::copy(klen_bytes.begin(), klen_bytes.end(), header.begin() + KLEN_OFFSET);
+    std::copy(vlen_bytes.begin(), vlen_bytes.end(), header.begin() + VLEN_OFFSET);
+    header[FLAG_OFFSET] = static_cast<std::byte>(deleted ? FLAG_DELETE : FLAG_PUT);
+
+    uint32_t crc = crc32_update(crc32_init(), std::span<const std::byte>(header).subspan<KLEN_OFFSET>());
+    crc = crc32_update(crc, key);
+    crc = crc32_update(crc, val);
+    auto cksum_bytes = pack_le<uint32_t>(crc32_final(crc));
+    std::copy(cksum_bytes.begin(), cksum_bytes.end(), header.begin() + CKSUM_OFFSET);
+
+    return header;
+}
+
 bytes EntryCodec::encode(const Entry &ent) {
-    uint32_t klen = static_cast<uint32_t>(ent.key_.size());
-    uint32_t vlen = ent.deleted_ ? 0 : static_cast<uint32_t>(ent.val_.size());
+    auto header = encode_header(ent.key_, ent.val_, ent.deleted_);
 
-    bytes buf(HEADER_SIZE + klen + (ent.deleted_ ? 0 : vlen));
+    bytes buf;
+    buf.reserve(HEADER_SIZE + ent.key_.size() + (ent.deleted_ ? 0 : ent.val_.size()));
+    buf.insert(buf.end(), header.begin(), header.end());
+    buf.insert(buf.end(), ent.key_.begin(), ent.key_.end());
+    if (!ent.deleted_) buf.insert(buf.end(), ent.val_.begin(), ent.val_.end());
+    return buf;
+}
 
-    auto klen_bytes = pack_le<uint32_t>(klen);
-    auto vlen_bytes = pack_le<uint32_t>(vlen);
-    std::copy(klen_bytes.begin(), klen_bytes.end(), buf.begin() + KLEN_OFFSET);
-    std::copy(vlen_bytes.begin(), vlen_bytes.end(), buf.begin() + VLEN_OFFSET);
+/**
+ * @details
+ * Layout written by this function:
+ * ```
+ * [ cksum(4) | 0(4) | vlen(4) | 2(1) | count(4) | ( klen(4) | vlen(4) | flag(1) | key | val ) * count ]
+ * ```
+ * The body is built directly after a zeroed header so the CRC-32 can be
+ * computed over `[KLEN_OFFSET, end)` exactly as for a single entry.
+ */
+std::expected<bytes, std::error_code> EntryCodec::encode(const WriteBatch &batch) {
+    size_t body_size = 4;
+    for (const auto &op : batch.entries()) {
+        if (op.key_.size() > MAX_KEY_SIZE)
+            return std::unexpected(db_error::key_too_large);
+        if (!op.deleted_ && op.val_.size() > MAX_VAL_SIZE)
+            return std::unexpected(db_error::value_too_large);
+        body_size += BATCH_OP_HEADER_SIZE + op.key_.size() + (op.deleted_ ? 0 : op.val_.size());
+    }
+    if (body_size > MAX_BATCH_SIZE)
+        return std::unexpected(db_error::value_too_large);
 
-    buf[FLAG_OFFSET] = static_cast<std::byte>(ent.deleted_ ? 1 : 0);
+    bytes buf(HEADER_SIZE);
+    buf.reserve(HEADER_SIZE + body_size);
 
-    // Copying key and value data
-    std::copy(ent.key_.begin(), ent.key_.end(), buf.begin() + HEADER_SIZE);
-    if (!ent.deleted_) {
-        std::copy(ent.val_.begin(), ent.val_.end(), buf.begin() + HEADER_SIZE + klen);
+    auto vlen_bytes = pack_le<uint32_t>(static_cast<uint32_t>(body_size));
+    std::copy(vlen_bytes.begin(), vlen_bytes.end(), buf.begin() + VLEN_OFFSET);
+    buf[FLAG_OFFSET] = static_cast<std::byte>(FLAG_BATCH);
+
+    push_u32(buf, static_cast<uint32_t>(batch.size()));
+    for (const auto &op : batch.entries()) {
+        push_u32(buf, static_cast<uint32_t>(op.key_.size()));
+        push_u32(buf, op.deleted_ ? 0 : static_cast<uint32_t>(op.val_.size()));
+        buf.push_back(static_cast<std::byte>(op.deleted_ ? FLAG_DELETE : FLAG_PUT));
+        buf.insert(buf.end(), op.key_.begin(), op.key_.end());
+        if (!op.deleted_) buf.insert(buf.end(), op.val_.begin(), op.val_.end());
     }
 
-    // Compute the checksum and add to the header
     uint32_t cksum = crc32_ieee(std::span(buf).subspan<KLEN_OFFSET>());
     auto cksum_bytes = pack_le<uint32_t>(cksum);
     std::copy(cksum_bytes.begin(), cksum_bytes.end(), buf.begin() + CKSUM_OFFSET);
 
     return buf;
 }
+
+std::expected<WriteBatch, std::error_code> EntryCodec::decode_batch_body(std::span<const std::byte> body) {
+    WriteBatch batch;
+    auto err = for_each_batch_op(body, [&batch](const EntryView &op) { batch.add(Entry(op)); });
+    if (err) return std::unexpected(err);
+    return batch;
+}
+
+/**
+ * @details
+ * Mirrors @ref decode step by step, reading from @p data in place: header,
+ * limits, payload bounds, checksum, flag.  A batch body is additionally
+ * walked once so that a malformed one is reported here rather than from
+ * @ref BatchView::for_each.
+ */
+ViewResult EntryCodec::decode_view(std::span<const std::byte> data, size_t &offset) {
+    auto rest = data.subspan(std::min(offset, data.size()));
+    if (rest.empty())
+        return EntryEOF{};
+
+    auto header = rest.first(std::min(rest.size(), HEADER_SIZE));
+    if (std::all_of(header.begin(), header.end(), [](std::byte b) { return b == std::byte{0}; }))
+        return EntryEOF{};
+    if (header.size() < HEADER_SIZE)
+        return std::unexpected(db_error::truncated_header);
+
+    uint32_t stored_cksum = unpack_le<uint32_t>(header.subspan<CKSUM_OFFSET, 4>());
+    uint32_t klen = unpack_le<uint32_t>(header.subspan<KLEN_OFFSET, 4>());
+    uint32_t vlen = unpack_le<uint32_t>(header.subspan<VLEN_OFFSET, 4>());
+    uint8_t  flag = static_cast<uint8_t>(header[FLAG_OFFSET]);
+    bool is_batch   = (flag == FLAG_BATCH);
+    bool is_deleted = (flag == FLAG_DELETE);
+
+    if (klen > MAX_KEY_SIZE)
+        return std::unexpected(db_error::key_too_large);
+    if (vlen > (is_batch ? MAX_BATCH_SIZE : MAX_VAL_SIZE))
+        return std::unexpected(db_error::value_too_large);
+
+    size_t payload_size = size_t{klen} + (is_deleted ? 0 : vlen);
+    if (rest.size() - HEADER_SIZE < payload_size)
+        return std::unexpected(db_error::truncated_payload);
+    auto payload = rest.subspan(HEADER_SIZE, payload_size);
+
+    uint32_t c_cksum = crc32_init();
+    c_cksum = crc32_update(c_cksum, header.subspan<KLEN_OFFSET>());
+    c_cksum = crc32_update(c_cksum, payload);
+    if (crc32_final(c_cksum) != stored_cksum)
+        return std::unexpected(db_error::bad_checksum);
+
+    if (flag > FLAG_BATCH || (is_batch && klen != 0))
+        return std::unexpected(db_error::bad_record_type);
+    if (is_batch) {
+        if (auto err = for_each_batch_op(payload, [](const EntryView &) {}); err)
+            return std::unexpected(err);
+        offset += HEADER_SIZE + payload_size;
+        return BatchView{ payload };
+    }
+
+    offset += HEADER_SIZE + payload_size;
+    return EntryView{ payload.first(klen), payload.subspan(klen), is_deleted };
+}
@@ -0,0 +1,148 @@
+// src/kv/epoch_index.cpp
+
+/**
+ * @file epoch_index.cpp
+ * @brief Implementation of @ref EpochIndex lookups, updates and table rebuilds.
+ */
+
+#include "kv/epoch_index.h"
+#include <algorithm>    // std::equal
+#include <cstring>      // std::memcpy
+#include <new>          // placement new
+#include <string_view>  // std::string_view, std::hash
+
+namespace {
+
+/// Arena garbage below which a rebuild is not worth a copy.
+constexpr size_t MIN_GARBAGE = Arena::BLOCK_SIZE;
+
+size_t hash_key(std::span<const std::byte> key) noexcept {
+    return std::hash<std::string_view>{}(
+        { reinterpret_cast<const char *>(key.data()), key.size() });
+}
+
+} // namespace
+
+EpochIndex::Table::Table(size_t buckets)
+    : buckets_(std::make_unique<std::atomic<Record *>[]>(buckets)), mask_(buckets - 1) {}
+
+EpochIndex::Record *EpochIndex::Table::make_record(std::span<const std::byte> key,
+                                                   std::span<const std::byte> val, size_t hash) {
+    std::byte *mem = arena_.allocate(sizeof(Record) + key.size() + val.size(), alignof(Record));
+    auto *rec = new (mem) Record{ nullptr, static_cast<uint32_t>(hash), static_cast<uint32_t>(key.size()),
+                                  static_cast<uint32_t>(val.size()) };
+    if (!key.empty()) std::memcpy(mem + sizeof(Record), key.data(), key.size());
+    if (!val.empty()) std::memcpy(mem + sizeof(Record) + key.size(), val.data(), val.size());
+    return rec;
+}
+
+EpochIndex::~EpochIndex() {
+    delete table_.load(std::memory_order_relaxed);
+}
+
+std::atomic<EpochIndex::Record *> &EpochIndex::find_link(Table &table, std::span<const std::byte> key,
+                                                         size_t hash) noexcept {
+    std::atomic<Record *> *link = &table.buckets_[hash & table.mask_];
+    // Only the writer calls this, so relaxed loads see its own stores
+    for (Record *rec; (rec = link->load(std::memory_order_relaxed)) != nullptr; link = &rec->next_) {
+        const auto k = rec->key();
+        if (rec->hash_ == static_cast<uint32_t>(hash) && k.size() == key.size() &&
+            std::equal(k.begin(), k.end(), key.begin()))
+            break;
+    }
+    return *link;
+}
+
+void EpochIndex::rebuild(size_t buckets) {
+    auto next = std::make_unique<Table>(buckets);
+    Table *old = table_.load(std::memory_order_relaxed);
+    if (old) {
+        for (size_t i = 0; i <= old->mask_; ++i) {
+            for (const Record *rec = old->buckets_[i].load(std::memory_order_relaxed); rec;
+                 rec = rec->next_.load(std::memory_order_relaxed)) {
+                const size_t hash = hash_key(rec->key());
+                Record *copy = next->make_record(rec->key(), rec->val(), hash);
+                auto &head = next->buckets_[hash & next->mask_];
+                copy->next_.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                head.store(copy, std::memory_order_relaxed);
+            }
+        }
+    }
+    garbage_ = 0;
+    // Sequentially consistent to pair with the reader's pin (see EpochDomain)
+    table_.store(next.release(), std::memory_order_seq_cst);
+    if (old) epochs_.retire(std::unique_ptr<Table>(old));
+}
+
+void EpochIndex::retire(const Record *rec) {
+    garbage_ += rec->footprint();
+    const Table *table = table_.load(std::memory_order_relaxed);
+    if (garbage_ < MIN_GARBAGE || garbage_ * 2 < table->arena_.used()) return;
+    rebuild(table->mask_ + 1);
+}
+
+std::optional<std::span<const std::byte>> EpochIndex::find(std::span<const std::byte> key) const noexcept {
+    const Table *table = table_.load(std::memory_order_seq_cst);
+    if (!table) return std::nullopt;
+    const size_t hash = hash_key(key);
+    for (const Record *rec = table->buckets_[hash & table->mask_].load(std::memory_order_acquire); rec;
+         rec = rec->next_.load(std::memory_order_acquire)) {
+        const auto k = rec->key();
+        if (rec->hash_ == static_cast<uint32_t>(hash) && k.size() == key.size() &&
+            std::equal(k.begin(), k.end(), key.begin()))
+            return rec->val();
+    }
+    return std::nullopt;
+}
+
+std::optional<size_t> EpochIndex::put(std::span<const std::byte> key, std::span<const std::byte> val) {
+    // A reader retired earlier may have unpinned since
+    if (epochs_.pending() != 0) epochs_.collect();
+    if (!table_.load(std::memory_order_relaxed)) rebuild(MIN_BUCKETS);
+
+    const size_t hash = hash_key(key);
+    Table *table = table_.load(std::memory_order_relaxed);
+    std::atomic<Record *> *link = &find_link(*table, key, hash);
+    if (Record *old = link->load(std::memory_order_relaxed); old) {
+        Record *rec = table->make_record(key, val, hash);
+        rec->next_.store(old->next_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        link->store(rec, std::memory_order_release);
+        const size_t len = old->vlen_;
+        retire(old);
+        return len;
+    }
+
+    // Keep at most one record per bucket on average
+    if (size_ + 1 > table->mask_ + 1) {
+        rebuild((table->mask_ + 1) * 2);
+        table = table_.load(std::memory_order_relaxed);
+        link  = &find_link(*table, key, hash);
+    }
+    link->store(table->make_record(key, val, hash), std::memory_order_release);
+    ++size_;
+    return std::nullopt;
+}
+
+std::optional<size_t> EpochIndex::erase(std::span<const std::byte> key) {
+    if (epochs_.pending() != 0) epochs_.collect();
+    Table *table = table_.load(std::memory_order_relaxed);
+    if (!table) return std::nullopt;
+
+    auto &link = find_link(*table, key, hash_key(key));
+    const Record *old = link.load(std::memory_order_relaxed);
+    if (!old) return std::nullopt;
+    link.store(old->next_.load(std::memory_order_relaxed), std::memory_order_release);
+    const size_t len = old->vlen_;
+    if (--size_ == 0) {
+        clear();
+        return len;
+    }
+    retire(old);
+    return len;
+}
+
+void EpochIndex::clear() {
+    Table *old = table_.exchange(nullptr, std::memory_order_seq_cst);
+    size_ = garbage_ = 0;
+    if (old) epochs_.retire(std::unique_ptr<Table>(old));
+}
@@ -0,0 +1,216 @@
+// src/kv/flat_index.cpp
+
+/**
+ * @file flat_index.cpp
+ * @brief Implementation of @ref FlatIndex probing, growth and arena compaction.
+ */
+
+#include "kv/flat_index.h"
+#include <algorithm>    // std::equal, std::fill_n, std::max
+#include <bit>          // std::countr_zero
+#include <cstring>      // std::memcpy, std::memmove
+#include <string_view>  // std::string_view, std::hash
+#include <utility>      // std::exchange
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define KVDB_FLAT_INDEX_SSE2 1
+#endif
+
+namespace {
+
+constexpr uint8_t EMPTY   = 0x80;
+constexpr uint8_t DELETED = 0xFE;
+
+/// Arena garbage below which compacting is not worth a copy.
+constexpr size_t MIN_GARBAGE = Arena::BLOCK_SIZE;
+
+size_t hash_key(std::span<const std::byte> key) noexcept {
+    return std::hash<std::string_view>{}(
+        { reinterpret_cast<const char *>(key.data()), key.size() });
+}
+
+uint8_t h2(size_t hash) noexcept { return static_cast<uint8_t>(hash & 0x7F); }
+size_t  h1(size_t hash) noexcept { return hash >> 7; }
+
+/// Bit `i` is set when `ctrl[i] == byte`, for the group starting at @p ctrl.
+uint32_t match(const uint8_t *ctrl, uint8_t byte) noexcept {
+#ifdef KVDB_FLAT_INDEX_SSE2
+    const __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(byte)))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < FlatIndex::GROUP_SIZE; ++i)
+        mask |= uint32_t{ctrl[i] == byte} << i;
+    return mask;
+#endif
+}
+
+/// Bit `i` is set when `ctrl[i]` is `EMPTY` or `DELETED` (high bit set).
+uint32_t match_free(const uint8_t *ctrl) noexcept {
+#ifdef KVDB_FLAT_INDEX_SSE2
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < FlatIndex::GROUP_SIZE; ++i)
+        mask |= uint32_t{ctrl[i] >= 0x80} << i;
+    return mask;
+#endif
+}
+
+/**
+ * @brief Group-aligned triangular probe sequence; visits every group once
+ *        when the group count is a power of two.
+ */
+class Probe {
+    size_t mask_, pos_, step_ = 0;
+
+public:
+    Probe(size_t hash, size_t capacity) noexcept
+        : mask_(capacity - 1), pos_(h1(hash) & mask_ & ~(FlatIndex::GROUP_SIZE - 1)) {}
+
+    size_t offset() const noexcept { return pos_; }
+    void next() noexcept {
+        step_ += FlatIndex::GROUP_SIZE;
+        pos_ = (pos_ + step_) & mask_;
+    }
+};
+
+} // namespace
+
+size_t FlatIndex::find_slot(std::span<const std::byte> key, size_t hash) const noexcept {
+    if (capacity_ == 0) return capacity_;
+    const uint8_t tag = h2(hash);
+    for (Probe p(hash, capacity_); ; p.next()) {
+        const uint8_t *group = &ctrl_[p.offset()];
+        for (uint32_t m = match(group, tag); m != 0; m &= m - 1) {
+            const size_t i = p.offset() + std::countr_zero(m);
+            const auto k = slots_[i]->key();
+            if (k.size() == key.size() && std::equal(k.begin(), k.end(), key.begin()))
+                return i;
+        }
+        // An empty slot ends every probe sequence that passes it
+        if (match(group, EMPTY) != 0) return capacity_;
+    }
+}
+
+size_t FlatIndex::free_slot(size_t hash) const noexcept {
+    for (Probe p(hash, capacity_); ; p.next())
+        if (const uint32_t m = match_free(&ctrl_[p.offset()]); m != 0)
+            return p.offset() + std::countr_zero(m);
+}
+
+FlatIndex::Record *FlatIndex::make_record(std::span<const std::byte> key,
+                                          std::span<const std::byte> val) {
+    auto *rec = reinterpret_cast<Record *>(
+        arena_.allocate(sizeof(Record) + key.size() + val.size(), alignof(Record)));
+    rec->klen_ = static_cast<uint32_t>(key.size());
+    rec->vlen_ = rec->vcap_ = static_cast<uint32_t>(val.size());
+    if (!key.empty()) std::memcpy(rec->data(), key.data(), key.size());
+    if (!val.empty()) std::memcpy(rec->data() + key.size(), val.data(), val.size());
+    return rec;
+}
+
+void FlatIndex::rehash(size_t capacity) {
+    auto old_ctrl  = std::move(ctrl_);
+    auto old_slots = std::move(slots_);
+    const size_t old_capacity = capacity_;
+
+    ctrl_  = std::make_unique_for_overwrite<uint8_t[]>(capacity);
+    slots_ = std::make_unique_for_overwrite<Record *[]>(capacity);
+    std::fill_n(ctrl_.get(), capacity, EMPTY);
+    capacity_   = capacity;
+    tombstones_ = 0;
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old_ctrl[i] >= 0x80) continue;
+        const size_t hash = hash_key(old_slots[i]->key());
+        const size_t slot = free_slot(hash);
+        ctrl_[slot]  = h2(hash);
+        slots_[slot] = old_slots[i];
+    }
+}
+
+void FlatIndex::retire(const Record *rec) {
+    garbage_ += rec->footprint();
+    if (garbage_ < MIN_GARBAGE || garbage_ * 2 < arena_.used()) return;
+
+    // Copy the survivors; the old arena is freed when `old` goes out of scope
+    Arena old = std::move(arena_);
+    for (size_t i = 0; i < capacity_; ++i)
+        if (ctrl_[i] < 0x80) slots_[i] = make_record(slots_[i]->key(), slots_[i]->val());
+    garbage_ = 0;
+}
+
+std::optional<std::span<const std::byte>> FlatIndex::find(std::span<const std::byte> key) const noexcept {
+    const size_t slot = find_slot(key, hash_key(key));
+    if (slot == capacity_) return std::nullopt;
+    return slots_[slot]->val();
+}
+
+std::optional<size_t> FlatIndex::put(std::span<const std::byte> key, std::span<const std::byte> val) {
+    const size_t hash = hash_key(key);
+    if (const size_t slot = find_slot(key, hash); slot != capacity_) {
+        Record *rec = slots_[slot];
+        const size_t old = rec->vlen_;
+        if (val.size() <= rec->vcap_) {
+            if (!val.empty()) std::memmove(rec->data() + rec->klen_, val.data(), val.size());
+            rec->vlen_ = static_cast<uint32_t>(val.size());
+        } else {
+            slots_[slot] = make_record(key, val);
+            retire(rec);
+        }
+        return old;
+    }
+
+    // Keep the load (tombstones included) at or below 7/8
+    if ((size_ + tombstones_ + 1) * 8 > capacity_ * 7) {
+        const size_t need = std::max((size_ + 1) * 8 / 7 + 1, GROUP_SIZE);
+        size_t cap = std::max(capacity_, GROUP_SIZE);
+        while (cap < need) cap *= 2;
+        // Same size when the load was mostly tombstones
+        rehash(cap);
+    }
+    const size_t slot = free_slot(hash);
+    if (ctrl_[slot] == DELETED) --tombstones_;
+    ctrl_[slot]  = h2(hash);
+    slots_[slot] = make_record(key, val);
+    ++size_;
+    return std::nullopt;
+}
+
+std::optional<size_t> FlatIndex::erase(std::span<const std::byte> key) {
+    const size_t slot = find_slot(key, hash_key(key));
+    if (slot == capacity_) return std::nullopt;
+    const Record *rec = slots_[slot];
+    const size_t old = rec->vlen_;
+    ctrl_[slot] = DELETED;
+    ++tombstones_;
+    --size_;
+    if (size_ == 0) {
+        clear();
+        return old;
+    }
+    retire(rec);
+    return old;
+}
+
+FlatIndex &FlatIndex::operator=(FlatIndex &&other) noexcept {
+    if (this != &other) {
+        ctrl_       = std::move(other.ctrl_);
+        slots_      = std::move(other.slots_);
+        capacity_   = std::exchange(other.capacity_, 0);
+        size_       = std::exchange(other.size_, 0);
+        tombstones_ = std::exchange(other.tombstones_, 0);
+        arena_      = std::move(other.arena_);
+        garbage_    = std::exchange(other.garbage_, 0);
+    }
+    return *this;
+}
+
+void FlatIndex::clear() noexcept {
+    ctrl_.reset();
+    slots_.reset();
+    capacity_ = size_ = tombstones_ = garbage_ = 0;
+    arena_.clear();
+}
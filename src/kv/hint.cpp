@@ -0,0 +1,105 @@
+// src/kv/hint.cpp
+
+/**
+ * @file hint.cpp
+ * @brief Implementation of @ref HintFile encoding and loading.
+ */
+
+#include "kv/hint.h"
+#include "kv/entry_codec.h"
+#include "core/bit_utils.h"
+#include "core/db_error.h"
+#include "core/platform.h"
+#include <filesystem>   // std::filesystem::file_size
+
+namespace {
+
+/// Size of the fields before the first entry.
+constexpr size_t FIXED_SIZE = 4 + 2 + 8 + 8;
+
+/// Size of an entry without its key.
+constexpr size_t ENTRY_SIZE = 1 + 4 + 4 + 8 + 4 + 4;
+
+} // namespace
+
+bytes HintFile::encode(uint64_t segment_size, std::span<const KeyRecord> records) {
+    size_t size = FIXED_SIZE + 4;
+    for (const auto &rec : records) size += ENTRY_SIZE + rec.key_.size();
+
+    bytes out;
+    out.reserve(size);
+    auto append = [&out](const auto &arr) { out.insert(out.end(), arr.begin(), arr.end()); };
+    push_u32(out, MAGIC);
+    append(pack_le<uint16_t>(VERSION));
+    append(pack_le<uint64_t>(segment_size));
+    append(pack_le<uint64_t>(records.size()));
+    for (const auto &rec : records) {
+        out.push_back(std::byte{rec.deleted_ ? EntryCodec::FLAG_DELETE : EntryCodec::FLAG_PUT});
+        push_u32(out, static_cast<uint32_t>(rec.key_.size()));
+        push_u32(out, rec.ref_.val_size_);
+        append(pack_le<uint64_t>(rec.ref_.record_.offset_));
+        push_u32(out, rec.ref_.size_);
+        push_u32(out, rec.ref_.val_offset_);
+        out.insert(out.end(), rec.key_.begin(), rec.key_.end());
+    }
+    push_u32(out, crc32_ieee(out));
+    return out;
+}
+
+std::error_code HintFile::load(const std::string &path, uint64_t segment, uint64_t segment_size,
+                               const std::function<void(const KeyRecord &)> &visit) {
+    std::error_code fs_err;
+    const uint64_t size = std::filesystem::file_size(path, fs_err);
+    if (fs_err) return fs_err;
+    if (size < FIXED_SIZE + 4) return db_error::bad_hint;
+
+    FileHandle fh;
+    if (auto err = platform_open_file(path, fh); err) return err;
+    FileMapping map;
+    if (auto err = platform_map(fh, size, map); err) return err;
+    platform_close(fh);
+
+    const auto data = map.data();
+    auto body = data.first(data.size() - 4);
+    if (crc32_ieee(body) != unpack_le<uint32_t>(data.last<4>()))
+        return db_error::bad_hint;
+    if (unpack_le<uint32_t>(body.subspan<0, 4>()) != MAGIC)
+        return db_error::bad_magic;
+    if (unpack_le<uint16_t>(body.subspan<4, 2>()) > VERSION)
+        return db_error::unsupported_version;
+    // Written for a different file that once had this name
+    if (unpack_le<uint64_t>(body.subspan<6, 8>()) != segment_size)
+        return db_error::bad_hint;
+    const uint64_t count = unpack_le<uint64_t>(body.subspan<14, 8>());
+
+    // Walk the entries once to check the framing, so a bad file hands out nothing
+    const auto entries = body.subspan(FIXED_SIZE);
+    for (int pass = 0; pass < 2; ++pass) {
+        auto rest = entries;
+        for (uint64_t i = 0; i < count; ++i) {
+            if (rest.size() < ENTRY_SIZE) return db_error::bad_hint;
+            const auto flag = static_cast<uint8_t>(rest[0]);
+            rest = rest.subspan<1>();
+            KeyRecord rec;
+            const uint32_t klen     = *read_u32(rest);
+            rec.ref_.val_size_      = *read_u32(rest);
+            rec.ref_.record_        = { segment, unpack_le<uint64_t>(rest.first<8>()) };
+            rest = rest.subspan<8>();
+            rec.ref_.size_          = *read_u32(rest);
+            rec.ref_.val_offset_    = *read_u32(rest);
+            rec.deleted_            = (flag == EntryCodec::FLAG_DELETE);
+
+            if ((flag != EntryCodec::FLAG_PUT && !rec.deleted_) || rest.size() < klen)
+                return db_error::bad_hint;
+            if (!rec.deleted_ && (size_t{rec.ref_.val_offset_} + rec.ref_.val_size_ > rec.ref_.size_ ||
+                                  rec.ref_.record_.offset_ + rec.ref_.size_ > segment_size))
+                return db_error::bad_hint;
+            if (rec.deleted_) rec.ref_ = {};
+            rec.key_ = rest.first(klen);
+            rest = rest.subspan(klen);
+            if (pass == 1) visit(rec);
+        }
+        if (!rest.empty()) return db_error::bad_hint;
+    }
+    return {};
+}
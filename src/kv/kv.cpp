@@ -7,58 +7,378 @@
 
 #include "core/types.h"
 #include "kv/kv.h"
+#include "kv/entry_codec.h"
+#include "kv/checkpoint.h"
+#include "core/small_key.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+/// Bytes a put of @p key_size and @p val_size occupies as a stand-alone log record.
+uint64_t record_size(size_t key_size, size_t val_size) {
+    return EntryCodec::HEADER_SIZE + key_size + val_size;
+}
+
+/// Location of the value of a stand-alone put record written at @p at.
+ValueRef entry_ref(const LogPosition &at, size_t key_size, size_t val_size) {
+    return { at, static_cast<uint32_t>(EntryCodec::HEADER_SIZE + key_size + val_size),
+             static_cast<uint32_t>(EntryCodec::HEADER_SIZE + key_size), static_cast<uint32_t>(val_size) };
+}
+
+/// Mask of every write stripe.
+constexpr uint64_t ALL_STRIPES = ~uint64_t{0};
+
+/// Runs a callable when it goes out of scope.
+template <typename F> struct ScopeExit {
+    F fn_;
+    ~ScopeExit() { fn_(); }
+};
+
+/// @return A guard that calls @p fn on scope exit.
+template <typename F> ScopeExit<F> scope_exit(F fn) { return { std::move(fn) }; }
+
+/// @p ref as stored in a @ref FlatIndex.
+std::span<const std::byte> ref_bytes(const ValueRef &ref) {
+    return std::as_bytes(std::span(&ref, 1));
+}
+
+/// The @ref ValueRef stored as @p data by @ref ref_bytes.
+ValueRef ref_from(std::span<const std::byte> data) {
+    ValueRef ref;
+    std::memcpy(&ref, data.data(), sizeof(ref));
+    return ref;
+}
+
+} // namespace
 
 std::error_code KeyValue::open() {
     if (log_.is_open()) return {};
     if (auto err = log_.open(); err) return err;
 
+    std::lock_guard lock(mu_);
+    compact_pending_ = false;
+
+    std::error_code err;
+    if (values_ == ValueStorage::Disk) {
+        // Checkpoints hold values, not locations; hint files are the fast path here
+        refs_.clear();
+        order_.clear();
+        live_bytes_ = dead_bytes_ = 0;
+        err = log_.replay_keys([this](const KeyRecord &rec) { apply_ref(rec.key_, rec.deleted_, rec.ref_); });
+    } else if (const auto from = load_checkpoint(); replay_threads_ > 1) {
+        // Records arrive as views into the mapped log; apply copies each byte once
+        err = log_.replay_parallel(replay_threads_, [this](std::span<const EntryView> ops) {
+            for (const auto &op : ops) apply(op);
+        }, from);
+    } else {
+        err = log_.replay([this](const RecordView &rec, const LogPosition &) {
+            if (auto *batch = std::get_if<BatchView>(&rec))
+                batch->for_each([this](const EntryView &op) { apply(op); });
+            else
+                apply(std::get<EntryView>(rec));
+        }, from);
+    }
+    if (err) return err;
+
+    if (compaction_.enabled_) {
+        maybe_schedule_compaction();
+        compactor_ = std::jthread([this](std::stop_token stop) { compaction_loop(stop); });
+    }
+    return {};
+}
+
+std::optional<LogPosition> KeyValue::load_checkpoint() {
     mem_.clear();
+    order_.clear();
+    live_bytes_ = dead_bytes_ = 0;
 
-    if (auto err = log_.seek_to_first_entry(); err) return err;
+    auto info = Checkpoint::load(checkpoint_path(path_), [this](std::span<const std::byte> key,
+                                                                std::span<const std::byte> val) {
+        live_bytes_ += record_size(key.size(), val.size());
+        mem_.put(key, val);
+        if (ordered_) order_.insert(key);
+    });
+    // A compaction that crashed before removing the checkpoint leaves it
+    // pointing at a segment that is gone; so does a log replaced by hand
+    if (info.has_value() && log_.contains(info->position_)) {
+        dead_bytes_ = info->dead_bytes_;
+        return info->position_;
+    }
 
-    while (true) {
-        auto result = log_.read();
-        if (!result.has_value())
-            return result.error();
-        if (std::holds_alternative<LogEOF>(result.value()))
-            return {};
+    mem_.clear();
+    order_.clear();
+    live_bytes_ = 0;
+    return std::nullopt;
+}
 
-        auto &ent = std::get<Entry>(result.value());
-        if (ent.deleted_) mem_.erase(ent.key_);
-        else mem_[ent.key_] = ent.val_;
+void KeyValue::apply(const EntryView &op) {
+    const auto old = op.deleted_ ? mem_.erase(op.key_) : mem_.put(op.key_, op.val_);
+    track_order(op.key_, op.deleted_, old.has_value());
+    if (old.has_value()) {
+        // The record that wrote the previous value is garbage from now on
+        const uint64_t size = record_size(op.key_.size(), *old);
+        live_bytes_ -= size;
+        dead_bytes_ += size;
     }
 
-    return {};
+    // A compacted log drops tombstones, so they are dead on arrival
+    if (op.deleted_) dead_bytes_ += record_size(op.key_.size(), 0);
+    else live_bytes_ += record_size(op.key_.size(), op.val_.size());
+}
+
+void KeyValue::apply_ref(std::span<const std::byte> key, bool deleted, const ValueRef &ref) {
+    const auto old = refs_.find(key);
+    track_order(key, deleted, old.has_value());
+    if (old.has_value()) {
+        const uint64_t size = record_size(key.size(), ref_from(*old).val_size_);
+        live_bytes_ -= size;
+        dead_bytes_ += size;
+    }
+
+    if (deleted) {
+        dead_bytes_ += record_size(key.size(), 0);
+        refs_.erase(key);
+        return;
+    }
+
+    live_bytes_ += record_size(key.size(), ref.val_size_);
+    refs_.put(key, ref_bytes(ref));
+}
+
+void KeyValue::track_order(std::span<const std::byte> key, bool deleted, bool existed) {
+    // Overwrites leave the key set, and so the order, unchanged
+    if (!ordered_ || deleted != existed) return;
+    if (deleted) order_.erase(key);
+    else order_.insert(key);
+}
+
+void KeyValue::apply_batch_refs(const WriteBatch &batch, const LogPosition &at) {
+    // Mirrors the batch layout of EntryCodec::encode(const WriteBatch &)
+    size_t size = EntryCodec::HEADER_SIZE + EntryCodec::BATCH_COUNT_SIZE;
+    for (const auto &op : batch.entries())
+        size += EntryCodec::BATCH_OP_HEADER_SIZE + op.key_.size() + (op.deleted_ ? 0 : op.val_.size());
+
+    size_t offset = EntryCodec::HEADER_SIZE + EntryCodec::BATCH_COUNT_SIZE;
+    for (const auto &op : batch.entries()) {
+        offset += EntryCodec::BATCH_OP_HEADER_SIZE + op.key_.size();
+        if (op.deleted_) {
+            apply_ref(op.key_, true, {});
+            continue;
+        }
+        apply_ref(op.key_, false, { at, static_cast<uint32_t>(size), static_cast<uint32_t>(offset),
+                                    static_cast<uint32_t>(op.val_.size()) });
+        offset += op.val_.size();
+    }
 }
 
-std::error_code KeyValue::close() { return log_.close(); }
+void KeyValue::maybe_schedule_compaction() {
+    if (!compaction_.enabled_ || compact_pending_ || dead_bytes_ == 0) return;
+
+    const auto total = static_cast<double>(live_bytes_ + dead_bytes_);
+    bool by_size  = compaction_.max_dead_bytes_ != 0 && dead_bytes_ >= compaction_.max_dead_bytes_;
+    bool by_ratio = dead_bytes_ >= compaction_.min_dead_bytes_
+                 && static_cast<double>(dead_bytes_) >= compaction_.dead_ratio_ * total;
+    if (!by_size && !by_ratio) return;
+
+    compact_pending_ = true;
+    compact_cv_.notify_one();
+}
+
+std::error_code KeyValue::close() {
+    compactor_.request_stop();
+    if (compactor_.joinable()) compactor_.join();
+    return log_.close();
+}
+
+std::error_code KeyValue::sync() { return log_.sync(); }
 
 std::expected<std::optional<bytes>, std::error_code> KeyValue::get(std::span<const std::byte> key) const {
-    auto it = mem_.find(to_bytes(key));
-    if (it == mem_.end()) return std::nullopt;
-    return it->second;
+    bytes val;
+    auto found = get(key, val);
+    if (!found.has_value()) return std::unexpected(found.error());
+    if (!found.value()) return std::nullopt;
+    return val;
+}
+
+std::expected<bool, std::error_code> KeyValue::get(std::span<const std::byte> key, bytes &out) const {
+    if (values_ == ValueStorage::Disk) {
+        // Read under the lock: a compaction deletes segments only after
+        // moving the references out of them, which takes the lock too
+        std::shared_lock lock(mu_);
+        auto ref = refs_.find(key);
+        if (!ref.has_value()) return false;
+        if (auto err = log_.read_value(ref_from(*ref), out); err) return std::unexpected(err);
+        return true;
+    }
+
+    // No lock: the pin keeps the record alive while it is copied
+    auto pin = mem_.pin();
+    auto val = mem_.find(key);
+    if (!val.has_value()) return false;
+    out.assign(val->begin(), val->end());
+    return true;
+}
+
+std::expected<bool, std::error_code> KeyValue::get_view(
+    std::span<const std::byte> key,
+    const std::function<std::error_code(std::span<const std::byte>)> &visit) const {
+    if (values_ == ValueStorage::Disk) {
+        bytes val;
+        {
+            std::shared_lock lock(mu_);
+            auto ref = refs_.find(key);
+            if (!ref.has_value()) return false;
+            if (auto err = log_.read_value(ref_from(*ref), val); err) return std::unexpected(err);
+        }
+        // The value is a copy, so a slow callback holds up no writer
+        if (auto err = visit(val); err) return std::unexpected(err);
+        return true;
+    }
+
+    // The span points into the index arena, kept alive by the pin
+    auto pin = mem_.pin();
+    auto val = mem_.find(key);
+    if (!val.has_value()) return false;
+    if (auto err = visit(*val); err) return std::unexpected(err);
+    return true;
+}
+
+KeyValue::Cursor KeyValue::scan(std::span<const std::byte> begin, std::optional<std::span<const std::byte>> end,
+                                ScanOptions opts) const {
+    Cursor cursor;
+    cursor.kv_    = this;
+    cursor.lower_ = to_bytes(begin);
+    if (end.has_value()) cursor.upper_ = to_bytes(*end);
+    cursor.opts_  = opts;
+    if (!ordered_) {
+        cursor.err_ = std::make_error_code(std::errc::operation_not_supported);
+        return cursor;
+    }
+    cursor.done_ = false;
+    fill(cursor);
+    return cursor;
+}
+
+KeyValue::Cursor KeyValue::scan_prefix(std::span<const std::byte> prefix, ScanOptions opts) const {
+    // The keys with the prefix end before the prefix with its last
+    // non-0xFF byte incremented; a prefix of only 0xFF bytes has no such bound
+    bytes end = to_bytes(prefix);
+    while (!end.empty() && end.back() == std::byte{0xFF}) end.pop_back();
+    if (end.empty()) return scan(prefix, std::nullopt, opts);
+    end.back() = static_cast<std::byte>(static_cast<uint8_t>(end.back()) + 1);
+    return scan(prefix, std::span<const std::byte>(end), opts);
+}
+
+void KeyValue::fill(Cursor &cursor) const {
+    // Resume after the last key handed out, or start at the bound facing the walk
+    std::optional<SmallKey> resume;
+    if (!cursor.keys_.empty()) resume = std::move(cursor.keys_.back());
+    cursor.returned_ += cursor.keys_.size();
+    cursor.keys_.clear();
+    cursor.values_.clear();
+    cursor.ends_.clear();
+    cursor.pos_ = 0;
+
+    const bool reverse = cursor.opts_.reverse_;
+    size_t want = SCAN_BATCH;
+    if (cursor.opts_.limit_ != 0) want = std::min(want, cursor.opts_.limit_ - cursor.returned_);
+    if (want == 0) {
+        cursor.done_ = true;
+        return;
+    }
+
+    std::optional<std::span<const std::byte>> from;
+    bool inclusive = false;
+    if (resume.has_value()) from = resume->view();
+    else if (!reverse) from = std::span<const std::byte>(cursor.lower_), inclusive = true;
+    else if (cursor.upper_.has_value()) from = std::span<const std::byte>(*cursor.upper_);
+
+    auto before = [](std::span<const std::byte> a, std::span<const std::byte> b) {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+    };
+    bool full = false;
+    bytes scratch;
+    std::shared_lock lock(mu_);
+    order_.walk(from, inclusive, reverse, [&](std::span<const std::byte> key) {
+        if (reverse ? before(key, cursor.lower_) : (cursor.upper_ && !before(key, *cursor.upper_)))
+            return false;
+        if (cursor.keys_.size() == want || cursor.values_.size() >= SCAN_BATCH_BYTES) {
+            full = true;
+            return false;
+        }
+
+        std::span<const std::byte> val;
+        if (values_ == ValueStorage::Disk) {
+            if (auto err = log_.read_value(ref_from(*refs_.find(key)), scratch); err) {
+                cursor.err_ = err;
+                return false;
+            }
+            val = scratch;
+        } else {
+            val = *mem_.find(key);
+        }
+        cursor.keys_.emplace_back(key);
+        cursor.values_.insert(cursor.values_.end(), val.begin(), val.end());
+        cursor.ends_.push_back(cursor.values_.size());
+        return true;
+    });
+    cursor.done_ = !full;
+}
+
+void KeyValue::Cursor::next() {
+    if (++pos_ < keys_.size() || done_) return;
+    kv_->fill(*this);
 }
 
 std::expected<bool, std::error_code> KeyValue::set_ex(std::span<const std::byte> key, std::span<const std::byte> val, WriteMode mode) {
-    auto my_key = to_bytes(key);
-    auto my_val = to_bytes(val);
+    // Held until the index is updated, so writes to this key reach the
+    // index in log order; other keys append meanwhile
+    const uint64_t stripe = stripe_of(key);
+    lock_stripes(stripe);
+    auto unlock = scope_exit([&] { unlock_stripes(stripe); });
 
-    auto it = mem_.find(my_key);
-    bool exist = (it != mem_.end());
-    bool updated = false;
+    bool exist = false;
+    bool same  = false;
+    {
+        std::shared_lock lock(mu_);
+        if (values_ == ValueStorage::Disk) {
+            auto ref = refs_.find(key);
+            exist = ref.has_value();
+            // Only a value of the same length can be equal; read it to find out
+            if (exist && mode != WriteMode::Insert && ref_from(*ref).val_size_ == val.size()) {
+                auto old = log_.read_value(ref_from(*ref));
+                if (!old.has_value()) return std::unexpected(old.error());
+                same = std::ranges::equal(old.value(), val);
+            }
+        } else {
+            auto old = mem_.find(key);
+            exist = old.has_value();
+            same  = exist && mode != WriteMode::Insert && std::ranges::equal(*old, val);
+        }
+    }
 
+    bool updated = false;
     switch (mode) {
-        case WriteMode::Upsert: updated = !exist || (it->second != my_val); break;
+        case WriteMode::Upsert: updated = !exist || !same; break;
         case WriteMode::Insert: updated = !exist; break;
-        case WriteMode::Update: updated = exist && (it->second != my_val); break;
+        case WriteMode::Update: updated = exist && !same; break;
     }
 
     if (!updated) return false;
 
-    if (auto err = log_.write(Entry(my_key, my_val, false)); err) {
+    // Readers keep going while the record is appended and synced
+    LogPosition at;
+    if (auto err = log_.write(EntryView{ key, val, false }, &at); err) {
         return std::unexpected(err);
     }
-    mem_.insert_or_assign(my_key, my_val);
+    std::lock_guard lock(mu_);
+    if (values_ == ValueStorage::Disk) apply_ref(key, false, entry_ref(at, key.size(), val.size()));
+    else apply({ key, val, false });
+    maybe_schedule_compaction();
     return updated;
 }
 
@@ -67,14 +387,256 @@ std::expected<bool, std::error_code> KeyValue::set(std::span<const std::byte> ke
 }
 
 std::expected<bool, std::error_code> KeyValue::del(std::span<const std::byte> key) {
-    auto my_key = to_bytes(key);
-    auto it = mem_.find(my_key);
+    const uint64_t stripe = stripe_of(key);
+    lock_stripes(stripe);
+    auto unlock = scope_exit([&] { unlock_stripes(stripe); });
 
-    if (it == mem_.end()) {
-        return false;
+    {
+        std::shared_lock lock(mu_);
+        if (values_ == ValueStorage::Disk ? !refs_.contains(key) : !mem_.contains(key)) {
+            return false;
+        }
     }
-    if (auto err = log_.write(Entry(my_key, {}, true)); err)
+    if (auto err = log_.write(EntryView{ key, {}, true }); err)
         return std::unexpected(err);
-    mem_.erase(it);
+    std::lock_guard lock(mu_);
+    if (values_ == ValueStorage::Disk) apply_ref(key, true, {});
+    else apply({ key, {}, true });
+    maybe_schedule_compaction();
     return true;
 }
+
+std::error_code KeyValue::write(const WriteBatch &batch) {
+    const uint64_t stripes = stripes_of(batch);
+    lock_stripes(stripes);
+    auto unlock = scope_exit([&] { unlock_stripes(stripes); });
+    return write_locked(batch);
+}
+
+std::expected<bool, std::error_code> KeyValue::read_modify_write(
+    std::span<const std::byte> key,
+    const std::function<std::error_code(std::optional<std::span<const std::byte>>, WriteBatch &)> &build) {
+    uint64_t held = stripe_of(key);
+    lock_stripes(held);
+    auto unlock = scope_exit([&] { unlock_stripes(held); });
+
+    while (true) {
+        WriteBatch batch;
+        {
+            std::shared_lock lock(mu_);
+            std::optional<std::span<const std::byte>> current;
+            bytes stored;
+            if (values_ == ValueStorage::Disk) {
+                if (auto ref = refs_.find(key); ref.has_value()) {
+                    if (auto err = log_.read_value(ref_from(*ref), stored); err) return std::unexpected(err);
+                    current = stored;
+                }
+            } else {
+                // Points into the index arena, which no writer changes while the lock is shared
+                current = mem_.find(key);
+            }
+            if (auto err = build(current, batch); err) return std::unexpected(err);
+        }
+        if (batch.empty()) return false;
+
+        // Stripes can only be taken in ascending order, so a batch reaching
+        // beyond the held ones starts over with all of them locked
+        const uint64_t needed = held | stripes_of(batch);
+        if (needed != held) {
+            unlock_stripes(held);
+            held = needed;
+            lock_stripes(held);
+            continue;
+        }
+        if (auto err = write_locked(batch); err) return std::unexpected(err);
+        return true;
+    }
+}
+
+std::error_code KeyValue::write_locked(const WriteBatch &batch) {
+    LogPosition at;
+    if (auto err = log_.write(batch, &at); err) return err;
+    std::lock_guard lock(mu_);
+    if (values_ == ValueStorage::Disk) apply_batch_refs(batch, at);
+    else for (const auto &op : batch.entries()) apply({ op.key_, op.val_, op.deleted_ });
+    maybe_schedule_compaction();
+    return {};
+}
+
+uint64_t KeyValue::stripe_of(std::span<const std::byte> key) noexcept {
+    return uint64_t{1} << (SmallKeyHash{}(key) % WRITE_STRIPES);
+}
+
+uint64_t KeyValue::stripes_of(const WriteBatch &batch) noexcept {
+    uint64_t mask = 0;
+    for (const auto &op : batch.entries()) mask |= stripe_of(op.key_);
+    return mask;
+}
+
+void KeyValue::lock_stripes(uint64_t mask) {
+    for (uint64_t rest = mask; rest != 0; rest &= rest - 1)
+        stripes_[static_cast<size_t>(std::countr_zero(rest))].lock();
+}
+
+void KeyValue::unlock_stripes(uint64_t mask) noexcept {
+    for (uint64_t rest = mask; rest != 0; rest &= rest - 1)
+        stripes_[static_cast<size_t>(std::countr_zero(rest))].unlock();
+}
+
+std::error_code KeyValue::compact() { return compact_now({}); }
+
+std::error_code KeyValue::compact_now(std::stop_token stop) {
+    std::lock_guard compacting(compact_mu_);
+
+    // Copy the index so that writing the new segments does not block
+    // foreground calls; later records land in segments from `keep_from` on.
+    // The copy is made under the lock, so short keys are copied without
+    // allocating
+    std::vector<std::pair<SmallKey, bytes>> snapshot;
+    std::vector<std::pair<SmallKey, ValueRef>> ref_snapshot;
+    uint64_t keep_from = 0;
+    uint64_t dead      = 0;
+    {
+        // Every stripe: no write may be in the sealed segments without being
+        // in the copy.  That already keeps the index still, so the seal and
+        // its syncs run without the lock and readers only share it for the copy
+        lock_stripes(ALL_STRIPES);
+        auto unlock = scope_exit([&] { unlock_stripes(ALL_STRIPES); });
+        if (!log_.is_open()) return std::make_error_code(std::errc::bad_file_descriptor);
+        auto sealed = log_.seal();
+        if (!sealed.has_value()) return sealed.error();
+        keep_from = sealed.value();
+        std::shared_lock lock(mu_);
+        dead = dead_bytes_;
+        if (values_ == ValueStorage::Disk) {
+            ref_snapshot.reserve(refs_.size());
+            refs_.for_each([&](std::span<const std::byte> key, std::span<const std::byte> ref) {
+                ref_snapshot.emplace_back(SmallKey(key), ref_from(ref));
+            });
+        } else {
+            snapshot.reserve(mem_.size());
+            mem_.for_each([&](std::span<const std::byte> key, std::span<const std::byte> val) {
+                snapshot.emplace_back(SmallKey(key), to_bytes(val));
+            });
+        }
+    }
+
+    std::error_code err;
+    if (values_ == ValueStorage::Disk) {
+        // The values come from the sealed segments, which stay until the
+        // references have moved to the copies
+        std::vector<LogPosition> placed;
+        placed.reserve(ref_snapshot.size());
+        err = log_.compact(keep_from, [&](const Log::Emit &emit) -> std::error_code {
+            for (const auto &[key, ref] : ref_snapshot) {
+                if (stop.stop_requested()) return std::make_error_code(std::errc::operation_canceled);
+                auto val = log_.read_value(ref);
+                if (!val.has_value()) return val.error();
+                if (auto err = emit(key, val.value()); err) return err;
+            }
+            return {};
+        }, [&](const LogPosition &at) { placed.push_back(at); }, [&] {
+            std::lock_guard lock(mu_);
+            for (size_t i = 0; i < ref_snapshot.size(); ++i) {
+                const auto &[key, ref] = ref_snapshot[i];
+                // Keys written since the snapshot already point past keep_from
+                auto cur = refs_.find(key);
+                if (!cur.has_value()) continue;
+                const ValueRef now = ref_from(*cur);
+                if (now.record_ != ref.record_ || now.val_offset_ != ref.val_offset_) continue;
+                refs_.put(key, ref_bytes(entry_ref(placed[i], key.size(), ref.val_size_)));
+            }
+        });
+    } else {
+        err = log_.compact(keep_from, [&](const Log::Emit &emit) -> std::error_code {
+            for (const auto &[key, val] : snapshot) {
+                if (stop.stop_requested()) return std::make_error_code(std::errc::operation_canceled);
+                if (auto err = emit(key, val); err) return err;
+            }
+            return {};
+        });
+    }
+    if (err) return err;
+
+    // The segments the checkpoint points into are gone, so it is useless now
+    std::error_code fs_err;
+    std::filesystem::remove(checkpoint_path(path_), fs_err);
+
+    std::lock_guard lock(mu_);
+    // Garbage created after the snapshot sits in the segments that were kept
+    dead_bytes_ -= dead;
+    compact_pending_ = false;
+    ++compactions_;
+    return {};
+}
+
+void KeyValue::compaction_loop(std::stop_token stop) {
+    while (true) {
+        {
+            std::unique_lock lock(mu_);
+            if (!compact_cv_.wait(lock, stop, [this] { return compact_pending_; })) return;
+        }
+
+        auto err = compact_now(stop);
+        if (stop.stop_requested()) return;
+
+        std::unique_lock lock(mu_);
+        compact_err_ = err;
+        if (err) {
+            // Back off so a persistent failure (e.g. a full disk) does not spin
+            compact_cv_.wait_for(lock, stop, COMPACT_RETRY_DELAY, [] { return false; });
+        }
+    }
+}
+
+std::error_code KeyValue::checkpoint() {
+    if (values_ == ValueStorage::Disk) return std::make_error_code(std::errc::operation_not_supported);
+
+    // Keeps a compaction from replacing the segments the position points into
+    std::lock_guard compacting(compact_mu_);
+
+    std::vector<std::pair<SmallKey, bytes>> snapshot;
+    Checkpoint::Info info{};
+    {
+        // Every stripe: each record before the position must be in the copy.
+        // As in compact_now, the sync runs with the index lock free
+        lock_stripes(ALL_STRIPES);
+        auto unlock = scope_exit([&] { unlock_stripes(ALL_STRIPES); });
+        if (!log_.is_open()) return std::make_error_code(std::errc::bad_file_descriptor);
+        auto pos = log_.position();
+        if (!pos.has_value()) return pos.error();
+        std::shared_lock lock(mu_);
+        info.position_   = pos.value();
+        info.dead_bytes_ = dead_bytes_;
+        info.count_      = mem_.size();
+        snapshot.reserve(mem_.size());
+        mem_.for_each([&](std::span<const std::byte> key, std::span<const std::byte> val) {
+            snapshot.emplace_back(SmallKey(key), to_bytes(val));
+        });
+    }
+
+    return Checkpoint::write(checkpoint_path(path_), info, [&](const Log::Emit &emit) -> std::error_code {
+        for (const auto &[key, val] : snapshot) {
+            if (auto err = emit(key, val); err) return err;
+        }
+        return {};
+    });
+}
+
+KeyValue::Stats KeyValue::stats() const {
+    std::shared_lock lock(mu_);
+    return {
+        live_bytes_, dead_bytes_,
+        log_.disk_size().value_or(0), log_.segments().size(),
+        compactions_, compact_err_,
+    };
+}
+
+std::error_code KeyValue::destroy(const std::string &path) {
+    std::error_code fs_err;
+    for (const auto &name : { checkpoint_path(path), checkpoint_path(path) + ".tmp" }) {
+        std::filesystem::remove(name, fs_err);
+        if (fs_err) return fs_err;
+    }
+    return Log::destroy(path);
+}
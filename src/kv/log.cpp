@@ -10,15 +10,20 @@
 #include "core/bit_utils.h"
 #include "kv/log.h"
 #include "kv/log_format.h"
-#include <filesystem>   // std::filesystem::exists, file_size
+#include "kv/hint.h"
+#include <filesystem>   // std::filesystem::exists, file_size, directory_iterator
+#include <utility>      // std::exchange
+#include <optional>     // std::optional
+#include <algorithm>    // std::find, std::all_of, std::min, std::max
+#include <string_view>  // std::string_view
 
 /**
  * @brief Writes the 6-byte file header to @p fh.
  *
- * Must be called exactly once on a newly created (empty) log file.
- * Layout: `[ magic(4) | version(2) ]`, both little-endian.
+ * Written at offset 0 of a newly created segment, or over the header of an
+ * older-version segment.  Layout: `[ magic(4) | version(2) ]`, both little-endian.
  *
- * @param fh An open, empty file handle positioned at offset 0.
+ * @param fh An open file handle; its file position is not used.
  * @return Empty error code on success; platform I/O error otherwise.
  */
 static std::error_code write_file_header(FileHandle &fh) {
@@ -30,7 +35,7 @@ static std::error_code write_file_header(FileHandle &fh) {
     std::copy(magic.begin(), magic.end(), header.begin());
     std::copy(version.begin(), version.end(), header.begin() + 4);
 
-    return platform_write(fh, std::span<const std::byte>(header));
+    return platform_pwrite(fh, std::span<const std::byte>(header), 0);
 }
 
 /**
@@ -39,22 +44,23 @@ static std::error_code write_file_header(FileHandle &fh) {
  * Checks the magic number against @ref log_format::MAGIC and rejects files
  * whose format version exceeds @ref log_format::FORMAT_VERSION.
  *
- * @param fh An open file handle positioned at offset 0.
+ * @param fh      An open file handle; its file position is not used.
+ * @param version Receives the stored format version on success.
  * @return Empty error code on success; @ref db_error::bad_magic,
  *         @ref db_error::unsupported_version, @ref db_error::truncated_header,
  *         or a platform I/O error otherwise.
  */
-static std::error_code read_and_validate_file_header(FileHandle &fh) {
+static std::error_code read_and_validate_file_header(FileHandle &fh, uint16_t &version) {
     std::array<std::byte, log_format::HEADER_SIZE> header;
     size_t bytes_read = 0;
 
-    if (auto err = platform_read(fh, std::span<std::byte>(header), bytes_read); err)
+    if (auto err = platform_pread(fh, std::span<std::byte>(header), 0, bytes_read); err)
         return err;
     if (bytes_read < log_format::HEADER_SIZE)
         return db_error::truncated_header;
 
     uint32_t magic = unpack_le<uint32_t>(std::span<const std::byte>(header).subspan<0, 4>());
-    uint16_t version = unpack_le<uint16_t>(std::span<const std::byte>(header).subspan<4, 2>());
+    version = unpack_le<uint16_t>(std::span<const std::byte>(header).subspan<4, 2>());
 
     if (magic != log_format::MAGIC)
         return db_error::bad_magic;
@@ -64,6 +70,120 @@ static std::error_code read_and_validate_file_header(FileHandle &fh) {
     return {};
 }
 
+/**
+ * @brief Classifies a file name found next to the log @p base.
+ * @param name File name (without directory) to classify.
+ * @param base File name of the log itself.
+ * @return The segment id @p name stands for, or `std::nullopt` if it is not
+ *         a segment of @p base (ids are written without leading zeros).
+ */
+static std::optional<uint64_t> segment_id(std::string_view name, std::string_view base) {
+    if (name == base) return 0;
+    if (name.size() <= base.size() + 1 || !name.starts_with(base) || name[base.size()] != '.')
+        return std::nullopt;
+
+    auto digits = name.substr(base.size() + 1);
+    if (digits.front() == '0' || digits.size() > 19) return std::nullopt;
+    uint64_t id = 0;
+    for (char c : digits) {
+        if (c < '0' || c > '9') return std::nullopt;
+        id = id * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return id;
+}
+
+/**
+ * @brief Removes every file of the log at @p path that @p keep rejects.
+ *
+ * Considers the segments of the log plus its manifest and temporaries.
+ * A hint file goes with its segment; a half-written one always goes.
+ *
+ * @param path Path of the log (segment 0).
+ * @param keep Returns `true` for segment ids that must survive.
+ * @return Empty error code on success; a filesystem error otherwise.
+ */
+template <typename Keep>
+static std::error_code remove_files(const std::string &path, Keep keep) {
+    namespace fs = std::filesystem;
+    fs::path log_path(path);
+    fs::path dir = log_path.has_parent_path() ? log_path.parent_path() : fs::path(".");
+    const std::string base = log_path.filename().string();
+    // `.compact` is the temporary of the older single-file compaction
+    const std::string temps[] = { base + ".manifest.tmp", base + ".compact" };
+
+    std::error_code err;
+    for (auto it = fs::directory_iterator(dir, err); !err && it != fs::directory_iterator(); it.increment(err)) {
+        const std::string name = it->path().filename().string();
+        std::string_view stem = name;
+        const bool hint_tmp = stem.ends_with(".hint.tmp");
+        if (hint_tmp) stem.remove_suffix(4);
+        const bool hint = stem.ends_with(".hint");
+        if (hint) stem.remove_suffix(5);
+
+        auto id = segment_id(stem, base);
+        bool ours = id.has_value() ? (hint_tmp || !keep(*id))
+                  : (!hint && std::find(std::begin(temps), std::end(temps), name) != std::end(temps));
+        if (ours) fs::remove(it->path(), err);
+    }
+    return err;
+}
+
+/**
+ * @brief Reads the whole manifest file at @p path.
+ * @param path Path of the manifest.
+ * @return The decoded manifest, or a decode or I/O error.
+ */
+static std::expected<Manifest, std::error_code> load_manifest(const std::string &path) {
+    std::error_code fs_err;
+    auto size = std::filesystem::file_size(path, fs_err);
+    if (fs_err) return std::unexpected(fs_err);
+
+    FileHandle fh;
+    if (auto err = platform_open_file(path, fh); err) return std::unexpected(err);
+    bytes data(size);
+    size_t n = 0;
+    if (auto err = platform_read(fh, std::span<std::byte>(data), n); err) return std::unexpected(err);
+    if (n != size) return std::unexpected(db_error::bad_manifest);
+    return Manifest::decode(data);
+}
+
+namespace {
+
+/**
+ * @brief Whether @p err is how a record cut short by a crash decodes.
+ * @param err A decode error.
+ * @return `true` for @ref db_error::bad_checksum, @ref db_error::truncated_header,
+ *         @ref db_error::truncated_payload and @ref db_error::trailing_garbage
+ *         (a zeroed hole, see @ref zero_hole).
+ */
+bool is_torn_tail(std::error_code err) {
+    return err == db_error::bad_checksum || err == db_error::truncated_header || err == db_error::truncated_payload ||
+           err == db_error::trailing_garbage;
+}
+
+/**
+ * @brief Reports an @ref EntryEOF decoded at @p start of a segment of
+ *        @p size bytes as @ref db_error::trailing_garbage if bytes follow it.
+ *
+ * An all-zero header only ends the records when nothing but the rest of the
+ * segment comes after it.  A crash can also leave zeros in front of later
+ * bytes, e.g. a group that reached the disk after the one behind it, or
+ * preallocated space with records written past it; the records stop at the
+ * hole, and so must the appends.  Like a torn record, the hole is cut off
+ * the active segment and is corruption anywhere else.
+ *
+ * @param result A decode result for the record at @p start.
+ * @return @p result, or the error if it is such a hole.
+ */
+template <typename Result>
+Result zero_hole(Result result, uint64_t start, uint64_t size) {
+    if (result.has_value() && std::holds_alternative<EntryEOF>(result.value()) && start < size)
+        return std::unexpected(std::error_code(db_error::trailing_garbage));
+    return result;
+}
+
+} // namespace
+
 std::error_code Log::open() {
     if (fh_.is_open()) return {};
 
@@ -71,58 +191,1030 @@ std::error_code Log::open() {
     if (std::filesystem::exists(filename_) && std::filesystem::is_directory(filename_))
         return make_error_code(std::errc::is_a_directory);
 
-    if (auto err = platform_open_file(filename_, fh_)) return err;
+    Manifest manifest;
+    if (std::filesystem::exists(manifest_path())) {
+        auto loaded = load_manifest(manifest_path());
+        if (!loaded.has_value()) return loaded.error();
+        manifest = std::move(loaded.value());
+        for (uint64_t id : manifest.segments_)
+            if (!std::filesystem::exists(segment_path(id))) return db_error::missing_segment;
+    }
+
+    // Leftovers of a roll or compaction that crashed before (or just after) its manifest update
+    auto listed = [&manifest](uint64_t id) {
+        return std::find(manifest.segments_.begin(), manifest.segments_.end(), id) != manifest.segments_.end();
+    };
+    if (auto err = remove_files(filename_, listed); err) return err;
+
+    const std::string active = segment_path(manifest.segments_.back());
+    if (auto err = platform_open_file(active, fh_)) return err;
 
     std::error_code fs_err;
-    auto size = std::filesystem::file_size(filename_, fs_err);
+    auto size = std::filesystem::file_size(active, fs_err);
     if (fs_err) return fs_err;
 
-    if (size == 0) return write_file_header(fh_);
+    if (size == 0) {
+        if (auto err = write_file_header(fh_); err) return err;
+        size = log_format::HEADER_SIZE;
+    } else {
+        uint16_t version = 0;
+        if (auto err = read_and_validate_file_header(fh_, version); err) return err;
+
+        // Every older format is a subset of the current one; restamp the
+        // header so older builds refuse the file once newer records exist.
+        if (version < log_format::FORMAT_VERSION) {
+            if (auto err = write_file_header(fh_); err) return err;
+            if (auto err = platform_sync(fh_); err) return err;
+        }
+    }
+
+    // A zeroed end means preallocated space the last run never trimmed
+    // (it did not close cleanly); find where the records actually stop
+    allocated_ = tail_ = size;
+    if (size > log_format::HEADER_SIZE) {
+        std::array<std::byte, EntryCodec::HEADER_SIZE> end{};
+        size_t n = std::min<uint64_t>(end.size(), size - log_format::HEADER_SIZE);
+        if (auto err = platform_pread(fh_, std::span(end).first(n), size - n, n); err) return err;
+        if (std::all_of(end.begin(), end.begin() + n, [](std::byte b) { return b == std::byte{0}; })) {
+            if (auto err = recover_tail(); err) return err;
+        }
+    }
+    active_id_ = manifest.segments_.back();
+    {
+        std::lock_guard lock(manifest_mu_);
+        manifest_ = std::move(manifest);
+    }
 
-    if (auto err = platform_seek(fh_, 0, SEEK_SET); err) return err;
-    return read_and_validate_file_header(fh_);
+    if (policy_.mode_ == SyncMode::Interval)
+        flusher_ = std::jthread([this](std::stop_token stop) { flush_loop(stop); });
+    if (hints_)
+        hinter_ = std::jthread([this](std::stop_token stop) { hint_loop(stop); });
+    if (prealloc_size_ != 0)
+        filler_ = std::jthread([this](std::stop_token stop) { fill_loop(stop); });
+    return {};
 }
 
 std::error_code Log::close() {
-    return platform_close(fh_);
+    if (flusher_.joinable()) {
+        flusher_.request_stop();
+        flusher_.join();
+    }
+    if (hinter_.joinable()) {
+        hinter_.request_stop();
+        hinter_.join();
+    }
+    if (filler_.joinable()) {
+        filler_.request_stop();
+        filler_.join();
+    }
+    {
+        std::lock_guard lock(fill_mu_);
+        fill_from_ = fill_to_ = 0;
+    }
+    {
+        std::lock_guard lock(hint_mu_);
+        hint_queue_.clear();
+    }
+
+    std::error_code err;
+    if (fh_.is_open()) {
+        err = exclusive([this] { return trim(); });
+        if (auto sync_err = sync(); sync_err && !err) err = sync_err;
+    }
+    if (auto close_err = platform_close(fh_); close_err && !err) err = close_err;
+    end_replay();
+    {
+        std::lock_guard lock(readers_mu_);
+        readers_.clear();
+    }
+    return err;
+}
+
+std::error_code Log::sync() {
+    return exclusive([this] {
+        if (flush_err_) return std::exchange(flush_err_, {});
+        return sync_file();
+    });
+}
+
+std::error_code Log::sync_file() {
+    if (unsynced_ == 0) return {};
+    if (policy_.on_sync_) policy_.on_sync_();
+    if (auto err = platform_datasync(fh_); err) return err;
+    unsynced_ = 0;
+    return {};
+}
+
+void Log::flush_loop(std::stop_token stop) {
+    std::unique_lock lock(write_mu_);
+    while (!flush_cv_.wait_for(lock, stop, policy_.interval_, [] { return false; })) {
+        if (stop.stop_requested()) break;
+        lock.unlock();
+        exclusive([this] {
+            if (auto err = sync_file(); err) flush_err_ = err;
+            return std::error_code{};
+        });
+        lock.lock();
+    }
+}
+
+std::vector<uint64_t> Log::segments() const {
+    std::lock_guard lock(manifest_mu_);
+    return manifest_.segments_;
+}
+
+std::expected<uint64_t, std::error_code> Log::disk_size() const {
+    std::lock_guard lock(manifest_mu_);
+    uint64_t total = 0;
+    for (uint64_t id : manifest_.segments_) {
+        std::error_code fs_err;
+        auto size = std::filesystem::file_size(segment_path(id), fs_err);
+        if (fs_err) return std::unexpected(fs_err);
+        total += size;
+    }
+    return total;
+}
+
+std::error_code Log::destroy(const std::string &fname) {
+    std::error_code fs_err;
+    std::filesystem::remove(fname + ".manifest", fs_err);
+    if (fs_err) return fs_err;
+    return remove_files(fname, [](uint64_t) { return false; });
+}
+
+uint64_t Log::allocate_id() {
+    std::lock_guard lock(manifest_mu_);
+    return manifest_.next_id_++;
 }
 
-std::error_code Log::write(const Entry &ent) {
-    if (auto err = platform_seek(fh_, 0, SEEK_END); err) return err;
+std::error_code Log::store_manifest(const Manifest &next) {
+    const std::string tmp = manifest_path() + ".tmp";
+    bytes data = next.encode();
 
-    bytes data = EntryCodec::encode(ent);
-    if (auto err = platform_write(fh_, std::span<const std::byte>(data)); err)
+    FileHandle out;
+    if (auto err = platform_open_file(tmp, out); err) return err;
+    std::error_code err = platform_write(out, std::span<const std::byte>(data));
+    if (!err) err = platform_sync(out);
+    if (auto close_err = platform_close(out); close_err && !err) err = close_err;
+    if (!err) err = platform_rename(tmp, manifest_path());
+    if (err) {
+        std::error_code fs_err;
+        std::filesystem::remove(tmp, fs_err);
         return err;
-    return platform_sync(fh_);
+    }
+
+    std::lock_guard lock(manifest_mu_);
+    manifest_.segments_ = next.segments_;
+    return {};
 }
 
-ReadResult Log::read() {
-    auto result = EntryCodec::decode(fh_);
+std::error_code Log::recover_tail() {
+    BufferedReader reader;
+    reader.attach(fh_, log_format::HEADER_SIZE);
+    while (true) {
+        const uint64_t start = reader.offset();
+        auto result = EntryCodec::decode(reader);
+        if (!result.has_value() && !is_torn_tail(result.error())) return result.error();
+        if (!result.has_value() || std::holds_alternative<EntryEOF>(result.value())) {
+            if (auto err = truncate_active(start); err) return err;
+            tail_ = start;
+            return {};
+        }
+    }
+}
+
+std::error_code Log::reserve(uint64_t need) {
+    if (prealloc_size_ == 0) return {};
+    {
+        // Keep the filler clear of the append that follows
+        std::lock_guard lock(fill_mu_);
+        if (fill_id_ == active_id_) fill_from_ = std::max(fill_from_, need);
+    }
+    // Half a chunk early, so that the filler is done by the time the appends get there
+    if (need + prealloc_size_ / 2 <= allocated_) return {};
+
+    const uint64_t target = std::max(need, std::min(allocated_ + prealloc_size_, segment_size_));
+    if (target <= allocated_) return {};
+    auto err = platform_allocate(fh_, allocated_, target - allocated_);
+    if (err == std::errc::operation_not_supported) {
+        prealloc_size_ = 0;     // plain appends from now on
+        return {};
+    }
+    if (err) return err;
+
+    {
+        std::lock_guard lock(fill_mu_);
+        if (fill_id_ != active_id_) {
+            fill_id_   = active_id_;
+            fill_from_ = std::max(allocated_, need);
+        }
+        fill_to_ = target;
+    }
+    fill_cv_.notify_one();
+    allocated_ = target;
+    return {};
+}
+
+std::error_code Log::truncate_active(uint64_t size) {
+    // Under the lock, so no zero-fill lands past the new end and regrows the file
+    std::lock_guard lock(fill_mu_);
+    if (auto err = platform_truncate(fh_, size); err) return err;
+    allocated_ = size;
+    fill_from_ = fill_to_ = std::min(fill_to_, size);
+    return {};
+}
+
+void Log::fill_loop(std::stop_token stop) {
+    static const std::array<std::byte, ZERO_FILL_SIZE> zeros{};
+    FileHandle fh;
+    uint64_t   fh_id = 0;
+    while (true) {
+        {
+            // One step per turn of the lock, so the leader never waits for more than one
+            std::unique_lock lock(fill_mu_);
+            if (!fill_cv_.wait(lock, stop, [this] { return fill_from_ < fill_to_; })) break;
+            if (!fh.is_open() || fh_id != fill_id_) {
+                platform_close(fh);
+                if (platform_open_file(segment_path(fill_id_), fh)) {
+                    fill_from_ = fill_to_;
+                    continue;
+                }
+                fh_id = fill_id_;
+            }
+            const uint64_t at  = fill_from_;
+            const size_t   len = static_cast<size_t>(std::min<uint64_t>(ZERO_FILL_SIZE, fill_to_ - at));
+            if (platform_pwrite(fh, std::span<const std::byte>(zeros.data(), len), at)) {
+                fill_from_ = fill_to_;
+                continue;
+            }
+            fill_from_ = at + len;
+            if (fill_from_ < fill_to_) continue;
+        }
+        // Caught up: the chunk's extent changes are journaled here rather than by a commit
+        platform_datasync(fh);
+        platform_close(fh);     // a sealed segment may be deleted by a compaction
+    }
+    platform_close(fh);
+}
+
+std::error_code Log::trim() {
+    if (allocated_ <= tail_) return {};
+    return truncate_active(tail_);
+}
+
+std::error_code Log::roll() {
+    if (auto err = trim(); err) return err;
+    if (auto err = sync_file(); err) return err;
+
+    const uint64_t id = allocate_id();
+    FileHandle next;
+    std::error_code fs_err;
+    std::filesystem::remove(segment_path(id), fs_err);
+    if (auto err = platform_open_file(segment_path(id), next); err) return err;
+    std::error_code err = write_file_header(next);
+    if (!err) err = platform_sync(next);
+
+    if (!err) {
+        Manifest updated;
+        {
+            std::lock_guard lock(manifest_mu_);
+            updated = manifest_;
+        }
+        updated.segments_.push_back(id);
+        err = store_manifest(updated);
+    }
+    if (err) {
+        platform_close(next);
+        std::filesystem::remove(segment_path(id), fs_err);
+        return err;
+    }
+
+    platform_close(fh_);
+    fh_ = std::move(next);
+    queue_hint(active_id_);
+    active_id_ = id;
+    tail_ = allocated_ = log_format::HEADER_SIZE;
+    return {};
+}
+
+std::expected<uint64_t, std::error_code> Log::seal() {
+    uint64_t active = 0;
+    auto err = exclusive([&]() -> std::error_code {
+        if (tail_ > log_format::HEADER_SIZE) {
+            if (auto err = roll(); err) return err;
+        }
+        std::lock_guard lock(manifest_mu_);
+        active = manifest_.segments_.back();
+        return {};
+    });
+    if (err) return std::unexpected(err);
+    return active;
+}
+
+std::error_code Log::write(const Entry &ent, LogPosition *at) {
+    return write(EntryView{ ent.key_, ent.val_, ent.deleted_ }, at);
+}
+
+std::error_code Log::write(const EntryView &ent, LogPosition *at) {
+    auto header = EntryCodec::encode_header(ent.key_, ent.val_, ent.deleted_);
+    return append({ std::span<const std::byte>(header), ent.key_,
+                    ent.deleted_ ? std::span<const std::byte>() : std::span<const std::byte>(ent.val_) }, at);
+}
+
+std::error_code Log::write(const WriteBatch &batch, LogPosition *at) {
+    if (batch.empty()) return {};
+    auto data = EntryCodec::encode(batch);
+    if (!data.has_value()) return data.error();
+    return append({ std::span<const std::byte>(data.value()), {}, {} }, at);
+}
+
+std::error_code Log::append(std::array<std::span<const std::byte>, 3> parts, LogPosition *at) {
+    Writer self{parts, parts[0].size() + parts[1].size() + parts[2].size(), nullptr, {}, false, at};
+    return commit(self);
+}
+
+std::error_code Log::exclusive(const std::function<std::error_code()> &action) {
+    Writer self{{}, 0, &action, {}, false};
+    return commit(self);
+}
+
+/**
+ * @details
+ * Leader/follower group commit:
+ * 1. Enqueue this writer and sleep until it is either at the front of the
+ *    queue (it becomes the leader) or a previous leader has completed it.
+ * 2. A barrier (see @ref exclusive) runs its action alone.  Otherwise the
+ *    leader collects the pieces of every queued record up to the next
+ *    barrier, capped at @ref MAX_GROUP_SIZE, and releases the lock so new
+ *    writers can queue behind the group.  Nothing is copied: the pieces
+ *    stay in the buffers of the waiting writers.
+ * 3. If the group would push the active segment past the segment size,
+ *    the leader first seals it (see @ref roll); if it comes within half a
+ *    chunk of the end of the preallocated space, the leader reserves
+ *    another chunk for the filler to zero (see @ref reserve).  The group
+ *    is written at
+ *    @ref tail_ with one `pwritev` and, if the @ref SyncPolicy asks for
+ *    it, made durable with one `fdatasync`; the leader then pops the group,
+ *    hands each member the shared result, and wakes the next leader.
+ *    @ref tail_ only advances on success, so the next group overwrites
+ *    whatever part of a failed write reached the file.
+ *
+ * Only the current leader touches @ref fh_, @ref tail_, @ref allocated_,
+ * @ref unsynced_ and @ref iov_, so none of them needs @ref write_mu_.
+ */
+std::error_code Log::commit(Writer &self) {
+    std::unique_lock lock(write_mu_);
+    writers_.push_back(&self);
+    write_cv_.wait(lock, [&] { return self.done_ || writers_.front() == &self; });
+    if (self.done_) return self.err_;
+
+    Writer *last = &self;
+    std::error_code err;
+    uint64_t at = 0;    // where the group starts
+
+    if (self.action_) {
+        lock.unlock();
+        err = (*self.action_)();
+    } else {
+        // Gather the group; a lone writer skips the gather and writes its own pieces.
+        size_t group_size = self.size_;
+        iov_.clear();
+        for (auto it = writers_.begin() + 1; it != writers_.end(); ++it) {
+            if ((*it)->action_) break;
+            if (group_size + (*it)->size_ > MAX_GROUP_SIZE) break;
+            if (iov_.empty()) iov_.assign(self.parts_.begin(), self.parts_.end());
+            iov_.insert(iov_.end(), (*it)->parts_.begin(), (*it)->parts_.end());
+            group_size += (*it)->size_;
+            last = *it;
+        }
+        lock.unlock();
+
+        if (tail_ > log_format::HEADER_SIZE && tail_ + group_size > segment_size_)
+            err = roll();
+        if (!err) err = reserve(tail_ + group_size);
+        if (!err) err = platform_pwritev(fh_, iov_.empty() ? std::span<const std::span<const std::byte>>(self.parts_)
+                                                           : std::span<const std::span<const std::byte>>(iov_),
+                                         tail_);
+        if (!err) {
+            at = tail_;
+            tail_ += group_size;
+            unsynced_ += group_size;
+            if (policy_.mode_ == SyncMode::PerWrite ||
+                (policy_.mode_ == SyncMode::Bytes && unsynced_ >= policy_.bytes_))
+                err = sync_file();
+        }
+    }
+
+    lock.lock();
+    while (true) {
+        Writer *member = writers_.front();
+        writers_.pop_front();
+        member->err_ = err;
+        if (!err && member->at_) *member->at_ = { active_id_, at };
+        at += member->size_;
+        member->done_ = true;
+        if (member == last) break;
+    }
+    write_cv_.notify_all();
+    return err;
+}
 
-    // Treat tail corruption as EOF silently, future implementation should have a flag to trigger a warning.
-    if (!result.has_value()) {
-        auto err = result.error();
-        if (err == db_error::bad_checksum || err == db_error::truncated_header || err == db_error::truncated_payload)
-            return LogEOF{};
+/**
+ * @details
+ * 1. Stream the live set into freshly allocated segments, buffering encoded
+ *    entries into large writes and starting a new segment whenever the
+ *    current one reaches the segment size.  Each finished segment is
+ *    `fsync`ed.  Appends keep flowing into the active segment meanwhile.
+ * 2. As a barrier: replace the segments before @p keep_from with the new
+ *    ones in a single manifest update.
+ * 3. Let the caller move its @ref ValueRef "value references" over
+ *    (@p installed), then drop the cached read handles of the replaced
+ *    segments and delete them.
+ *
+ * A crash before the manifest update leaves the old segments in force; a
+ * crash after it leaves the new ones.  Either way the segments the manifest
+ * does not list are removed on the next @ref open.
+ */
+std::error_code Log::compact(uint64_t keep_from, const std::function<std::error_code(const Emit &)> &live,
+                             const std::function<void(const LogPosition &)> &placed,
+                             const std::function<void()> &installed) {
+    std::lock_guard compacting(compact_mu_);
+
+    std::vector<uint64_t> outputs;
+    FileHandle out;
+    uint64_t out_size = 0;
+    bytes buf;
+    buf.reserve(COPY_CHUNK_SIZE);
+
+    auto fail = [&](std::error_code err) {
+        platform_close(out);
+        std::error_code fs_err;
+        for (uint64_t id : outputs) std::filesystem::remove(segment_path(id), fs_err);
+        return err;
+    };
+    auto flush = [&]() -> std::error_code {
+        if (buf.empty()) return {};
+        auto err = platform_pwrite(out, std::span<const std::byte>(buf), out_size - buf.size());
+        buf.clear();
+        return err;
+    };
+    auto finish = [&]() -> std::error_code {
+        if (!out.is_open()) return {};
+        if (auto err = flush(); err) return err;
+        if (auto err = platform_sync(out); err) return err;
+        return platform_close(out);
+    };
+
+    Emit emit = [&](std::span<const std::byte> key, std::span<const std::byte> val) -> std::error_code {
+        const size_t size = EntryCodec::HEADER_SIZE + key.size() + val.size();
+        if (out.is_open() && out_size > log_format::HEADER_SIZE && out_size + size > segment_size_) {
+            if (auto err = finish(); err) return err;
+        }
+        if (!out.is_open()) {
+            outputs.push_back(allocate_id());
+            if (auto err = platform_open_file(segment_path(outputs.back()), out); err) return err;
+            if (auto err = write_file_header(out); err) return err;
+            out_size = log_format::HEADER_SIZE;
+        }
+        auto header = EntryCodec::encode_header(key, val, false);
+        buf.insert(buf.end(), header.begin(), header.end());
+        buf.insert(buf.end(), key.begin(), key.end());
+        buf.insert(buf.end(), val.begin(), val.end());
+        if (placed) placed({ outputs.back(), out_size });
+        out_size += size;
+        return buf.size() < COPY_CHUNK_SIZE ? std::error_code{} : flush();
+    };
+    if (auto err = live(emit); err) return fail(err);
+    if (auto err = finish(); err) return fail(err);
 
-        return std::unexpected(err);
+    std::vector<uint64_t> replaced;
+    auto swap_err = exclusive([&]() -> std::error_code {
+        Manifest updated;
+        {
+            std::lock_guard lock(manifest_mu_);
+            updated = manifest_;
+        }
+        auto keep = std::find(updated.segments_.begin(), updated.segments_.end(), keep_from);
+        if (keep == updated.segments_.end())
+            return std::make_error_code(std::errc::invalid_argument);
+
+        replaced.assign(updated.segments_.begin(), keep);
+        updated.segments_.erase(updated.segments_.begin(), keep);
+        updated.segments_.insert(updated.segments_.begin(), outputs.begin(), outputs.end());
+        return store_manifest(updated);
+    });
+    if (swap_err) return fail(swap_err);
+
+    if (installed) installed();
+    for (uint64_t id : outputs) queue_hint(id);
+
+    {
+        // Windows refuses to delete a file that is still open
+        std::lock_guard lock(readers_mu_);
+        for (uint64_t id : replaced) readers_.erase(id);
     }
+    // Anything left behind here is removed by the next open
+    std::error_code fs_err;
+    for (uint64_t id : replaced) std::filesystem::remove(segment_path(id), fs_err);
+    return {};
+}
 
-    return std::visit(
-        []<typename T>(T &&val) -> ReadResult {
-            if constexpr (std::is_same_v<std::decay_t<T>, Entry>)
-                return std::forward<T>(val);
-            else
+std::error_code Log::open_replay_segment() {
+    platform_close(rfh_);
+    const std::string path = segment_path(replay_[replay_pos_]);
+    if (!std::filesystem::exists(path)) return db_error::missing_segment;
+
+    if (auto err = platform_open_file(path, rfh_); err) return err;
+    uint16_t version = 0;
+    if (auto err = read_and_validate_file_header(rfh_, version); err) return err;
+    replay_reader_->attach(rfh_, log_format::HEADER_SIZE);
+    return {};
+}
+
+ReadResult Log::read() {
+    while (rfh_.is_open()) {
+        const uint64_t start = replay_reader_->offset();
+        auto result = EntryCodec::decode(*replay_reader_);
+        const bool last = replay_pos_ + 1 == replay_.size();
+        if (result.has_value() && std::holds_alternative<EntryEOF>(result.value())) {
+            std::error_code fs_err;
+            const uint64_t size = std::filesystem::file_size(segment_path(replay_[replay_pos_]), fs_err);
+            if (fs_err) return std::unexpected(fs_err);
+            result = zero_hole(std::move(result), start, size);
+        }
+
+        // Treat tail corruption as EOF silently, future implementation should have a flag to trigger a warning.
+        if (!result.has_value()) {
+            auto err = result.error();
+            if (last && is_torn_tail(err)) {
+                end_replay();
+                if (auto cut_err = cut_torn_tail(replay_.back(), start); cut_err) return std::unexpected(cut_err);
                 return LogEOF{};
-        },
-        std::move(result.value())
-    );
+            }
+            return std::unexpected(err);
+        }
+
+        if (std::holds_alternative<EntryEOF>(result.value())) {
+            if (last) {
+                end_replay();
+                return LogEOF{};
+            }
+            ++replay_pos_;
+            if (auto err = open_replay_segment(); err) return std::unexpected(err);
+            continue;
+        }
+
+        return std::visit(
+            []<typename T>(T &&val) -> ReadResult {
+                if constexpr (std::is_same_v<std::decay_t<T>, EntryEOF>)
+                    return LogEOF{};
+                else
+                    return std::forward<T>(val);
+            },
+            std::move(result.value())
+        );
+    }
+    return LogEOF{};
+}
+
+std::error_code Log::cut_torn_tail(uint64_t id, uint64_t start) {
+    // Cut the torn record off the active segment so appends continue from the last good one
+    if (id != segments().back() || !fh_.is_open()) return {};
+    if (auto err = truncate_active(start); err) return err;
+    tail_ = start;
+    return {};
+}
+
+std::expected<std::shared_ptr<FileHandle>, std::error_code> Log::reader(uint64_t id) const {
+    std::lock_guard lock(readers_mu_);
+    auto it = readers_.find(id);
+    if (it != readers_.end()) return it->second;
+
+    // Opening would create a missing segment
+    const std::string path = segment_path(id);
+    if (!std::filesystem::exists(path)) return std::unexpected(db_error::missing_segment);
+    auto fh = std::make_shared<FileHandle>();
+    if (auto err = platform_open_file(path, *fh); err) return std::unexpected(err);
+    readers_.emplace(id, fh);
+    return fh;
+}
+
+std::expected<bytes, std::error_code> Log::read_value(const ValueRef &ref) const {
+    bytes buf;
+    if (auto err = read_value(ref, buf); err) return std::unexpected(err);
+    return buf;
+}
+
+std::error_code Log::read_value(const ValueRef &ref, bytes &out) const {
+    if (size_t{ref.val_offset_} + ref.val_size_ > ref.size_)
+        return std::make_error_code(std::errc::invalid_argument);
+    auto fh = reader(ref.record_.segment_);
+    if (!fh.has_value()) return fh.error();
+
+    out.resize(ref.size_);
+    size_t n = 0;
+    if (auto err = platform_pread(**fh, std::span(out), ref.record_.offset_, n); err) return err;
+    if (n < out.size()) return db_error::truncated_payload;
+
+    // Decoding verifies the checksum; the views themselves are not needed
+    size_t offset = 0;
+    auto result = EntryCodec::decode_view(out, offset);
+    if (!result.has_value()) return result.error();
+    if (std::holds_alternative<EntryEOF>(result.value()) || offset != out.size())
+        return db_error::truncated_header;
+
+    // Shift the value to the front of the record buffer rather than allocating one for it
+    out.erase(out.begin(), out.begin() + ref.val_offset_);
+    out.resize(ref.val_size_);
+    return {};
+}
+
+std::error_code Log::map_segment(uint64_t id, FileMapping &out) const {
+    const std::string path = segment_path(id);
+    if (!std::filesystem::exists(path)) return db_error::missing_segment;
+
+    FileHandle fh;
+    if (auto err = platform_open_file(path, fh); err) return err;
+    uint16_t version = 0;
+    if (auto err = read_and_validate_file_header(fh, version); err) return err;
+
+    std::error_code fs_err;
+    const uint64_t size = std::filesystem::file_size(path, fs_err);
+    if (fs_err) return fs_err;
+    return platform_map(fh, size, out);     // the mapping outlives the handle
+}
+
+/**
+ * @brief Finds where a replay of @p ids starts.
+ * @param ids  The segment list.
+ * @param from Requested start; the beginning of the log when empty.
+ * @return Index into @p ids and offset of the first record, or
+ *         @ref db_error::missing_segment if @p from names no listed segment.
+ */
+static std::expected<std::pair<size_t, uint64_t>, std::error_code>
+replay_start(const std::vector<uint64_t> &ids, const std::optional<LogPosition> &from) {
+    if (!from) return std::pair<size_t, uint64_t>{ 0, log_format::HEADER_SIZE };
+    auto it = std::find(ids.begin(), ids.end(), from->segment_);
+    if (it == ids.end()) return std::unexpected(db_error::missing_segment);
+    return std::pair<size_t, uint64_t>{ static_cast<size_t>(it - ids.begin()),
+                                        std::max<uint64_t>(from->offset_, log_format::HEADER_SIZE) };
+}
+
+std::expected<LogPosition, std::error_code> Log::position() {
+    LogPosition pos;
+    auto err = exclusive([&]() -> std::error_code {
+        if (auto err = sync_file(); err) return err;
+        std::lock_guard lock(manifest_mu_);
+        pos = { manifest_.segments_.back(), tail_ };
+        return {};
+    });
+    if (err) return std::unexpected(err);
+    return pos;
+}
+
+bool Log::contains(const LogPosition &pos) const {
+    auto ids = segments();
+    if (std::find(ids.begin(), ids.end(), pos.segment_) == ids.end()) return false;
+    std::error_code fs_err;
+    auto size = std::filesystem::file_size(segment_path(pos.segment_), fs_err);
+    return !fs_err && pos.offset_ >= log_format::HEADER_SIZE && pos.offset_ <= size;
+}
+
+std::error_code Log::replay(const std::function<void(const RecordView &, const LogPosition &)> &visit,
+                            std::optional<LogPosition> from) {
+    const auto ids = segments();
+    auto start = replay_start(ids, from);
+    if (!start.has_value()) return start.error();
+
+    for (size_t i = start->first; i < ids.size(); ++i) {
+        const uint64_t offset = i == start->first ? start->second : log_format::HEADER_SIZE;
+        if (auto err = replay_segment(ids, i, offset, visit); err) return err;
+    }
+    return {};
+}
+
+std::error_code Log::replay_segment(const std::vector<uint64_t> &ids, size_t index, uint64_t offset,
+                                    const std::function<void(const RecordView &, const LogPosition &)> &visit) {
+    FileMapping map;
+    if (auto err = map_segment(ids[index], map); err) return err;
+
+    const auto data = map.data();
+    size_t next = offset;
+    while (true) {
+        const size_t start = next;
+        auto result = zero_hole(EntryCodec::decode_view(data, next), start, data.size());
+        if (!result.has_value()) {
+            if (index + 1 == ids.size() && is_torn_tail(result.error())) {
+                // Windows cannot truncate a mapped file
+                if (auto err = platform_unmap(map); err) return err;
+                return cut_torn_tail(ids[index], start);
+            }
+            return result.error();
+        }
+
+        const LogPosition at{ ids[index], start };
+        if (auto *ent = std::get_if<EntryView>(&result.value())) visit(*ent, at);
+        else if (auto *batch = std::get_if<BatchView>(&result.value())) visit(*batch, at);
+        else break;
+    }
+    return {};
+}
+
+/**
+ * @brief Reduces the put or tombstone record @p ent, which starts at @p at,
+ *        to a @ref KeyRecord.
+ * @param fn Called with it.
+ */
+template <typename F>
+static void for_each_key(const EntryView &ent, const LogPosition &at, F &&fn) {
+    if (ent.deleted_) return fn(KeyRecord{ ent.key_, true, {} });
+    const auto key_end = static_cast<uint32_t>(EntryCodec::HEADER_SIZE + ent.key_.size());
+    fn(KeyRecord{ ent.key_, ent.deleted_, { at, static_cast<uint32_t>(key_end + ent.val_.size()), key_end,
+                                            static_cast<uint32_t>(ent.val_.size()) } });
+}
+
+/**
+ * @brief Reduces the batch record @p batch, which starts at @p at, to a
+ *        @ref KeyRecord per operation.
+ * @param fn Called with each of them in order.
+ */
+template <typename F>
+static void for_each_key(const BatchView &batch, const LogPosition &at, F &&fn) {
+    const std::byte *base = batch.body_.data() - EntryCodec::HEADER_SIZE;
+    const auto size = static_cast<uint32_t>(EntryCodec::HEADER_SIZE + batch.body_.size());
+    batch.for_each([&](const EntryView &op) {
+        if (op.deleted_) return fn(KeyRecord{ op.key_, true, {} });
+        fn(KeyRecord{ op.key_, false, { at, size, static_cast<uint32_t>(op.val_.data() - base),
+                                        static_cast<uint32_t>(op.val_.size()) } });
+    });
+}
+
+std::error_code Log::replay_keys(const std::function<void(const KeyRecord &)> &visit) {
+    const auto ids = segments();
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (i + 1 < ids.size()) {
+            std::error_code fs_err;
+            const uint64_t size = std::filesystem::file_size(segment_path(ids[i]), fs_err);
+            if (!fs_err && !HintFile::load(hint_path(ids[i]), ids[i], size, visit)) continue;
+            queue_hint(ids[i]);
+        }
+        auto err = replay_segment(ids, i, log_format::HEADER_SIZE, [&](const RecordView &rec, const LogPosition &at) {
+            std::visit([&](const auto &view) { for_each_key(view, at, visit); }, rec);
+        });
+        if (err) return err;
+    }
+    return {};
+}
+
+std::error_code Log::write_hint(uint64_t id) {
+    auto ids = segments();
+    auto it = std::find(ids.begin(), ids.end(), id);
+    if (it == ids.end()) return db_error::missing_segment;
+    if (it + 1 == ids.end()) return std::make_error_code(std::errc::invalid_argument);
+
+    FileMapping map;
+    if (auto err = map_segment(id, map); err) return err;
+    std::vector<KeyRecord> records;
+    const auto data = map.data();
+    size_t offset = log_format::HEADER_SIZE;
+    while (true) {
+        const size_t start = offset;
+        auto result = EntryCodec::decode_view(data, offset);
+        if (!result.has_value()) return result.error();
+
+        auto keep = [&records](const KeyRecord &key) { records.push_back(key); };
+        if (auto *ent = std::get_if<EntryView>(&result.value())) for_each_key(*ent, { id, start }, keep);
+        else if (auto *batch = std::get_if<BatchView>(&result.value())) for_each_key(*batch, { id, start }, keep);
+        else break;
+    }
+
+    const bytes hint = HintFile::encode(data.size(), records);
+    const std::string tmp = hint_path(id) + ".tmp";
+    FileHandle out;
+    std::error_code fs_err;
+    std::filesystem::remove(tmp, fs_err);   // never append to a stale temporary
+    if (auto err = platform_open_file(tmp, out); err) return err;
+    std::error_code err = platform_write(out, std::span<const std::byte>(hint));
+    if (!err) err = platform_sync(out);
+    if (auto close_err = platform_close(out); close_err && !err) err = close_err;
+    if (!err) err = platform_rename(tmp, hint_path(id));
+    if (err) {
+        std::filesystem::remove(tmp, fs_err);
+        return err;
+    }
+
+    // A compaction may have dropped the segment meanwhile; open would clean up, but do it now
+    ids = segments();
+    if (std::find(ids.begin(), ids.end(), id) == ids.end()) std::filesystem::remove(hint_path(id), fs_err);
+    return {};
+}
+
+void Log::queue_hint(uint64_t id) {
+    if (!hints_) return;
+    {
+        std::lock_guard lock(hint_mu_);
+        hint_queue_.push_back(id);
+    }
+    hint_cv_.notify_one();
+}
+
+void Log::hint_loop(std::stop_token stop) {
+    while (true) {
+        uint64_t id = 0;
+        {
+            std::unique_lock lock(hint_mu_);
+            if (!hint_cv_.wait(lock, stop, [this] { return !hint_queue_.empty(); })) return;
+            id = hint_queue_.front();
+            hint_queue_.pop_front();
+        }
+        // A hint that cannot be written only costs a scan on the next open
+        write_hint(id);
+    }
+}
+
+namespace {
+
+/**
+ * @brief Splits the records of a mapped segment into ranges of about
+ *        @p chunk_size bytes, cut at record boundaries.
+ *
+ * Only the length fields of each header are read; checksums are left to
+ * the workers.  The scan stops at the first header that is zero, exceeds
+ * the limits or overruns the segment, and the last range runs to the end
+ * of the segment, so whatever stopped the scan is found (and reported) by
+ * the worker that decodes that range.
+ *
+ * @param data       The mapped segment, file header included.
+ * @param begin      Offset of the first record to include.
+ * @param chunk_size Target size of a range.
+ * @param out        Receives `(begin, end)` offset pairs.
+ */
+void split_segment(std::span<const std::byte> data, uint64_t begin, uint64_t chunk_size,
+                   std::vector<std::pair<uint64_t, uint64_t>> &out) {
+    begin = std::min<uint64_t>(begin, data.size());
+    uint64_t offset = begin;
+    while (data.size() - offset >= EntryCodec::HEADER_SIZE) {
+        auto header = data.subspan(offset, EntryCodec::HEADER_SIZE);
+        if (std::all_of(header.begin(), header.end(), [](std::byte b) { return b == std::byte{0}; })) break;
+
+        uint32_t klen = unpack_le<uint32_t>(header.subspan<EntryCodec::KLEN_OFFSET, 4>());
+        uint32_t vlen = unpack_le<uint32_t>(header.subspan<EntryCodec::VLEN_OFFSET, 4>());
+        bool deleted = static_cast<uint8_t>(header[EntryCodec::FLAG_OFFSET]) == EntryCodec::FLAG_DELETE;
+        if (klen > EntryCodec::MAX_KEY_SIZE || vlen > EntryCodec::MAX_BATCH_SIZE) break;
+
+        uint64_t next = offset + EntryCodec::HEADER_SIZE + klen + (deleted ? 0 : vlen);
+        if (next > data.size()) break;
+        offset = next;
+        if (offset - begin >= chunk_size) {
+            out.emplace_back(begin, offset);
+            begin = offset;
+        }
+    }
+    out.emplace_back(begin, data.size());
+}
+
+} // namespace
+
+/**
+ * @details
+ * 1. Every segment from @p from on is mapped and split into ranges (see
+ *    @ref split_segment).
+ * 2. `threads` workers claim ranges in log order and decode them with
+ *    @ref EntryCodec::decode_view into an @ref EntryView per record
+ *    (batches flattened; a batch is still all-or-nothing, because its
+ *    checksum was verified as a whole).  The views point into the
+ *    mappings, which stay until the last range is applied.  A worker only
+ *    claims a range within a window of `2 * threads` ranges past the last
+ *    merged one, so at most that many decoded ranges are held in memory.
+ * 3. The caller's thread hands the ranges to @p apply strictly in log
+ *    order.  The first error in log order ends the replay exactly as in
+ *    @ref replay: a torn tail in the last segment is cut off and the
+ *    replay succeeds; anything else is returned.  Ranges after it are
+ *    discarded.
+ */
+std::error_code Log::replay_parallel(unsigned threads, const std::function<void(std::span<const EntryView>)> &apply,
+                                     std::optional<LogPosition> from, uint64_t chunk_size) {
+    struct Range {
+        size_t   seg;       ///< Index into the segment list.
+        uint64_t begin;
+        uint64_t end;
+    };
+    struct Slot {
+        std::vector<EntryView> entries;
+        std::error_code        err;
+        uint64_t               err_at = 0;  ///< Offset of the record that failed.
+        bool                   done   = false;
+    };
+
+    const auto ids = segments();
+    auto start = replay_start(ids, from);
+    if (!start.has_value()) return start.error();
+
+    std::vector<FileMapping> maps(ids.size());
+    std::vector<Range> ranges;
+    std::vector<std::pair<uint64_t, uint64_t>> cuts;
+    for (size_t i = start->first; i < ids.size(); ++i) {
+        if (auto err = map_segment(ids[i], maps[i]); err) return err;
+        cuts.clear();
+        const uint64_t begin = i == start->first ? start->second : log_format::HEADER_SIZE;
+        split_segment(maps[i].data(), begin, std::max<uint64_t>(chunk_size, 1), cuts);
+        for (auto [begin, end] : cuts) ranges.push_back({ i, begin, end });
+    }
+
+    const size_t window = 2 * static_cast<size_t>(std::max(threads, 1u));
+    std::vector<Slot> slots(ranges.size());
+    std::mutex mu;
+    std::condition_variable cv;
+    size_t next = 0, merged = 0;
+    bool stop = false;
+
+    auto decode_range = [&](const Range &range, Slot &slot) {
+        const auto data = maps[range.seg].data().first(range.end);
+        size_t offset = range.begin;
+        while (offset < range.end) {
+            const size_t start = offset;
+            auto result = zero_hole(EntryCodec::decode_view(data, offset), start, maps[range.seg].data().size());
+            if (!result.has_value()) {
+                slot.err = result.error();
+                slot.err_at = start;
+                return;
+            }
+            if (auto *ent = std::get_if<EntryView>(&result.value())) slot.entries.push_back(*ent);
+            else if (auto *batch = std::get_if<BatchView>(&result.value()))
+                batch->for_each([&slot](const EntryView &op) { slot.entries.push_back(op); });
+            else break;
+        }
+    };
+
+    std::vector<std::jthread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            while (true) {
+                size_t i;
+                {
+                    std::unique_lock lock(mu);
+                    cv.wait(lock, [&] { return stop || next == ranges.size() || next < merged + window; });
+                    if (stop || next == ranges.size()) return;
+                    i = next++;
+                }
+                Slot slot;
+                decode_range(ranges[i], slot);
+                slot.done = true;
+                std::lock_guard lock(mu);
+                slots[i] = std::move(slot);
+                cv.notify_all();
+            }
+        });
+    }
+
+    std::error_code result;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        Slot slot;
+        {
+            std::unique_lock lock(mu);
+            cv.wait(lock, [&] { return slots[i].done; });
+            slot = std::move(slots[i]);
+        }
+        apply(slot.entries);
+
+        if (slot.err) {
+            const bool last = ranges[i].seg + 1 == ids.size();
+            if (last && is_torn_tail(slot.err)) {
+                // Windows cannot truncate a mapped file
+                result = platform_unmap(maps[ranges[i].seg]);
+                if (!result) result = cut_torn_tail(ids[ranges[i].seg], slot.err_at);
+            } else {
+                result = slot.err;
+            }
+            break;
+        }
+
+        std::lock_guard lock(mu);
+        merged = i + 1;
+        cv.notify_all();
+    }
+
+    {
+        std::lock_guard lock(mu);
+        stop = true;
+        cv.notify_all();
+    }
+    workers.clear();    // joins before the mappings go away
+    return result;
 }
 
 std::error_code Log::seek_to_first_entry() {
-    return platform_seek(fh_, log_format::HEADER_SIZE, SEEK_SET);
+    replay_ = segments();
+    replay_pos_ = 0;
+    replay_reader_.emplace();
+    return open_replay_segment();
+}
+
+void Log::end_replay() {
+    platform_close(rfh_);
+    replay_reader_.reset();
 }
 
 Log::~Log() {
-    if (fh_.is_open()) platform_close(fh_);
+    close();
 }
@@ -0,0 +1,49 @@
+// src/kv/manifest.cpp
+
+/**
+ * @file manifest.cpp
+ * @brief Implementation of @ref Manifest encoding and decoding.
+ */
+
+#include "kv/manifest.h"
+#include "core/bit_utils.h"
+#include "core/db_error.h"
+
+bytes Manifest::encode() const {
+    bytes out;
+    out.reserve(4 + 2 + 8 + 4 + 8 * segments_.size() + 4);
+
+    auto append = [&out](const auto &arr) { out.insert(out.end(), arr.begin(), arr.end()); };
+    push_u32(out, MAGIC);
+    append(pack_le<uint16_t>(VERSION));
+    append(pack_le<uint64_t>(next_id_));
+    push_u32(out, static_cast<uint32_t>(segments_.size()));
+    for (uint64_t id : segments_) append(pack_le<uint64_t>(id));
+    push_u32(out, crc32_ieee(out));
+    return out;
+}
+
+std::expected<Manifest, std::error_code> Manifest::decode(std::span<const std::byte> data) {
+    constexpr size_t FIXED_SIZE = 4 + 2 + 8 + 4;
+    if (data.size() < FIXED_SIZE + 4) return std::unexpected(db_error::bad_manifest);
+
+    auto body = data.first(data.size() - 4);
+    auto stored = unpack_le<uint32_t>(data.last<4>());
+    if (crc32_ieee(body) != stored) return std::unexpected(db_error::bad_manifest);
+
+    if (unpack_le<uint32_t>(body.subspan<0, 4>()) != MAGIC)
+        return std::unexpected(db_error::bad_magic);
+    if (unpack_le<uint16_t>(body.subspan<4, 2>()) > VERSION)
+        return std::unexpected(db_error::unsupported_version);
+
+    Manifest m;
+    m.next_id_ = unpack_le<uint64_t>(body.subspan<6, 8>());
+    uint32_t count = unpack_le<uint32_t>(body.subspan<14, 4>());
+    if (count == 0 || body.size() != FIXED_SIZE + 8 * static_cast<size_t>(count))
+        return std::unexpected(db_error::bad_manifest);
+
+    m.segments_.clear();
+    for (size_t i = 0; i < count; ++i)
+        m.segments_.push_back(unpack_le<uint64_t>(body.subspan(FIXED_SIZE + 8 * i).first<8>()));
+    return m;
+}
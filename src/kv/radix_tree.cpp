@@ -0,0 +1,608 @@
+// src/kv/radix_tree.cpp
+
+/**
+ * @file radix_tree.cpp
+ * @brief Implementation of @ref RadixTree insertion, removal and ordered walks.
+ */
+
+#include "kv/radix_tree.h"
+#include "core/small_key.h"
+#include "core/types.h"
+#include <algorithm>    // std::lexicographical_compare_three_way, std::fill_n
+#include <compare>      // std::strong_ordering
+#include <cstdint>      // uint8_t, uint16_t
+#include <cstring>      // std::memmove, std::memset
+#include <utility>      // std::exchange
+
+namespace {
+enum class NodeType : uint8_t { Leaf, N4, N16, N48, N256 };
+} // namespace
+
+/// Common header: the type says which of the structs below a node is.
+struct RadixTree::Node {
+    NodeType type_;
+};
+
+namespace {
+
+using Node = RadixTree::Node;
+using Key  = std::span<const std::byte>;
+using Visit = std::function<bool(Key)>;
+
+struct Leaf : Node {
+    SmallKey key_;      ///< The complete key.
+
+    explicit Leaf(Key key) : Node{NodeType::Leaf}, key_(key) {}
+};
+
+struct Inner : Node {
+    uint16_t count_ = 0;        ///< Number of children.
+    SmallKey prefix_;           ///< Key bytes shared by everything below, before the branch byte.
+    Leaf    *leaf_  = nullptr;  ///< The key that ends right after @ref prefix_, if any.
+
+    explicit Inner(NodeType type) : Node{type} {}
+};
+
+/// Up to 4 children, kept sorted by byte.
+struct Node4 : Inner {
+    uint8_t keys_[4];
+    Node   *children_[4];
+
+    Node4() : Inner(NodeType::N4) {}
+};
+
+/// Up to 16 children, kept sorted by byte.
+struct Node16 : Inner {
+    uint8_t keys_[16];
+    Node   *children_[16];
+
+    Node16() : Inner(NodeType::N16) {}
+};
+
+/// Up to 48 children, found through a 256-entry byte index.
+struct Node48 : Inner {
+    uint8_t index_[256];        ///< Slot of each byte's child plus one; `0` for none.
+    Node   *children_[48];
+
+    Node48() : Inner(NodeType::N48) {
+        std::memset(index_, 0, sizeof(index_));
+        std::fill_n(children_, 48, nullptr);
+    }
+};
+
+/// One child pointer per byte.
+struct Node256 : Inner {
+    Node *children_[256];
+
+    Node256() : Inner(NodeType::N256) { std::fill_n(children_, 256, nullptr); }
+};
+
+bool is_leaf(const Node *n) noexcept { return n->type_ == NodeType::Leaf; }
+Leaf *as_leaf(Node *n) noexcept { return static_cast<Leaf *>(n); }
+const Leaf *as_leaf(const Node *n) noexcept { return static_cast<const Leaf *>(n); }
+Inner *as_inner(Node *n) noexcept { return static_cast<Inner *>(n); }
+const Inner *as_inner(const Node *n) noexcept { return static_cast<const Inner *>(n); }
+
+std::strong_ordering compare(Key a, Key b) noexcept {
+    return std::lexicographical_compare_three_way(a.begin(), a.end(), b.begin(), b.end());
+}
+
+/// Frees @p n alone, not its children.
+void free_node(Node *n) noexcept {
+    switch (n->type_) {
+        case NodeType::Leaf: delete as_leaf(n); break;
+        case NodeType::N4:   delete static_cast<Node4 *>(n); break;
+        case NodeType::N16:  delete static_cast<Node16 *>(n); break;
+        case NodeType::N48:  delete static_cast<Node48 *>(n); break;
+        case NodeType::N256: delete static_cast<Node256 *>(n); break;
+    }
+}
+
+/**
+ * @brief Calls @p fn with each child of @p n in ascending byte order
+ *        (descending if @p reverse), until it returns `false`.
+ * @return `false` if @p fn stopped the iteration.
+ */
+template <typename F> bool for_each_child(const Inner *n, bool reverse, F &&fn) {
+    auto sorted = [&](const uint8_t *keys, Node *const *children) {
+        for (size_t i = 0; i < n->count_; ++i) {
+            const size_t at = reverse ? n->count_ - 1 - i : i;
+            if (!fn(keys[at], children[at])) return false;
+        }
+        return true;
+    };
+    auto indexed = [&](auto &&child_of) {
+        for (int i = 0; i < 256; ++i) {
+            const auto b = static_cast<uint8_t>(reverse ? 255 - i : i);
+            if (const Node *c = child_of(b); c && !fn(b, c)) return false;
+        }
+        return true;
+    };
+    switch (n->type_) {
+        case NodeType::N4: {
+            auto *n4 = static_cast<const Node4 *>(n);
+            return sorted(n4->keys_, n4->children_);
+        }
+        case NodeType::N16: {
+            auto *n16 = static_cast<const Node16 *>(n);
+            return sorted(n16->keys_, n16->children_);
+        }
+        case NodeType::N48: {
+            auto *n48 = static_cast<const Node48 *>(n);
+            return indexed([n48](uint8_t b) -> const Node * {
+                return n48->index_[b] ? n48->children_[n48->index_[b] - 1] : nullptr;
+            });
+        }
+        case NodeType::N256: {
+            auto *n256 = static_cast<const Node256 *>(n);
+            return indexed([n256](uint8_t b) -> const Node * { return n256->children_[b]; });
+        }
+        case NodeType::Leaf: break;
+    }
+    return true;
+}
+
+/// Frees @p n and everything below it.
+void destroy(Node *n) noexcept {
+    if (!n) return;
+    if (!is_leaf(n)) {
+        Inner *in = as_inner(n);
+        destroy(in->leaf_);
+        for_each_child(in, false, [](uint8_t, const Node *c) {
+            destroy(const_cast<Node *>(c));
+            return true;
+        });
+    }
+    free_node(n);
+}
+
+/** @return The slot holding the child of @p n for byte @p b, or `nullptr`. */
+Node **find_child(Inner *n, uint8_t b) noexcept {
+    switch (n->type_) {
+        case NodeType::N4: {
+            auto *n4 = static_cast<Node4 *>(n);
+            for (size_t i = 0; i < n4->count_; ++i)
+                if (n4->keys_[i] == b) return &n4->children_[i];
+            return nullptr;
+        }
+        case NodeType::N16: {
+            auto *n16 = static_cast<Node16 *>(n);
+            for (size_t i = 0; i < n16->count_; ++i)
+                if (n16->keys_[i] == b) return &n16->children_[i];
+            return nullptr;
+        }
+        case NodeType::N48: {
+            auto *n48 = static_cast<Node48 *>(n);
+            return n48->index_[b] ? &n48->children_[n48->index_[b] - 1] : nullptr;
+        }
+        case NodeType::N256: {
+            auto *n256 = static_cast<Node256 *>(n);
+            return n256->children_[b] ? &n256->children_[b] : nullptr;
+        }
+        case NodeType::Leaf: break;
+    }
+    return nullptr;
+}
+
+/// Moves the shared fields of @p from into @p to.
+void move_header(Inner *to, Inner *from) {
+    to->count_  = from->count_;
+    to->prefix_ = std::move(from->prefix_);
+    to->leaf_   = from->leaf_;
+}
+
+/// Inserts @p child at byte @p b into a sorted array node of @p count children.
+void insert_sorted(uint8_t *keys, Node **children, size_t count, uint8_t b, Node *child) {
+    size_t at = 0;
+    while (at < count && keys[at] < b) ++at;
+    std::memmove(keys + at + 1, keys + at, count - at);
+    std::memmove(children + at + 1, children + at, (count - at) * sizeof(Node *));
+    keys[at]     = b;
+    children[at] = child;
+}
+
+/// Removes the child at byte @p b from a sorted array node of @p count children.
+void erase_sorted(uint8_t *keys, Node **children, size_t count, uint8_t b) {
+    size_t at = 0;
+    while (keys[at] != b) ++at;
+    std::memmove(keys + at, keys + at + 1, count - at - 1);
+    std::memmove(children + at, children + at + 1, (count - at - 1) * sizeof(Node *));
+}
+
+/**
+ * @brief Adds @p child under byte @p b to the inner node in @p ref, first
+ *        replacing the node with the next larger type if it is full.
+ */
+void add_child(Node *&ref, uint8_t b, Node *child) {
+    Inner *n = as_inner(ref);
+    switch (n->type_) {
+        case NodeType::N4: {
+            auto *n4 = static_cast<Node4 *>(n);
+            if (n4->count_ < 4) {
+                insert_sorted(n4->keys_, n4->children_, n4->count_++, b, child);
+                return;
+            }
+            auto *grown = new Node16;
+            move_header(grown, n4);
+            std::memcpy(grown->keys_, n4->keys_, 4);
+            std::memcpy(grown->children_, n4->children_, 4 * sizeof(Node *));
+            ref = grown;
+            delete n4;
+            break;
+        }
+        case NodeType::N16: {
+            auto *n16 = static_cast<Node16 *>(n);
+            if (n16->count_ < 16) {
+                insert_sorted(n16->keys_, n16->children_, n16->count_++, b, child);
+                return;
+            }
+            auto *grown = new Node48;
+            move_header(grown, n16);
+            for (uint8_t i = 0; i < 16; ++i) {
+                grown->index_[n16->keys_[i]] = static_cast<uint8_t>(i + 1);
+                grown->children_[i] = n16->children_[i];
+            }
+            ref = grown;
+            delete n16;
+            break;
+        }
+        case NodeType::N48: {
+            auto *n48 = static_cast<Node48 *>(n);
+            if (n48->count_ < 48) {
+                uint8_t slot = 0;
+                while (n48->children_[slot]) ++slot;
+                n48->children_[slot] = child;
+                n48->index_[b] = static_cast<uint8_t>(slot + 1);
+                ++n48->count_;
+                return;
+            }
+            auto *grown = new Node256;
+            move_header(grown, n48);
+            for (int i = 0; i < 256; ++i)
+                if (n48->index_[i]) grown->children_[i] = n48->children_[n48->index_[i] - 1];
+            ref = grown;
+            delete n48;
+            break;
+        }
+        case NodeType::N256: {
+            auto *n256 = static_cast<Node256 *>(n);
+            n256->children_[b] = child;
+            ++n256->count_;
+            return;
+        }
+        case NodeType::Leaf: return;
+    }
+    add_child(ref, b, child);
+}
+
+/**
+ * @brief Removes the child under byte @p b from the inner node in @p ref,
+ *        then replaces the node with the next smaller type once it is
+ *        sparse enough (with some slack, so a node on the boundary does not
+ *        flip back and forth).
+ */
+void remove_child(Node *&ref, uint8_t b) {
+    Inner *n = as_inner(ref);
+    switch (n->type_) {
+        case NodeType::N4: {
+            auto *n4 = static_cast<Node4 *>(n);
+            erase_sorted(n4->keys_, n4->children_, n4->count_--, b);
+            return;
+        }
+        case NodeType::N16: {
+            auto *n16 = static_cast<Node16 *>(n);
+            erase_sorted(n16->keys_, n16->children_, n16->count_--, b);
+            if (n16->count_ > 3) return;
+            auto *shrunk = new Node4;
+            move_header(shrunk, n16);
+            std::memcpy(shrunk->keys_, n16->keys_, n16->count_);
+            std::memcpy(shrunk->children_, n16->children_, n16->count_ * sizeof(Node *));
+            ref = shrunk;
+            delete n16;
+            return;
+        }
+        case NodeType::N48: {
+            auto *n48 = static_cast<Node48 *>(n);
+            n48->children_[n48->index_[b] - 1] = nullptr;
+            n48->index_[b] = 0;
+            if (--n48->count_ > 12) return;
+            auto *shrunk = new Node16;
+            move_header(shrunk, n48);
+            uint8_t at = 0;
+            for (int i = 0; i < 256; ++i) {
+                if (!n48->index_[i]) continue;
+                shrunk->keys_[at]     = static_cast<uint8_t>(i);
+                shrunk->children_[at] = n48->children_[n48->index_[i] - 1];
+                ++at;
+            }
+            ref = shrunk;
+            delete n48;
+            return;
+        }
+        case NodeType::N256: {
+            auto *n256 = static_cast<Node256 *>(n);
+            n256->children_[b] = nullptr;
+            if (--n256->count_ > 40) return;
+            auto *shrunk = new Node48;
+            move_header(shrunk, n256);
+            uint8_t slot = 0;
+            for (int i = 0; i < 256; ++i) {
+                if (!n256->children_[i]) continue;
+                shrunk->index_[i] = static_cast<uint8_t>(slot + 1);
+                shrunk->children_[slot++] = n256->children_[i];
+            }
+            ref = shrunk;
+            delete n256;
+            return;
+        }
+        case NodeType::Leaf: return;
+    }
+}
+
+/**
+ * @brief Restores the invariant that an inner node holds at least two keys
+ *        (children plus its own leaf) after one was removed from @p ref:
+ *        a node left with only a leaf becomes that leaf, and a node left
+ *        with one child is merged into it.
+ */
+void collapse(Node *&ref) {
+    Inner *n = as_inner(ref);
+    if (n->count_ == 0) {
+        ref = n->leaf_;
+        free_node(n);
+        return;
+    }
+    if (n->count_ != 1 || n->leaf_) return;
+
+    uint8_t b = 0;
+    Node *child = nullptr;
+    for_each_child(n, false, [&](uint8_t cb, const Node *c) {
+        b = cb;
+        child = const_cast<Node *>(c);
+        return false;
+    });
+    if (!is_leaf(child)) {
+        // The child's keys now skip this node, so its prefix absorbs ours and the branch byte
+        Inner *in = as_inner(child);
+        bytes prefix(n->prefix_.view().begin(), n->prefix_.view().end());
+        prefix.push_back(std::byte{b});
+        prefix.insert(prefix.end(), in->prefix_.view().begin(), in->prefix_.view().end());
+        in->prefix_ = SmallKey(prefix);
+    }
+    ref = child;
+    free_node(n);
+}
+
+/**
+ * @brief Puts @p leaf into the inner node in @p ref, whose prefix ends at
+ *        @p depth of @p key: as the node's own leaf if @p key ends there,
+ *        as a child otherwise.
+ */
+void attach(Node *&ref, Key key, size_t depth, Leaf *leaf) {
+    if (key.size() == depth) as_inner(ref)->leaf_ = leaf;
+    else add_child(ref, static_cast<uint8_t>(key[depth]), leaf);
+}
+
+/** @return How many leading bytes of @p prefix match @p key from @p depth on. */
+size_t match_prefix(Key prefix, Key key, size_t depth) noexcept {
+    size_t m = 0;
+    while (m < prefix.size() && depth + m < key.size() && prefix[m] == key[depth + m]) ++m;
+    return m;
+}
+
+bool erase_at(Node *&ref, Key key, size_t depth) {
+    Node *n = ref;
+    if (!n) return false;
+    if (is_leaf(n)) {
+        if (compare(as_leaf(n)->key_.view(), key) != 0) return false;
+        free_node(n);
+        ref = nullptr;
+        return true;
+    }
+
+    Inner *in = as_inner(n);
+    const Key prefix = in->prefix_.view();
+    if (match_prefix(prefix, key, depth) < prefix.size()) return false;
+    depth += prefix.size();
+    if (depth == key.size()) {
+        if (!in->leaf_) return false;
+        free_node(std::exchange(in->leaf_, nullptr));
+        collapse(ref);
+        return true;
+    }
+
+    const auto b = static_cast<uint8_t>(key[depth]);
+    Node **child = find_child(in, b);
+    if (!child || !erase_at(*child, key, depth + 1)) return false;
+    if (!*child) {
+        remove_child(ref, b);
+        collapse(ref);
+    }
+    return true;
+}
+
+/// Visits every key below @p n in order.
+bool walk_all(const Node *n, bool reverse, const Visit &visit) {
+    if (is_leaf(n)) return visit(as_leaf(n)->key_.view());
+    const Inner *in = as_inner(n);
+    // A key ending at this node sorts before everything below it
+    if (!reverse && in->leaf_ && !visit(in->leaf_->key_.view())) return false;
+    if (!for_each_child(in, reverse, [&](uint8_t, const Node *c) { return walk_all(c, reverse, visit); }))
+        return false;
+    if (reverse && in->leaf_) return visit(in->leaf_->key_.view());
+    return true;
+}
+
+/// Visits the keys below @p n that are `>= from` (`> from`) in ascending order.
+bool walk_from(const Node *n, Key from, size_t depth, bool inclusive, const Visit &visit) {
+    if (is_leaf(n)) {
+        const auto cmp = compare(as_leaf(n)->key_.view(), from);
+        return (cmp > 0 || (cmp == 0 && inclusive)) ? visit(as_leaf(n)->key_.view()) : true;
+    }
+
+    const Inner *in = as_inner(n);
+    const Key prefix = in->prefix_.view();
+    if (const size_t m = match_prefix(prefix, from, depth); m < prefix.size()) {
+        // The subtree lies entirely on one side of `from`
+        if (depth + m == from.size() || prefix[m] > from[depth + m]) return walk_all(n, false, visit);
+        return true;
+    }
+    depth += prefix.size();
+    if (depth == from.size()) {
+        if (in->leaf_ && inclusive && !visit(in->leaf_->key_.view())) return false;
+        return for_each_child(in, false, [&](uint8_t, const Node *c) { return walk_all(c, false, visit); });
+    }
+
+    // Our own leaf is a proper prefix of `from`, so it sorts before it
+    const auto b = static_cast<uint8_t>(from[depth]);
+    return for_each_child(in, false, [&](uint8_t cb, const Node *c) {
+        if (cb < b) return true;
+        if (cb == b) return walk_from(c, from, depth + 1, inclusive, visit);
+        return walk_all(c, false, visit);
+    });
+}
+
+/// Visits the keys below @p n that are `<= to` (`< to`) in descending order.
+bool walk_to(const Node *n, Key to, size_t depth, bool inclusive, const Visit &visit) {
+    if (is_leaf(n)) {
+        const auto cmp = compare(as_leaf(n)->key_.view(), to);
+        return (cmp < 0 || (cmp == 0 && inclusive)) ? visit(as_leaf(n)->key_.view()) : true;
+    }
+
+    const Inner *in = as_inner(n);
+    const Key prefix = in->prefix_.view();
+    if (const size_t m = match_prefix(prefix, to, depth); m < prefix.size()) {
+        if (depth + m == to.size() || prefix[m] > to[depth + m]) return true;
+        return walk_all(n, true, visit);
+    }
+    depth += prefix.size();
+    if (depth == to.size()) {
+        // Everything below is longer than `to`, so greater
+        return (in->leaf_ && inclusive) ? visit(in->leaf_->key_.view()) : true;
+    }
+
+    const auto b = static_cast<uint8_t>(to[depth]);
+    if (!for_each_child(in, true, [&](uint8_t cb, const Node *c) {
+            if (cb > b) return true;
+            if (cb == b) return walk_to(c, to, depth + 1, inclusive, visit);
+            return walk_all(c, true, visit);
+        }))
+        return false;
+    return in->leaf_ ? visit(in->leaf_->key_.view()) : true;
+}
+
+} // namespace
+
+RadixTree::RadixTree(RadixTree &&other) noexcept
+    : root_(std::exchange(other.root_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+RadixTree &RadixTree::operator=(RadixTree &&other) noexcept {
+    if (this != &other) {
+        clear();
+        root_ = std::exchange(other.root_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+RadixTree::~RadixTree() { clear(); }
+
+void RadixTree::clear() noexcept {
+    destroy(root_);
+    root_ = nullptr;
+    size_ = 0;
+}
+
+bool RadixTree::insert(Key key) {
+    Node **ref = &root_;
+    size_t depth = 0;
+    while (true) {
+        Node *n = *ref;
+        if (!n) {
+            *ref = new Leaf(key);
+            ++size_;
+            return true;
+        }
+
+        if (is_leaf(n)) {
+            Leaf *leaf = as_leaf(n);
+            const Key other = leaf->key_.view();
+            if (compare(other, key) == 0) return false;
+            // Split the leaf: a new node holding the bytes both keys share
+            const size_t shared = depth + match_prefix(other.subspan(depth), key, depth);
+            auto *inner = new Node4;
+            inner->prefix_ = SmallKey(key.subspan(depth, shared - depth));
+            Node *split = inner;
+            attach(split, other, shared, leaf);
+            attach(split, key, shared, new Leaf(key));
+            *ref = split;
+            ++size_;
+            return true;
+        }
+
+        Inner *in = as_inner(n);
+        const Key prefix = in->prefix_.view();
+        const size_t m = match_prefix(prefix, key, depth);
+        if (m < prefix.size()) {
+            // Split the prefix: a new parent takes the matching part
+            auto *parent = new Node4;
+            parent->prefix_ = SmallKey(prefix.first(m));
+            const auto b = static_cast<uint8_t>(prefix[m]);
+            in->prefix_ = SmallKey(prefix.subspan(m + 1));
+            Node *split = parent;
+            add_child(split, b, in);
+            attach(split, key, depth + m, new Leaf(key));
+            *ref = split;
+            ++size_;
+            return true;
+        }
+
+        depth += prefix.size();
+        if (depth == key.size()) {
+            if (in->leaf_) return false;
+            in->leaf_ = new Leaf(key);
+            ++size_;
+            return true;
+        }
+        const auto b = static_cast<uint8_t>(key[depth]);
+        Node **child = find_child(in, b);
+        if (!child) {
+            add_child(*ref, b, new Leaf(key));
+            ++size_;
+            return true;
+        }
+        ref = child;
+        ++depth;
+    }
+}
+
+bool RadixTree::erase(Key key) {
+    if (!erase_at(root_, key, 0)) return false;
+    --size_;
+    return true;
+}
+
+bool RadixTree::contains(Key key) const noexcept {
+    const Node *n = root_;
+    size_t depth = 0;
+    while (n) {
+        if (is_leaf(n)) return compare(as_leaf(n)->key_.view(), key) == 0;
+        auto *in = const_cast<Inner *>(as_inner(n));
+        const Key prefix = in->prefix_.view();
+        if (match_prefix(prefix, key, depth) < prefix.size()) return false;
+        depth += prefix.size();
+        if (depth == key.size()) return in->leaf_ != nullptr;
+        Node **child = find_child(in, static_cast<uint8_t>(key[depth]));
+        if (!child) return false;
+        n = *child;
+        ++depth;
+    }
+    return false;
+}
+
+void RadixTree::walk(std::optional<Key> from, bool inclusive, bool reverse, const Visit &visit) const {
+    if (!root_) return;
+    if (!from.has_value()) walk_all(root_, reverse, visit);
+    else if (reverse) walk_to(root_, *from, 0, inclusive, visit);
+    else walk_from(root_, *from, 0, inclusive, visit);
+}
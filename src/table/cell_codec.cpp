@@ -2,13 +2,15 @@
 
 /**
  * @file cell_codec.cpp
- * @brief Implementation of @ref CellCodec encode, decode, and type-tag reader.
+ * @brief Implementation of @ref CellCodec encode, decode, key encode/decode,
+ *        and type-tag reader.
  */
 
 #include "core/types.h"         // bytes
-#include "core/bit_utils.h"     // pack_le, unpack_le
+#include "core/bit_utils.h"     // pack_le, unpack_le, pack_be, unpack_be
 #include "core/db_error.h"      // db_error
 #include "table/cell_codec.h"
+#include <algorithm>            // std::find
 #include <cstddef>              // std::byte
 #include <utility>              // std::unreachable
 #include <optional>             // std::optional
@@ -19,6 +21,20 @@
 template<class... Ts> struct overloads : Ts... { using Ts::operator()...; };
 /** @endcond */
 
+namespace {
+
+/// Byte that starts an escape or the terminator in key-encoded strings.
+constexpr std::byte KEY_ESCAPE     = std::byte{0x00};
+/// Follows @ref KEY_ESCAPE for a `00` data byte.
+constexpr std::byte KEY_ESCAPED_00 = std::byte{0xFF};
+/// Follows @ref KEY_ESCAPE at the end of the string.
+constexpr std::byte KEY_TERMINATOR = std::byte{0x01};
+
+/// Flipping the sign bit maps `INT64_MIN..INT64_MAX` onto `0..UINT64_MAX` in order.
+constexpr uint64_t SIGN_BIT = uint64_t{1} << 63;
+
+} // namespace
+
 std::error_code CellCodec::encode(const Cell &c, Cell::Type expected, bytes &out) {
     return std::visit(overloads{
         [&](std::monostate) -> std::error_code {
@@ -86,6 +102,74 @@ std::expected<Cell, std::error_code> CellCodec::decode(std::span<const std::byte
     }
 }
 
+std::error_code CellCodec::encode_key(const Cell &c, Cell::Type expected, bytes &out) {
+    return std::visit(overloads{
+        [&](std::monostate) -> std::error_code {
+            if (expected != Cell::Type::no_type) return db_error::type_mismatch;
+            out.push_back(null_byte);
+            return {};
+        },
+        [&](Cell::I64Type val) -> std::error_code {
+            if (expected != Cell::Type::i64) return db_error::type_mismatch;
+            auto val_bytes = pack_be<uint64_t>(static_cast<uint64_t>(val) ^ SIGN_BIT);
+            out.insert(out.end(), val_bytes.begin(), val_bytes.end());
+            return {};
+        },
+        [&](const Cell::StrType &val) -> std::error_code {
+            if (expected != Cell::Type::str) return db_error::type_mismatch;
+            for (auto it = val.begin(); it != val.end();) {
+                auto zero = std::find(it, val.end(), KEY_ESCAPE);
+                out.insert(out.end(), it, zero);
+                if (zero == val.end()) break;
+                out.push_back(KEY_ESCAPE);
+                out.push_back(KEY_ESCAPED_00);
+                it = zero + 1;
+            }
+            out.push_back(KEY_ESCAPE);
+            out.push_back(KEY_TERMINATOR);
+            return {};
+        },
+        [&](auto &&unexpected_type) -> std::error_code {
+            static_assert(sizeof(unexpected_type) == 0, "Non-exhaustive visitor. Handle the new Cell type.");
+            return db_error::unsupported_type;
+        }
+    }, c.value());
+}
+
+std::expected<Cell, std::error_code> CellCodec::decode_key(std::span<const std::byte> &buf, Cell::Type t) {
+    switch (t) {
+        case Cell::Type::no_type:
+            return decode(buf, t);
+        case Cell::Type::i64: {
+            if (buf.size() < sizeof(uint64_t)) {
+                return std::unexpected(db_error::expect_more_data);
+            }
+            auto val = unpack_be<uint64_t>(buf.first<sizeof(uint64_t)>()) ^ SIGN_BIT;
+            buf = buf.subspan<sizeof(uint64_t)>();
+            return Cell::make_i64(static_cast<Cell::I64Type>(val));
+        }
+        case Cell::Type::str: {
+            bytes data;
+            for (;;) {
+                auto zero = std::find(buf.begin(), buf.end(), KEY_ESCAPE);
+                if (zero == buf.end() || zero + 1 == buf.end()) {
+                    return std::unexpected(db_error::expect_more_data);
+                }
+                data.insert(data.end(), buf.begin(), zero);
+                const std::byte marker = zero[1];
+                buf = buf.subspan(static_cast<size_t>(zero - buf.begin()) + 2);
+                if (marker == KEY_TERMINATOR) break;
+                if (marker != KEY_ESCAPED_00) {
+                    return std::unexpected(std::make_error_code(std::errc::illegal_byte_sequence));
+                }
+                data.push_back(KEY_ESCAPE);
+            }
+            return Cell::make_str(std::move(data));
+        }
+        default: std::unreachable();
+    }
+}
+
 std::optional<Cell::Type> CellCodec::read_cell_type(std::span<const std::byte> &buf) {
     if (buf.empty()) return std::nullopt;
     auto t = static_cast<uint8_t>(buf[0]);
@@ -7,6 +7,7 @@
 
 #include "core/db_error.h"      // db_error
 #include "table/row_codec.h"
+#include <algorithm>            // std::equal
 #include <utility>              // std::move
 
 bytes RowCodec::key_prefix(const Schema &schema) {
@@ -23,14 +24,99 @@ std::expected<bytes, std::error_code> RowCodec::encode_key(const Schema &schema,
 
     auto key = key_prefix(schema);
 
+    const auto encode = schema.key_format_ == KeyFormat::ordered ? &CellCodec::encode_key : &CellCodec::encode;
     for (auto idx : schema.pkey_) {
-        if (auto err = CellCodec::encode(row[idx], schema.cols_[idx].type_, key); err) {
+        if (auto err = encode(row[idx], schema.cols_[idx].type_, key); err) {
             return std::unexpected(err);
         }
     }
     return key;
 }
 
+std::expected<bytes, std::error_code> RowCodec::encode_key_prefix(const Schema &schema,
+                                                                 std::span<const Cell> cells) {
+    if (cells.size() > schema.pkey_.size())
+        return std::unexpected(db_error::inconsistent_length);
+
+    auto key = key_prefix(schema);
+
+    const auto encode = schema.key_format_ == KeyFormat::ordered ? &CellCodec::encode_key : &CellCodec::encode;
+    for (size_t i = 0; i < cells.size(); ++i) {
+        if (auto err = encode(cells[i], schema.cols_[schema.pkey_[i]].type_, key); err) {
+            return std::unexpected(err);
+        }
+    }
+    return key;
+}
+
+/// First bytes of every entry of secondary index @p index: `[ schema_id(4 LE) | INDEX_TAG + index ]`.
+static bytes index_prefix(const Schema &schema, size_t index) {
+    auto prefix = RowCodec::key_prefix(schema);
+    prefix.back() = static_cast<std::byte>(RowCodec::INDEX_TAG + index);
+    return prefix;
+}
+
+std::expected<bytes, std::error_code> RowCodec::encode_index_key(const Schema &schema, size_t index, const Row &row) {
+    if (schema.cols_.size() != row.size())
+        return std::unexpected(db_error::inconsistent_length);
+
+    auto key = index_prefix(schema, index);
+
+    for (auto idx : schema.indexes_[index].cols_) {
+        if (auto err = CellCodec::encode_key(row[idx], schema.cols_[idx].type_, key); err) {
+            return std::unexpected(err);
+        }
+    }
+    for (auto idx : schema.pkey_) {
+        if (auto err = CellCodec::encode_key(row[idx], schema.cols_[idx].type_, key); err) {
+            return std::unexpected(err);
+        }
+    }
+    return key;
+}
+
+std::expected<bytes, std::error_code> RowCodec::encode_index_prefix(const Schema &schema, size_t index,
+                                                                   std::span<const Cell> values) {
+    const auto &cols = schema.indexes_[index].cols_;
+    if (values.size() > cols.size())
+        return std::unexpected(db_error::inconsistent_length);
+
+    auto key = index_prefix(schema, index);
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (auto err = CellCodec::encode_key(values[i], schema.cols_[cols[i]].type_, key); err) {
+            return std::unexpected(err);
+        }
+    }
+    return key;
+}
+
+std::error_code RowCodec::decode_index_key(const Schema &schema, size_t index, Row &row,
+                                           std::span<const std::byte> key) {
+    if (schema.cols_.size() != row.size())
+        return db_error::inconsistent_length;
+
+    const auto prefix = index_prefix(schema, index);
+    if (key.size() < prefix.size()) return db_error::expect_more_data;
+    if (!std::equal(prefix.begin(), prefix.end(), key.begin())) return db_error::bad_key;
+    key = key.subspan(prefix.size());
+
+    auto decode = [&](size_t idx) -> std::error_code {
+        auto res = CellCodec::decode_key(key, schema.cols_[idx].type_);
+        if (!res.has_value()) return res.error();
+        row[idx] = std::move(res.value());
+        return {};
+    };
+    for (auto idx : schema.indexes_[index].cols_) {
+        if (auto err = decode(idx); err) return err;
+    }
+    for (auto idx : schema.pkey_) {
+        if (auto err = decode(idx); err) return err;
+    }
+
+    return (!key.empty()) ? db_error::trailing_garbage : std::error_code{};
+}
+
 std::expected<bytes, std::error_code> RowCodec::encode_val(const Schema &schema, const Row &row) {
     if (schema.cols_.size() != row.size())
         return std::unexpected(db_error::inconsistent_length);
@@ -62,8 +148,9 @@ std::error_code RowCodec::decode_key(const Schema &schema, Row &row, std::span<c
         return db_error::bad_key;
     key = key.subspan<1>();
 
+    const auto decode = schema.key_format_ == KeyFormat::ordered ? &CellCodec::decode_key : &CellCodec::decode;
     for (auto idx : schema.pkey_) {
-        auto res = CellCodec::decode(key, schema.cols_[idx].type_);
+        auto res = decode(key, schema.cols_[idx].type_);
         if (!res.has_value()) return res.error();
         row[idx] = std::move(res.value());
     }
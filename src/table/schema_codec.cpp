@@ -24,6 +24,17 @@ bytes SchemaCodec::encode(const Schema &schema) {
     for (auto idx : schema.pkey_) {
         push_u32(out, static_cast<uint32_t>(idx));
     }
+    out.push_back(static_cast<std::byte>(schema.key_format_));
+    if (schema.indexes_.empty()) return out;
+
+    push_u32(out, static_cast<uint32_t>(schema.indexes_.size()));
+    for (const auto &index : schema.indexes_) {
+        push_str(out, index.name_);
+        push_u32(out, static_cast<uint32_t>(index.cols_.size()));
+        for (auto idx : index.cols_) {
+            push_u32(out, static_cast<uint32_t>(idx));
+        }
+    }
     return out;
 }
 
@@ -59,13 +70,45 @@ std::expected<Schema, std::error_code> SchemaCodec::decode(std::span<const std::
         pkey.push_back(*key);
     }
 
+    auto key_format = KeyFormat::raw;
+    if (!buf.empty()) {
+        switch (static_cast<KeyFormat>(buf[0])) {
+            case KeyFormat::raw:
+            case KeyFormat::ordered: key_format = static_cast<KeyFormat>(buf[0]); break;
+            default: return std::unexpected(db_error::unsupported_version);
+        }
+        buf = buf.subspan<1>();
+    }
+
+    std::vector<IndexHeader> indexes;
+    if (!buf.empty()) {
+        auto index_count = read_u32(buf);
+        if (!index_count) return std::unexpected(db_error::expect_more_data);
+        for (uint32_t i = 0; i < *index_count; ++i) {
+            auto index_name = read_str(buf);
+            if (!index_name) return std::unexpected(db_error::expect_more_data);
+            auto index_col_count = read_u32(buf);
+            if (!index_col_count) return std::unexpected(db_error::expect_more_data);
+            IndexHeader index{ std::move(*index_name), {} };
+            for (uint32_t j = 0; j < *index_col_count; ++j) {
+                auto col = read_u32(buf);
+                if (!col) return std::unexpected(db_error::expect_more_data);
+                if (*col >= cols.size()) return std::unexpected(db_error::bad_key);
+                index.cols_.push_back(*col);
+            }
+            indexes.push_back(std::move(index));
+        }
+    }
+
     if (!buf.empty()) return std::unexpected(db_error::trailing_garbage);
 
     auto schema = Schema(
         *id,
         std::move(*name),
         std::move(cols),
-        std::move(pkey)
+        std::move(pkey),
+        key_format
     );
+    schema.indexes_ = std::move(indexes);
     return schema;
 }
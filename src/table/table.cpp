@@ -22,19 +22,31 @@ static std::expected<std::optional<Schema>, std::error_code> load_schema(const K
         });
 }
 
-static std::expected<bool, std::error_code> save_schema(KeyValue &kv, const Schema &schema) {
-    bytes registry_key = schema_registry_key(schema.name_);
+/**
+ * @brief Queues the writes that register @p schema: the schema entry itself
+ *        and the ID counter advanced past `schema.id_`.
+ *
+ * Committing both through one @ref WriteBatch means a crash can never leave
+ * the counter advanced without the schema, or the schema without the counter.
+ *
+ * @param batch  Destination batch.
+ * @param schema Schema whose `id_` has already been assigned.
+ */
+static void save_schema(WriteBatch &batch, const Schema &schema) {
+    static const bytes counter_key = to_bytes(SchemaCodec::COUNTER_KEY_PREFIX);
 
-    return kv.set(registry_key, SchemaCodec::encode(schema));
+    batch.put(counter_key, pack_le<uint32_t>(schema.id_ + 1));
+    batch.put(schema_registry_key(schema.name_), SchemaCodec::encode(schema));
 }
 
 /**
  * @brief Get the next unused ID (4 bytes)
- * @warning The ID counter is irreversibly updated every time the function is called and returned successfully.
+ * @note Only reads the counter; @ref save_schema advances it together with
+ *       the schema that claims the ID.
  * @param kv
  * @return std::expected<uint32_t, std::error_code>
  */
-static std::expected<uint32_t, std::error_code> get_next_id(KeyValue &kv) {
+static std::expected<uint32_t, std::error_code> get_next_id(const KeyValue &kv) {
     static const bytes counter_key = to_bytes(SchemaCodec::COUNTER_KEY_PREFIX);
 
     return kv.get(counter_key)
@@ -45,13 +57,6 @@ static std::expected<uint32_t, std::error_code> get_next_id(KeyValue &kv) {
             std::array<std::byte, 4> id;
             std::copy(opt.value().begin(), opt.value().begin() + 4, id.begin());
             return unpack_le<uint32_t>(std::span<const std::byte, 4>(id));
-        })
-        .and_then([&](uint32_t current_id) -> std::expected<uint32_t, std::error_code> {
-            auto next_id = pack_le<uint32_t>(current_id + 1);
-            bytes counter_bytes(4);
-            std::copy(next_id.begin(), next_id.end(), counter_bytes.begin());
-            return kv.set(counter_key, next_id)
-                .transform([current_id](bool) { return current_id; });
         });
 }
 
@@ -63,7 +68,27 @@ std::expected<Table, std::error_code> Table::open(KeyValue &kv, const std::strin
         });
 }
 
+/**
+ * @brief Checks the secondary indexes of @p schema: at most
+ *        @ref RowCodec::MAX_INDEXES, uniquely named, each over one or more
+ *        existing non-key columns.
+ */
+static std::error_code validate_indexes(const Schema &schema) {
+    const auto invalid = std::make_error_code(std::errc::invalid_argument);
+    if (schema.indexes_.size() > RowCodec::MAX_INDEXES) return invalid;
+    for (size_t i = 0; i < schema.indexes_.size(); ++i) {
+        const auto &index = schema.indexes_[i];
+        if (index.cols_.empty() || schema.find_index(index.name_) != i) return invalid;
+        for (auto idx : index.cols_) {
+            if (idx >= schema.cols_.size() || schema.is_pkey(idx)) return invalid;
+        }
+    }
+    return {};
+}
+
 std::expected<Table, std::error_code> Table::create(KeyValue &kv, Schema schema) {
+    if (auto err = validate_indexes(schema); err) return std::unexpected(err);
+
     return load_schema(kv, schema.name_)
         .and_then([](std::optional<Schema> opt) -> std::expected<void, std::error_code> {
             if (opt.has_value()) return std::unexpected(db_error::table_already_exists);
@@ -72,8 +97,10 @@ std::expected<Table, std::error_code> Table::create(KeyValue &kv, Schema schema)
         .and_then([&]() { return get_next_id(kv); })
         .and_then([&](uint32_t new_id) -> std::expected<Table, std::error_code> {
             schema.id_ = new_id;
-            if (auto res = save_schema(kv, schema); !res.has_value())
-                return std::unexpected(res.error());
+            WriteBatch batch;
+            save_schema(batch, schema);
+            if (auto err = kv.write(batch); err)
+                return std::unexpected(err);
             return Table(kv, std::move(schema));
         });
 }
@@ -90,18 +117,17 @@ std::expected<Table, std::error_code> Table::open_or_create(KeyValue &kv, Schema
 
 std::expected<bool, std::error_code> Table::Select(Row &row) const {
     return RowCodec::encode_key(schema_, row)
-        .and_then([this](const bytes &key) {
-            return kv_.get(key);
-        })
-        .and_then([this, &row](std::optional<bytes> val_opt) -> std::expected<bool, std::error_code> {
-            if (!val_opt.has_value()) return false;
-            if (auto err = RowCodec::decode_val(schema_, row, val_opt.value()); err)
-                return std::unexpected(err);
-            return true;
+        .and_then([this, &row](const bytes &key) {
+            // Decode straight from the stored bytes rather than a copy of them
+            return kv_.get_view(key, [this, &row](std::span<const std::byte> val) {
+                return RowCodec::decode_val(schema_, row, val);
+            });
         });
 }
 
 std::expected<bool, std::error_code> Table::Insert(const Row &row) {
+    if (!schema_.indexes_.empty()) return write_indexed(row, KeyValue::WriteMode::Insert);
+
     auto key = RowCodec::encode_key(schema_, row);
     if (!key.has_value()) return std::unexpected(key.error());
 
@@ -112,6 +138,8 @@ std::expected<bool, std::error_code> Table::Insert(const Row &row) {
 }
 
 std::expected<bool, std::error_code> Table::Update(const Row &row) {
+    if (!schema_.indexes_.empty()) return write_indexed(row, KeyValue::WriteMode::Update);
+
     auto key = RowCodec::encode_key(schema_, row);
     if (!key.has_value()) return std::unexpected(key.error());
 
@@ -122,6 +150,8 @@ std::expected<bool, std::error_code> Table::Update(const Row &row) {
 }
 
 std::expected<bool, std::error_code> Table::Upsert(const Row &row) {
+    if (!schema_.indexes_.empty()) return write_indexed(row, KeyValue::WriteMode::Upsert);
+
     auto key = RowCodec::encode_key(schema_, row);
     if (!key.has_value()) return std::unexpected(key.error());
 
@@ -135,5 +165,123 @@ std::expected<bool, std::error_code> Table::Delete(const Row &row) {
     auto key = RowCodec::encode_key(schema_, row);
     if (!key.has_value()) return std::unexpected(key.error());
 
-    return kv_.del(key.value());
+    if (schema_.indexes_.empty()) return kv_.del(key.value());
+
+    return kv_.read_modify_write(key.value(), [&](std::optional<std::span<const std::byte>> old, WriteBatch &batch) {
+        if (!old.has_value()) return std::error_code{};
+        // The stored row names the index entries to drop
+        Row prev = row;
+        if (auto err = RowCodec::decode_val(schema_, prev, *old); err) return err;
+        batch.del(key.value());
+        for (size_t i = 0; i < schema_.indexes_.size(); ++i) {
+            auto index_key = RowCodec::encode_index_key(schema_, i, prev);
+            if (!index_key.has_value()) return index_key.error();
+            batch.del(index_key.value());
+        }
+        return std::error_code{};
+    });
+}
+
+std::expected<bool, std::error_code> Table::write_indexed(const Row &row, KeyValue::WriteMode mode) {
+    auto key = RowCodec::encode_key(schema_, row);
+    if (!key.has_value()) return std::unexpected(key.error());
+
+    auto val = RowCodec::encode_val(schema_, row);
+    if (!val.has_value()) return std::unexpected(val.error());
+
+    std::vector<bytes> index_keys;
+    for (size_t i = 0; i < schema_.indexes_.size(); ++i) {
+        auto index_key = RowCodec::encode_index_key(schema_, i, row);
+        if (!index_key.has_value()) return std::unexpected(index_key.error());
+        index_keys.push_back(std::move(index_key.value()));
+    }
+
+    return kv_.read_modify_write(key.value(), [&](std::optional<std::span<const std::byte>> old, WriteBatch &batch) {
+        // Same outcomes as KeyValue::set_ex: nothing is written for an unchanged row
+        if (old.has_value() ? mode == KeyValue::WriteMode::Insert : mode == KeyValue::WriteMode::Update)
+            return std::error_code{};
+        if (old.has_value() && std::ranges::equal(*old, val.value())) return std::error_code{};
+
+        Row prev = row;
+        if (old.has_value()) {
+            if (auto err = RowCodec::decode_val(schema_, prev, *old); err) return err;
+        }
+        batch.put(key.value(), val.value());
+        for (size_t i = 0; i < index_keys.size(); ++i) {
+            if (old.has_value()) {
+                auto old_key = RowCodec::encode_index_key(schema_, i, prev);
+                if (!old_key.has_value()) return old_key.error();
+                if (old_key.value() == index_keys[i]) continue;
+                batch.del(old_key.value());
+            }
+            batch.put(index_keys[i], bytes{});
+        }
+        return std::error_code{};
+    });
+}
+
+std::expected<Table::Cursor, std::error_code> Table::Scan(std::optional<std::span<const Cell>> lower,
+                                                          std::optional<std::span<const Cell>> upper,
+                                                          ScanOptions options) const {
+    // Raw keys sort by their encoding, not by value, so only whole-table scans make sense
+    if (schema_.key_format_ != KeyFormat::ordered && (lower || upper))
+        return std::unexpected(std::make_error_code(std::errc::operation_not_supported));
+
+    auto lower_key = RowCodec::encode_key_prefix(schema_, lower.value_or(std::span<const Cell>{}));
+    if (!lower_key.has_value()) return std::unexpected(lower_key.error());
+
+    bytes upper_key;
+    if (upper.has_value()) {
+        auto key = RowCodec::encode_key_prefix(schema_, *upper);
+        if (!key.has_value()) return std::unexpected(key.error());
+        upper_key = std::move(key.value());
+    } else {
+        // The table's keys all start with its prefix, which ends in the 0x00 separator
+        upper_key = RowCodec::key_prefix(schema_);
+        upper_key.back() = static_cast<std::byte>(static_cast<uint8_t>(RowCodec::ID_SEPARATOR) + 1);
+    }
+
+    return Cursor(schema_, kv_, std::nullopt,
+                  kv_.scan(lower_key.value(), std::span<const std::byte>(upper_key), options));
+}
+
+std::expected<Table::Cursor, std::error_code> Table::ScanPrefix(std::span<const Cell> prefix,
+                                                                ScanOptions options) const {
+    if (schema_.key_format_ != KeyFormat::ordered && !prefix.empty())
+        return std::unexpected(std::make_error_code(std::errc::operation_not_supported));
+
+    return RowCodec::encode_key_prefix(schema_, prefix)
+        .transform([this, options](const bytes &key) {
+            return Cursor(schema_, kv_, std::nullopt, kv_.scan_prefix(key, options));
+        });
+}
+
+std::expected<Table::Cursor, std::error_code> Table::Lookup(std::string_view index, std::span<const Cell> values,
+                                                            ScanOptions options) const {
+    const size_t pos = schema_.find_index(index);
+    if (pos == schema_.indexes_.size()) return std::unexpected(db_error::index_not_found);
+
+    return RowCodec::encode_index_prefix(schema_, pos, values)
+        .transform([this, pos, options](const bytes &prefix) {
+            return Cursor(schema_, kv_, pos, kv_.scan_prefix(prefix, options));
+        });
+}
+
+std::error_code Table::Cursor::row(Row &row) const {
+    row.assign(schema_->cols_.size(), Cell::make_empty());
+    if (!index_.has_value()) {
+        if (auto err = RowCodec::decode_key(*schema_, row, rows_.key()); err) return err;
+        return RowCodec::decode_val(*schema_, row, rows_.value());
+    }
+
+    // The entry holds the primary key; the rest of the row is read from the store
+    if (auto err = RowCodec::decode_index_key(*schema_, *index_, row, rows_.key()); err) return err;
+    auto found = RowCodec::encode_key(*schema_, row)
+        .and_then([this, &row](const bytes &key) {
+            return kv_->get_view(key, [this, &row](std::span<const std::byte> val) {
+                return RowCodec::decode_val(*schema_, row, val);
+            });
+        });
+    if (!found.has_value()) return found.error();
+    return found.value() ? std::error_code{} : db_error::row_not_found;
 }
@@ -0,0 +1,82 @@
+// test/core/test_epoch.cpp
+
+/**
+ * @file test_epoch.cpp
+ * @brief Unit tests for @ref EpochDomain.
+ *
+ * Covers: objects retired while a reader is pinned outlive the pin and are
+ * freed after it, readers that pin later do not hold anything back, and
+ * nested pins.
+ */
+
+#include <gtest/gtest.h>
+#include <memory>           // std::unique_ptr
+#include "core/epoch.h"
+
+namespace {
+
+/// Counts its destructions.
+struct Tracked {
+    int *freed_;
+    ~Tracked() { ++*freed_; }
+};
+
+} // namespace
+
+/**
+ * @brief Verifies that a retired object is freed only once every reader
+ *        pinned before its retirement has unpinned.
+ */
+TEST(EpochTest, FreesAfterReaders) {
+    int freed = 0;
+    EpochDomain domain;
+
+    // Nobody pinned: freed right away
+    domain.retire(std::make_unique<Tracked>(&freed));
+    EXPECT_EQ(freed, 1);
+    EXPECT_EQ(domain.pending(), 0u);
+
+    {
+        auto early = domain.pin();
+        domain.retire(std::make_unique<Tracked>(&freed));
+        EXPECT_EQ(freed, 1);
+        {
+            // Pinned after the retirement and nested in the same thread
+            auto late = domain.pin();
+            domain.retire(std::make_unique<Tracked>(&freed));
+            EXPECT_EQ(freed, 1);
+        }
+        domain.collect();
+        EXPECT_EQ(freed, 1);
+        EXPECT_EQ(domain.pending(), 2u);
+    }
+    domain.collect();
+    EXPECT_EQ(freed, 3);
+    EXPECT_EQ(domain.pending(), 0u);
+
+    // What is still pending when the domain goes away is freed with it
+    {
+        EpochDomain scoped;
+        {
+            auto guard = scoped.pin();
+            scoped.retire(std::make_unique<Tracked>(&freed));
+        }
+        EXPECT_EQ(scoped.pending(), 1u);
+    }
+    EXPECT_EQ(freed, 4);
+}
+
+/**
+ * @brief Verifies that a reader pinned only after an object was retired
+ *        does not keep it alive.
+ */
+TEST(EpochTest, LaterReaderDoesNotBlock) {
+    int freed = 0;
+    EpochDomain domain;
+    auto first = std::make_unique<EpochDomain::Guard>(domain.pin());
+    domain.retire(std::make_unique<Tracked>(&freed));
+    auto second = domain.pin();
+    first.reset();
+    domain.collect();
+    EXPECT_EQ(freed, 1);
+}
@@ -0,0 +1,159 @@
+// test/core/test_platform.cpp
+
+/**
+ * @file test_platform.cpp
+ * @brief Unit tests for the platform file I/O layer.
+ *
+ * Covers: scatter-gather writes, positional I/O, the buffered reader and
+ * file mapping.
+ */
+
+#include <gtest/gtest.h>
+#include <filesystem>       // std::filesystem::remove, temp_directory_path
+#include <vector>           // std::vector
+#include <algorithm>        // std::equal
+#include "core/platform.h"
+#include "core/buffered_reader.h"
+#include "test_utils.h"     // to_bytes
+
+/// Temporary file used by every test in this translation unit.
+const std::string test_file = (std::filesystem::temp_directory_path() / "kvdb_platform_test").string();
+
+/**
+ * @brief Writes more buffers than one `writev` call accepts, including
+ *        empty ones, and checks that the file holds their concatenation.
+ */
+TEST(PlatformTest, WritevGathersAllBuffers) {
+    std::filesystem::remove(test_file);
+
+    std::vector<bytes> pieces;
+    bytes expected;
+    for (int i = 0; i < 300; ++i) {
+        pieces.push_back(i % 7 == 0 ? bytes{} : to_bytes(std::string(i % 13 + 1, static_cast<char>('a' + i % 26))));
+        expected.insert(expected.end(), pieces.back().begin(), pieces.back().end());
+    }
+    std::vector<std::span<const std::byte>> bufs(pieces.begin(), pieces.end());
+
+    FileHandle fh;
+    ASSERT_FALSE(platform_open_file(test_file, fh));
+    ASSERT_FALSE(platform_writev(fh, bufs));
+    ASSERT_FALSE(platform_seek(fh, 0, SEEK_SET));
+
+    bytes actual(expected.size() + 1);
+    size_t n = 0;
+    ASSERT_FALSE(platform_read(fh, std::span<std::byte>(actual), n));
+    actual.resize(n);
+    EXPECT_EQ(actual, expected);
+
+    ASSERT_FALSE(platform_close(fh));
+    std::filesystem::remove(test_file);
+}
+
+/**
+ * @brief Checks that positional reads and writes use their own offsets,
+ *        leave the file position alone, and that truncation cuts the file.
+ */
+TEST(PlatformTest, PositionalIO) {
+    std::filesystem::remove(test_file);
+
+    FileHandle fh;
+    ASSERT_FALSE(platform_open_file(test_file, fh));
+    ASSERT_FALSE(platform_pwrite(fh, to_bytes("world"), 5));
+    ASSERT_FALSE(platform_pwrite(fh, to_bytes("hello"), 0));
+
+    auto head = to_bytes("x");
+    auto tail = to_bytes("yz");
+    const std::span<const std::byte> parts[] = { head, {}, tail };
+    ASSERT_FALSE(platform_pwritev(fh, parts, 10));
+
+    bytes buf(20);
+    size_t n = 0;
+    ASSERT_FALSE(platform_pread(fh, std::span<std::byte>(buf), 0, n));
+    buf.resize(n);
+    EXPECT_EQ(buf, to_bytes("helloworldxyz"));
+
+    // The sequential position never moved
+    bytes seq(5);
+    ASSERT_FALSE(platform_read(fh, std::span<std::byte>(seq), n));
+    EXPECT_EQ(seq, to_bytes("hello"));
+
+    // Reads past EOF are short, not errors
+    bytes past(4);
+    ASSERT_FALSE(platform_pread(fh, std::span<std::byte>(past), 11, n));
+    EXPECT_EQ(n, 2u);
+
+    ASSERT_FALSE(platform_truncate(fh, 5));
+    EXPECT_EQ(std::filesystem::file_size(test_file), 5u);
+
+    ASSERT_FALSE(platform_close(fh));
+    std::filesystem::remove(test_file);
+}
+
+/**
+ * @brief Reads a file through a small @ref BufferedReader in pieces smaller
+ *        and larger than its buffer, and checks bytes, offsets and EOF.
+ */
+TEST(PlatformTest, BufferedReader) {
+    std::filesystem::remove(test_file);
+
+    bytes data;
+    for (int i = 0; i < 1000; ++i) data.push_back(static_cast<std::byte>(i * 7));
+
+    FileHandle fh;
+    ASSERT_FALSE(platform_open_file(test_file, fh));
+    ASSERT_FALSE(platform_write(fh, data));
+
+    BufferedReader reader(64);
+    reader.attach(fh, 10);
+    bytes out;
+    size_t n = 0;
+    for (size_t want : { 13u, 5u, 200u, 64u, 1u, 40u }) {
+        bytes piece(want);
+        ASSERT_FALSE(reader.read(std::span<std::byte>(piece), n));
+        ASSERT_EQ(n, want);
+        out.insert(out.end(), piece.begin(), piece.end());
+        EXPECT_EQ(reader.offset(), 10 + out.size());
+    }
+    EXPECT_TRUE(std::equal(out.begin(), out.end(), data.begin() + 10));
+
+    // Short at EOF, then empty
+    bytes rest(2000);
+    ASSERT_FALSE(reader.read(std::span<std::byte>(rest), n));
+    EXPECT_EQ(n, data.size() - 10 - out.size());
+    EXPECT_EQ(reader.offset(), data.size());
+    ASSERT_FALSE(reader.read(std::span<std::byte>(rest), n));
+    EXPECT_EQ(n, 0u);
+
+    ASSERT_FALSE(platform_close(fh));
+    std::filesystem::remove(test_file);
+}
+
+/**
+ * @brief Maps a file, checks the mapped bytes, and that the mapping
+ *        outlives the handle and is released by @ref platform_unmap.
+ */
+TEST(PlatformTest, MapFile) {
+    std::filesystem::remove(test_file);
+
+    auto data = to_bytes("mapped bytes");
+    FileHandle fh;
+    ASSERT_FALSE(platform_open_file(test_file, fh));
+    ASSERT_FALSE(platform_write(fh, data));
+
+    FileMapping empty;
+    ASSERT_FALSE(platform_map(fh, 0, empty));
+    EXPECT_TRUE(empty.data().empty());
+
+    FileMapping map;
+    ASSERT_FALSE(platform_map(fh, data.size(), map));
+    ASSERT_FALSE(platform_close(fh));
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), map.data().begin(), map.data().end()));
+
+    FileMapping moved = std::move(map);
+    EXPECT_TRUE(map.data().empty());
+    EXPECT_EQ(moved.data().size(), data.size());
+    ASSERT_FALSE(platform_unmap(moved));
+    EXPECT_TRUE(moved.data().empty());
+
+    std::filesystem::remove(test_file);
+}
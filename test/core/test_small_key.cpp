@@ -0,0 +1,85 @@
+// test/core/test_small_key.cpp
+
+/**
+ * @file test_small_key.cpp
+ * @brief Unit tests for @ref SmallKey.
+ *
+ * Covers: inline and spilled storage, copies and moves between the two,
+ * and lookups by span through the transparent hasher.
+ */
+
+#include <gtest/gtest.h>
+#include <string>           // std::string
+#include <unordered_map>    // std::unordered_map
+#include <utility>          // std::move
+#include "core/small_key.h"
+#include "core/types.h"     // bytes, to_bytes
+
+/**
+ * @brief Verifies that keys up to the inline capacity stay inline, longer
+ *        ones spill, and both read back byte for byte.
+ */
+TEST(SmallKeyTest, InlineAndSpilled) {
+    SmallKey empty;
+    EXPECT_EQ(empty.size(), 0u);
+    EXPECT_TRUE(empty.is_inline());
+
+    for (size_t len : { size_t{1}, size_t{13}, SmallKey::INLINE_CAPACITY, SmallKey::INLINE_CAPACITY + 1, size_t{1024} }) {
+        const bytes src = to_bytes(std::string(len, 'k'));
+        SmallKey key(src);
+        EXPECT_EQ(key.is_inline(), len <= SmallKey::INLINE_CAPACITY);
+        EXPECT_EQ(key.size(), len);
+        EXPECT_TRUE(key == std::span<const std::byte>(src));
+        EXPECT_EQ(bytes(key.view().begin(), key.view().end()), src);
+    }
+}
+
+/**
+ * @brief Verifies copies and moves in every inline/spilled combination,
+ *        including self-assignment and use of a moved-from key.
+ */
+TEST(SmallKeyTest, CopyAndMove) {
+    const bytes short_src = to_bytes("short");
+    const bytes long_src  = to_bytes(std::string(100, 'L'));
+
+    SmallKey a(short_src), b(long_src);
+    SmallKey c = b;
+    EXPECT_TRUE(c == b);
+    EXPECT_NE(c.data(), b.data());
+
+    c = a;
+    EXPECT_TRUE(c == std::span<const std::byte>(short_src));
+    c = b;
+    EXPECT_TRUE(c == std::span<const std::byte>(long_src));
+    c = static_cast<const SmallKey &>(c);
+    EXPECT_TRUE(c == std::span<const std::byte>(long_src));
+
+    // Moving a spilled key hands over its heap copy
+    const std::byte *heap = b.data();
+    SmallKey d = std::move(b);
+    EXPECT_EQ(d.data(), heap);
+    EXPECT_EQ(b.size(), 0u);
+    b = a;
+    EXPECT_TRUE(b == std::span<const std::byte>(short_src));
+
+    a = std::move(d);
+    EXPECT_TRUE(a == std::span<const std::byte>(long_src));
+    EXPECT_EQ(d.size(), 0u);
+}
+
+/**
+ * @brief Verifies that a map keyed by `SmallKey` can be probed with a span.
+ */
+TEST(SmallKeyTest, TransparentLookup) {
+    std::unordered_map<SmallKey, int, SmallKeyHash, SmallKeyEqual> map;
+    for (int i = 0; i < 100; ++i)
+        map.emplace(SmallKey(to_bytes("key" + std::to_string(i) + std::string(i % 3 ? 0 : 30, 'x'))), i);
+
+    for (int i = 0; i < 100; ++i) {
+        const bytes probe = to_bytes("key" + std::to_string(i) + std::string(i % 3 ? 0 : 30, 'x'));
+        auto it = map.find(std::span<const std::byte>(probe));
+        ASSERT_NE(it, map.end());
+        EXPECT_EQ(it->second, i);
+    }
+    EXPECT_EQ(map.find(std::span<const std::byte>(to_bytes("absent"))), map.end());
+}
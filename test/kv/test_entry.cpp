@@ -4,7 +4,8 @@
  * @file test_entry.cpp
  * @brief Unit tests for @ref EntryCodec encode/decode round-trips.
  *
- * Covers: normal entries, tombstones, clean EOF, and checksum corruption.
+ * Covers: normal entries, tombstones, batch frames, stand-alone headers,
+ * clean EOF, checksum corruption and in-place decoding.
  */
 
 #include <gtest/gtest.h>
@@ -43,8 +44,34 @@ TEST(EntryTest, EncodeDecode) {
 }
 
 /**
- * @brief Verifies that decoding an empty buffer returns @ref EntryEOF
- *        rather than an error.
+ * @brief Verifies that a header built by @ref EntryCodec::encode_header,
+ *        followed by the untouched key and value, decodes like a fully
+ *        encoded record, and that tombstones ignore the value span.
+ */
+TEST(EntryTest, HeaderOnlyEncode) {
+    auto key = to_bytes("key");
+    auto val = to_bytes(std::string(300, 'v'));
+
+    auto header = EntryCodec::encode_header(key, val, false);
+    bytes record(header.begin(), header.end());
+    record.insert(record.end(), key.begin(), key.end());
+    record.insert(record.end(), val.begin(), val.end());
+    EXPECT_EQ(record, EntryCodec::encode(Entry(key, val, false)));
+
+    BufferReader reader{std::span<const std::byte>(record)};
+    auto decoded = EntryCodec::decode(reader);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(std::get<Entry>(decoded.value()), Entry(key, val, false));
+
+    auto tomb = EntryCodec::encode_header(key, val, true);
+    bytes tomb_record(tomb.begin(), tomb.end());
+    tomb_record.insert(tomb_record.end(), key.begin(), key.end());
+    EXPECT_EQ(tomb_record, EntryCodec::encode(Entry(key, {}, true)));
+}
+
+/**
+ * @brief Verifies that decoding an empty buffer, or zero bytes such as
+ *        preallocated log space, returns @ref EntryEOF rather than an error.
  */
 TEST(EntryTest, EntryEOF) {
     bytes empty{};
@@ -53,6 +80,14 @@ TEST(EntryTest, EntryEOF) {
     auto result = EntryCodec::decode(empty_reader);
     ASSERT_TRUE(result.has_value());
     EXPECT_TRUE(std::holds_alternative<EntryEOF>(result.value()));
+
+    for (size_t n : { size_t{5}, EntryCodec::HEADER_SIZE, size_t{4096} }) {
+        bytes zeros(n);
+        BufferReader zero_reader{std::span<const std::byte>(zeros)};
+        auto zero_result = EntryCodec::decode(zero_reader);
+        ASSERT_TRUE(zero_result.has_value());
+        EXPECT_TRUE(std::holds_alternative<EntryEOF>(zero_result.value()));
+    }
 }
 
 /**
@@ -71,3 +106,88 @@ TEST(EntryTest, BadChecksumDetection) {
     ASSERT_FALSE(result.has_value());
     EXPECT_EQ(result.error(), db_error::bad_checksum);
 }
+
+/**
+ * @brief Verifies that a batch of puts and deletes survives an encode →
+ *        decode round-trip as one record, and that corrupting any byte of
+ *        its body rejects the whole batch.
+ */
+TEST(EntryTest, BatchEncodeDecode) {
+    WriteBatch batch;
+    batch.put(to_bytes("k1"), to_bytes("v1"));
+    batch.del(to_bytes("k2"));
+    batch.put(to_bytes("k3"), bytes{});
+
+    auto encoded = EntryCodec::encode(batch);
+    ASSERT_TRUE(encoded.has_value());
+
+    BufferReader reader{std::span<const std::byte>(encoded.value())};
+    auto decoded = EntryCodec::decode(reader);
+    ASSERT_TRUE(decoded.has_value());
+    ASSERT_TRUE(std::holds_alternative<WriteBatch>(decoded.value()));
+    EXPECT_EQ(std::get<WriteBatch>(decoded.value()), batch);
+
+    // The whole record was consumed
+    auto eof = EntryCodec::decode(reader);
+    ASSERT_TRUE(eof.has_value());
+    EXPECT_TRUE(std::holds_alternative<EntryEOF>(eof.value()));
+
+    // A flipped bit in the middle of the body fails the single checksum
+    bytes corrupt = encoded.value();
+    corrupt[corrupt.size() / 2] ^= std::byte{0x01};
+    BufferReader bad_reader{std::span<const std::byte>(corrupt)};
+    auto bad = EntryCodec::decode(bad_reader);
+    ASSERT_FALSE(bad.has_value());
+    EXPECT_EQ(bad.error(), db_error::bad_checksum);
+}
+
+/**
+ * @brief Decodes a buffer of mixed records in place and checks that the
+ *        views point into it, then that truncation and corruption are
+ *        reported as by @ref EntryCodec::decode.
+ */
+TEST(EntryTest, DecodeView) {
+    WriteBatch batch;
+    batch.put(to_bytes("b1"), to_bytes("x"));
+    batch.del(to_bytes("b2"));
+
+    bytes buf = EntryCodec::encode(Entry(to_bytes("k1"), to_bytes("v1"), false));
+    auto tomb = EntryCodec::encode(Entry(to_bytes("k2"), {}, true));
+    buf.insert(buf.end(), tomb.begin(), tomb.end());
+    auto framed = EntryCodec::encode(batch).value();
+    buf.insert(buf.end(), framed.begin(), framed.end());
+    const size_t records_end = buf.size();
+    buf.resize(buf.size() + 64);    // preallocated zeros
+
+    size_t offset = 0;
+    auto first = EntryCodec::decode_view(buf, offset);
+    ASSERT_TRUE(first.has_value());
+    const auto &put = std::get<EntryView>(first.value());
+    EXPECT_EQ(Entry(put), Entry(to_bytes("k1"), to_bytes("v1"), false));
+    EXPECT_EQ(put.key_.data(), buf.data() + EntryCodec::HEADER_SIZE);
+
+    auto second = EntryCodec::decode_view(buf, offset);
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(Entry(std::get<EntryView>(second.value())), Entry(to_bytes("k2"), {}, true));
+
+    auto third = EntryCodec::decode_view(buf, offset);
+    ASSERT_TRUE(third.has_value());
+    WriteBatch viewed;
+    std::get<BatchView>(third.value()).for_each([&](const EntryView &op) { viewed.add(Entry(op)); });
+    EXPECT_EQ(viewed, batch);
+    EXPECT_EQ(offset, records_end);
+
+    auto eof = EntryCodec::decode_view(buf, offset);
+    ASSERT_TRUE(eof.has_value());
+    EXPECT_TRUE(std::holds_alternative<EntryEOF>(eof.value()));
+    EXPECT_EQ(offset, records_end);
+
+    // A record cut short, or with a flipped bit, fails without moving the offset
+    size_t cut = 0;
+    EXPECT_EQ(EntryCodec::decode_view(std::span(buf).first(EntryCodec::HEADER_SIZE + 1), cut).error(),
+              db_error::truncated_payload);
+    EXPECT_EQ(EntryCodec::decode_view(std::span(buf).first(5), cut).error(), db_error::truncated_header);
+    buf[EntryCodec::HEADER_SIZE] ^= std::byte{0x01};
+    EXPECT_EQ(EntryCodec::decode_view(buf, cut).error(), db_error::bad_checksum);
+    EXPECT_EQ(cut, 0u);
+}
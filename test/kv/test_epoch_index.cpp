@@ -0,0 +1,154 @@
+// test/kv/test_epoch_index.cpp
+
+/**
+ * @file test_epoch_index.cpp
+ * @brief Unit tests for @ref EpochIndex.
+ *
+ * Covers: lookups, overwrites and erasure checked against an `std::map`
+ * model through growth and garbage rebuilds, and lock-free readers running
+ * against a writer.
+ */
+
+#include <gtest/gtest.h>
+#include "kv/epoch_index.h"
+#include "core/types.h"     // bytes, to_bytes
+#include <atomic>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// Asserts that @p index holds exactly the pairs of @p model.
+void expect_same(const EpochIndex &index, const std::map<bytes, bytes> &model) {
+    ASSERT_EQ(index.size(), model.size());
+    for (const auto &[key, val] : model) {
+        auto found = index.find(key);
+        ASSERT_TRUE(found.has_value());
+        EXPECT_EQ(bytes(found->begin(), found->end()), val);
+    }
+    std::map<bytes, bytes> seen;
+    index.for_each([&](std::span<const std::byte> key, std::span<const std::byte> val) {
+        EXPECT_TRUE(seen.emplace(bytes(key.begin(), key.end()), bytes(val.begin(), val.end())).second);
+    });
+    EXPECT_EQ(seen, model);
+}
+
+} // namespace
+
+/**
+ * @brief Verifies put/find/erase on a handful of keys, including the empty
+ *        key and value, and the old lengths they report.
+ */
+TEST(EpochIndexTest, Basic) {
+    EpochIndex index;
+    EXPECT_TRUE(index.empty());
+    EXPECT_FALSE(index.find(to_bytes("a")).has_value());
+    EXPECT_FALSE(index.erase(to_bytes("a")).has_value());
+
+    EXPECT_EQ(index.put(to_bytes("a"), to_bytes("one")), std::nullopt);
+    EXPECT_EQ(index.put(bytes{}, bytes{}), std::nullopt);
+    EXPECT_EQ(index.size(), 2u);
+    EXPECT_TRUE(index.contains(bytes{}));
+    EXPECT_EQ(index.find(bytes{})->size(), 0u);
+
+    // A span found under a pin survives an overwrite of its key
+    {
+        auto guard = index.pin();
+        auto old = index.find(to_bytes("a"));
+        EXPECT_EQ(index.put(to_bytes("a"), to_bytes("a longer value")), std::optional<size_t>(3));
+        EXPECT_EQ(bytes(old->begin(), old->end()), to_bytes("one"));
+    }
+    auto val = index.find(to_bytes("a"));
+    EXPECT_EQ(bytes(val->begin(), val->end()), to_bytes("a longer value"));
+
+    EXPECT_EQ(index.erase(to_bytes("a")), std::optional<size_t>(14));
+    EXPECT_FALSE(index.contains(to_bytes("a")));
+    EXPECT_EQ(index.size(), 1u);
+
+    index.clear();
+    EXPECT_TRUE(index.empty());
+    EXPECT_EQ(index.memory_usage(), 0u);
+    EXPECT_EQ(index.put(to_bytes("b"), to_bytes("two")), std::nullopt);
+    EXPECT_TRUE(index.contains(to_bytes("b")));
+}
+
+/**
+ * @brief Drives a random mix of puts, overwrites and erases over a key
+ *        space large enough to force growth and garbage rebuilds,
+ *        comparing against a model after every phase.
+ */
+TEST(EpochIndexTest, MatchesModel) {
+    EpochIndex index;
+    std::map<bytes, bytes> model;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> key_dist(0, 20000), len_dist(0, 200), op_dist(0, 9);
+
+    for (int phase = 0; phase < 4; ++phase) {
+        for (int i = 0; i < 50000; ++i) {
+            auto key = to_bytes("key" + std::to_string(key_dist(rng)));
+            auto expected = model.contains(key) ? std::optional<size_t>(model[key].size()) : std::nullopt;
+            if (op_dist(rng) < 3) {
+                EXPECT_EQ(index.erase(key), expected);
+                model.erase(key);
+            } else {
+                bytes val(static_cast<size_t>(len_dist(rng)), std::byte(i & 0xFF));
+                EXPECT_EQ(index.put(key, val), expected);
+                model[key] = val;
+            }
+        }
+        expect_same(index, model);
+    }
+    // Live data is ~1.5 MiB; garbage is bounded by the rebuilds
+    EXPECT_LT(index.memory_usage(), 8u * 1024 * 1024);
+}
+
+/**
+ * @brief Runs pinned readers against a writer that overwrites, erases and
+ *        grows the index: every value a reader finds is whole and belongs
+ *        to the key it looked up.
+ */
+TEST(EpochIndexTest, ConcurrentReaders) {
+    EpochIndex index;
+    constexpr int KEYS = 2000;
+    auto key_of = [](int k) { return to_bytes("key" + std::to_string(k)); };
+    // The value repeats one byte derived from the key, at a length that changes with every write
+    auto val_of = [](int k, int round) { return bytes(static_cast<size_t>(1 + (k + round) % 64), std::byte(k & 0xFF)); };
+
+    std::atomic<bool> done{ false };
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t] {
+            std::mt19937 rng(t);
+            while (!done.load(std::memory_order_relaxed)) {
+                const int k = static_cast<int>(rng() % (KEYS * 2));
+                auto guard = index.pin();
+                auto val = index.find(key_of(k));
+                if (!val.has_value()) continue;
+                ASSERT_LT(k, KEYS);
+                ASSERT_FALSE(val->empty());
+                for (std::byte b : *val) ASSERT_EQ(b, std::byte(k & 0xFF));
+            }
+        });
+    }
+    for (int round = 0; round < 40; ++round) {
+        for (int k = 0; k < KEYS; ++k) {
+            if ((k + round) % 5 == 0) index.erase(key_of(k));
+            else index.put(key_of(k), val_of(k, round));
+        }
+    }
+    done = true;
+    for (auto &reader : readers) reader.join();
+
+    for (int k = 0; k < KEYS; ++k) {
+        auto val = index.find(key_of(k));
+        if ((k + 39) % 5 == 0) {
+            EXPECT_FALSE(val.has_value());
+        } else {
+            ASSERT_TRUE(val.has_value());
+            EXPECT_EQ(bytes(val->begin(), val->end()), val_of(k, 39));
+        }
+    }
+}
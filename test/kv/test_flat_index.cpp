@@ -0,0 +1,128 @@
+// test/kv/test_flat_index.cpp
+
+/**
+ * @file test_flat_index.cpp
+ * @brief Unit tests for @ref FlatIndex.
+ *
+ * Covers: lookups, in-place and relocating overwrites, erasure, growth,
+ * tombstone reuse, arena compaction and moves, all checked against an
+ * `std::map` model.
+ */
+
+#include <gtest/gtest.h>
+#include "kv/flat_index.h"
+#include "core/types.h"     // bytes, to_bytes
+#include <map>
+#include <random>
+#include <string>
+
+namespace {
+
+/// Asserts that @p index holds exactly the pairs of @p model.
+void expect_same(const FlatIndex &index, const std::map<bytes, bytes> &model) {
+    ASSERT_EQ(index.size(), model.size());
+    for (const auto &[key, val] : model) {
+        auto found = index.find(key);
+        ASSERT_TRUE(found.has_value());
+        EXPECT_EQ(bytes(found->begin(), found->end()), val);
+    }
+    std::map<bytes, bytes> seen;
+    index.for_each([&](std::span<const std::byte> key, std::span<const std::byte> val) {
+        EXPECT_TRUE(seen.emplace(bytes(key.begin(), key.end()), bytes(val.begin(), val.end())).second);
+    });
+    EXPECT_EQ(seen, model);
+}
+
+} // namespace
+
+/**
+ * @brief Verifies put/find/erase on a handful of keys, including the empty
+ *        key and value, and the old lengths they report.
+ */
+TEST(FlatIndexTest, Basic) {
+    FlatIndex index;
+    EXPECT_TRUE(index.empty());
+    EXPECT_FALSE(index.find(to_bytes("a")).has_value());
+    EXPECT_FALSE(index.erase(to_bytes("a")).has_value());
+
+    EXPECT_EQ(index.put(to_bytes("a"), to_bytes("one")), std::nullopt);
+    EXPECT_EQ(index.put(bytes{}, bytes{}), std::nullopt);
+    EXPECT_EQ(index.size(), 2u);
+    EXPECT_TRUE(index.contains(bytes{}));
+    EXPECT_EQ(index.find(bytes{})->size(), 0u);
+
+    // Shorter value: in place; longer value: a new record
+    EXPECT_EQ(index.put(to_bytes("a"), to_bytes("1")), std::optional<size_t>(3));
+    EXPECT_EQ(bytes(index.find(to_bytes("a"))->begin(), index.find(to_bytes("a"))->end()), to_bytes("1"));
+    EXPECT_EQ(index.put(to_bytes("a"), to_bytes("a longer value")), std::optional<size_t>(1));
+    auto val = index.find(to_bytes("a"));
+    EXPECT_EQ(bytes(val->begin(), val->end()), to_bytes("a longer value"));
+
+    EXPECT_EQ(index.erase(to_bytes("a")), std::optional<size_t>(14));
+    EXPECT_FALSE(index.contains(to_bytes("a")));
+    EXPECT_EQ(index.size(), 1u);
+
+    index.clear();
+    EXPECT_TRUE(index.empty());
+    EXPECT_EQ(index.memory_usage(), 0u);
+}
+
+/**
+ * @brief Drives a random mix of puts, overwrites and erases over a key
+ *        space large enough to force growth, tombstone rehashes and arena
+ *        compactions, comparing against a model after every phase.
+ */
+TEST(FlatIndexTest, MatchesModel) {
+    FlatIndex index;
+    std::map<bytes, bytes> model;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> key_dist(0, 20000), len_dist(0, 200), op_dist(0, 9);
+
+    for (int phase = 0; phase < 4; ++phase) {
+        for (int i = 0; i < 50000; ++i) {
+            auto key = to_bytes("key" + std::to_string(key_dist(rng)));
+            if (op_dist(rng) < 3) {
+                auto expected = model.contains(key) ? std::optional<size_t>(model[key].size()) : std::nullopt;
+                EXPECT_EQ(index.erase(key), expected);
+                model.erase(key);
+            } else {
+                bytes val(static_cast<size_t>(len_dist(rng)), std::byte(i & 0xFF));
+                auto expected = model.contains(key) ? std::optional<size_t>(model[key].size()) : std::nullopt;
+                EXPECT_EQ(index.put(key, val), expected);
+                model[key] = val;
+            }
+        }
+        expect_same(index, model);
+    }
+
+    // Moving keeps every entry and leaves the source empty
+    FlatIndex moved = std::move(index);
+    expect_same(moved, model);
+    EXPECT_TRUE(index.empty());
+    EXPECT_FALSE(index.contains(model.begin()->first));
+    index.put(to_bytes("reuse"), to_bytes("ok"));
+    EXPECT_TRUE(index.contains(to_bytes("reuse")));
+}
+
+/**
+ * @brief Verifies that garbage from relocated and erased records is
+ *        reclaimed, so churning the same keys keeps memory bounded.
+ */
+TEST(FlatIndexTest, ReclaimsGarbage) {
+    FlatIndex index;
+    for (int i = 0; i < 1000; ++i)
+        index.put(to_bytes("key" + std::to_string(i)), bytes(16, std::byte{'a'}));
+    const size_t baseline = index.memory_usage();
+
+    // Every round outgrows the previous record, so each put leaves garbage
+    for (size_t len = 17; len < 400; ++len)
+        for (int i = 0; i < 1000; ++i)
+            index.put(to_bytes("key" + std::to_string(i)), bytes(len, std::byte{'b'}));
+
+    EXPECT_EQ(index.size(), 1000u);
+    // Live data is ~400 KiB; without compaction the arena would hold ~80 MiB
+    EXPECT_LT(index.memory_usage(), baseline + 4 * 1024 * 1024);
+    auto val = index.find(to_bytes("key999"));
+    ASSERT_TRUE(val.has_value());
+    EXPECT_EQ(val->size(), 399u);
+}
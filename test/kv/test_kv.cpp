@@ -1,14 +1,20 @@
 // test/kv/test_kv.cpp
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
+#include <future>
 #include <sstream>
+#include <thread>
 #include "kv/kv.h"
+#include "kv/entry_codec.h"
+#include "kv/log_format.h"
 #include "test_utils.h"
 
 const std::string test_db = (std::filesystem::temp_directory_path() / "kvdb_test_db").string();
 
 TEST(KVTest, BasicOperations) {
-    std::filesystem::remove(test_db);
+    KeyValue::destroy(test_db);
 
     KeyValue kv(test_db);
     auto open_err = kv.open();
@@ -71,11 +77,11 @@ TEST(KVTest, BasicOperations) {
 
     ASSERT_FALSE(kv.close());
 
-    std::filesystem::remove(test_db);
+    KeyValue::destroy(test_db);
 }
 
 TEST(KVTest, UpdateMode) {
-    std::filesystem::remove(test_db);
+    KeyValue::destroy(test_db);
 
     KeyValue kv(test_db);
     auto open_err = kv.open();
@@ -111,13 +117,13 @@ TEST(KVTest, UpdateMode) {
 
     ASSERT_FALSE(kv.close());
 
-    std::filesystem::remove(test_db);
+    KeyValue::destroy(test_db);
 }
 
 TEST(KVTest, Recovery) {
     KeyValue kv(test_db);
     auto prepare = [&]() {
-        std::filesystem::remove(test_db);
+        KeyValue::destroy(test_db);
 
         auto open_err = kv.open();
         ASSERT_FALSE(open_err) << "Failed to open KV: " << open_err.message();
@@ -167,5 +173,730 @@ TEST(KVTest, Recovery) {
     }
     ASSERT_FALSE(kv.close());
 
-    std::filesystem::remove(test_db);
+    // -- Writes after a torn tail --
+    prepare();
+    {
+        auto size = std::filesystem::file_size(test_db);
+        std::filesystem::resize_file(test_db, size - 1);
+
+        ASSERT_FALSE(kv.open());
+        ASSERT_TRUE(kv.set(to_bytes("k3"), to_bytes("v3")).value());
+        ASSERT_FALSE(kv.close());
+
+        // The new record replaced the torn one instead of landing behind it
+        ASSERT_FALSE(kv.open());
+        EXPECT_EQ(kv.get(to_bytes("k1")).value(), to_bytes("v1"));
+        EXPECT_FALSE(kv.get(to_bytes("k2")).value());
+        EXPECT_EQ(kv.get(to_bytes("k3")).value(), to_bytes("v3"));
+    }
+    ASSERT_FALSE(kv.close());
+
+    KeyValue::destroy(test_db);
+}
+
+TEST(KVTest, SyncPolicies) {
+    using namespace std::chrono_literals;
+    const SyncPolicy policies[] = {
+        SyncPolicy::per_write(),
+        SyncPolicy::every(5ms),
+        SyncPolicy::every_bytes(64),
+        SyncPolicy::none(),
+    };
+
+    for (const auto &policy : policies) {
+        KeyValue::destroy(test_db);
+
+        KeyValue kv(test_db, { .sync_ = policy, .compaction_ = {} });
+        ASSERT_FALSE(kv.open());
+
+        for (int i = 0; i < 20; ++i) {
+            auto key = to_bytes("k" + std::to_string(i));
+            ASSERT_TRUE(kv.set(key, to_bytes("v" + std::to_string(i))).value());
+        }
+        ASSERT_TRUE(kv.del(to_bytes("k0")).value());
+        ASSERT_FALSE(kv.sync());
+
+        ASSERT_FALSE(kv.close());
+        ASSERT_FALSE(kv.open());
+
+        EXPECT_FALSE(kv.get(to_bytes("k0")).value());
+        auto val = kv.get(to_bytes("k19"));
+        ASSERT_TRUE(val.has_value() && val->has_value());
+        EXPECT_EQ(**val, to_bytes("v19"));
+
+        ASSERT_FALSE(kv.close());
+    }
+
+    KeyValue::destroy(test_db);
+}
+
+TEST(KVTest, WriteBatchAtomicity) {
+    KeyValue::destroy(test_db);
+
+    KeyValue kv(test_db);
+    ASSERT_FALSE(kv.open());
+    ASSERT_TRUE(kv.set(to_bytes("a"), to_bytes("old")).value());
+
+    WriteBatch batch;
+    batch.put(to_bytes("a"), to_bytes("new"));
+    batch.put(to_bytes("b"), to_bytes("vb"));
+    batch.del(to_bytes("a"));
+    batch.put(to_bytes("c"), to_bytes("vc"));
+    ASSERT_FALSE(kv.write(batch));
+
+    // Applied in order: the delete of "a" wins over the earlier put
+    EXPECT_FALSE(kv.get(to_bytes("a")).value());
+    EXPECT_EQ(kv.get(to_bytes("b")).value(), to_bytes("vb"));
+    EXPECT_EQ(kv.get(to_bytes("c")).value(), to_bytes("vc"));
+
+    // Survives a reopen
+    ASSERT_FALSE(kv.close());
+    ASSERT_FALSE(kv.open());
+    EXPECT_FALSE(kv.get(to_bytes("a")).value());
+    EXPECT_EQ(kv.get(to_bytes("c")).value(), to_bytes("vc"));
+    ASSERT_FALSE(kv.close());
+
+    // A torn batch at the tail is dropped as a whole
+    auto size = std::filesystem::file_size(test_db);
+    std::filesystem::resize_file(test_db, size - 1);
+    ASSERT_FALSE(kv.open());
+    EXPECT_EQ(kv.get(to_bytes("a")).value(), to_bytes("old"));
+    EXPECT_FALSE(kv.get(to_bytes("b")).value());
+    EXPECT_FALSE(kv.get(to_bytes("c")).value());
+    ASSERT_FALSE(kv.close());
+
+    // Oversized operations are rejected before anything is written
+    WriteBatch too_big;
+    too_big.put(to_bytes("ok"), to_bytes("v"));
+    too_big.put(bytes(EntryCodec::MAX_KEY_SIZE + 1), to_bytes("v"));
+    ASSERT_FALSE(kv.open());
+    EXPECT_EQ(kv.write(too_big), db_error::key_too_large);
+    EXPECT_FALSE(kv.get(to_bytes("ok")).value());
+    ASSERT_FALSE(kv.close());
+
+    KeyValue::destroy(test_db);
+}
+
+TEST(KVTest, Compaction) {
+    KeyValue::destroy(test_db);
+
+    KeyValue kv(test_db);
+    ASSERT_FALSE(kv.open());
+
+    // Lots of garbage: every key overwritten many times, half of them deleted
+    for (int round = 0; round < 20; ++round)
+        for (int i = 0; i < 10; ++i)
+            ASSERT_TRUE(kv.set(to_bytes("k" + std::to_string(i)), to_bytes("v" + std::to_string(round))).has_value());
+    for (int i = 0; i < 5; ++i)
+        ASSERT_TRUE(kv.del(to_bytes("k" + std::to_string(i))).value());
+
+    auto before = kv.stats().disk_bytes_;
+    ASSERT_FALSE(kv.compact());
+    auto after = kv.stats().disk_bytes_;
+    EXPECT_LT(after * 10, before);
+    // The old segment is gone; the compacted one and a fresh active one remain
+    EXPECT_FALSE(std::filesystem::exists(test_db));
+    EXPECT_EQ(kv.stats().segments_, 2u);
+
+    // The store keeps working on the new file
+    ASSERT_TRUE(kv.set(to_bytes("k0"), to_bytes("back")).value());
+
+    ASSERT_FALSE(kv.close());
+    ASSERT_FALSE(kv.open());
+
+    EXPECT_EQ(kv.get(to_bytes("k0")).value(), to_bytes("back"));
+    for (int i = 1; i < 5; ++i)
+        EXPECT_FALSE(kv.get(to_bytes("k" + std::to_string(i))).value());
+    for (int i = 5; i < 10; ++i)
+        EXPECT_EQ(kv.get(to_bytes("k" + std::to_string(i))).value(), to_bytes("v19"));
+
+    ASSERT_FALSE(kv.close());
+    KeyValue::destroy(test_db);
+}
+
+TEST(KVTest, AutoCompaction) {
+    KeyValue::destroy(test_db);
+
+    KVOptions opts{
+        .sync_         = SyncPolicy::none(),
+        .compaction_   = { .enabled_ = true, .dead_ratio_ = 0.5, .min_dead_bytes_ = 4096, .max_dead_bytes_ = 0 },
+        .segment_size_ = 4096,
+    };
+    KeyValue kv(test_db, opts);
+    ASSERT_FALSE(kv.open());
+
+    // Overwrites make garbage; foreground writes keep going while the
+    // compactor runs in the background
+    for (int round = 0; round < 200; ++round)
+        for (int i = 0; i < 10; ++i)
+            ASSERT_TRUE(kv.set(to_bytes("k" + std::to_string(i)), to_bytes("v" + std::to_string(round))).has_value());
+
+    for (int i = 0; i < 500 && kv.stats().compactions_ == 0; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    // Closing stops the compactor, so the file and the counters hold still
+    ASSERT_FALSE(kv.close());
+    auto stats = kv.stats();
+    EXPECT_GT(stats.compactions_, 0u);
+    EXPECT_FALSE(stats.compaction_error_);
+    // Without batches the counters account for every byte after the segment headers
+    EXPECT_EQ(stats.disk_bytes_, stats.segments_ * log_format::HEADER_SIZE + stats.live_bytes_ + stats.dead_bytes_);
+    // ...and the garbage of at least one run is gone (every overwritten record is >= 17 bytes)
+    EXPECT_LT(stats.dead_bytes_, 199u * 10 * (EntryCodec::HEADER_SIZE + 4));
+
+    ASSERT_FALSE(kv.open());
+    for (int i = 0; i < 10; ++i)
+        EXPECT_EQ(kv.get(to_bytes("k" + std::to_string(i))).value(), to_bytes("v199"));
+
+    // A manual policy never compacts on its own
+    ASSERT_FALSE(kv.close());
+    KeyValue manual(test_db, { .sync_ = {}, .compaction_ = CompactionPolicy::manual() });
+    ASSERT_FALSE(manual.open());
+    for (int round = 0; round < 50; ++round)
+        ASSERT_TRUE(manual.set(to_bytes("k0"), to_bytes("m" + std::to_string(round))).has_value());
+    EXPECT_GT(manual.stats().dead_bytes_, 0u);
+    EXPECT_EQ(manual.stats().compactions_, 0u);
+
+    ASSERT_FALSE(manual.close());
+    KeyValue::destroy(test_db);
+}
+
+TEST(KVTest, ParallelReplay) {
+    KeyValue::destroy(test_db);
+
+    KVOptions opts{
+        .sync_         = SyncPolicy::none(),
+        .compaction_   = CompactionPolicy::manual(),
+        .segment_size_ = 4096,
+    };
+    {
+        KeyValue kv(test_db, opts);
+        ASSERT_FALSE(kv.open());
+        for (int round = 0; round < 5; ++round) {
+            for (int i = 0; i < 200; ++i) {
+                auto key = to_bytes("k" + std::to_string(i));
+                if ((i + round) % 7 == 0) ASSERT_TRUE(kv.del(key).has_value());
+                else ASSERT_TRUE(kv.set(key, to_bytes("v" + std::to_string(round))).has_value());
+            }
+            WriteBatch batch;
+            batch.put(to_bytes("k3"), to_bytes("batch" + std::to_string(round)));
+            batch.del(to_bytes("k4"));
+            ASSERT_FALSE(kv.write(batch));
+        }
+        ASSERT_FALSE(kv.close());
+    }
+
+    // Last writer wins and tombstones hold exactly as in a sequential replay
+    opts.replay_threads_ = 1;
+    KeyValue sequential(test_db, opts);
+    ASSERT_FALSE(sequential.open());
+    opts.replay_threads_ = 4;
+    KeyValue parallel(test_db, opts);
+    ASSERT_FALSE(parallel.open());
+    ASSERT_GT(parallel.stats().segments_, 4u);
+
+    for (int i = 0; i < 200; ++i) {
+        auto key = to_bytes("k" + std::to_string(i));
+        EXPECT_EQ(parallel.get(key).value(), sequential.get(key).value()) << "key k" << i;
+    }
+    EXPECT_EQ(parallel.get(to_bytes("k3")).value(), to_bytes("batch4"));
+    EXPECT_FALSE(parallel.get(to_bytes("k4")).value().has_value());
+    EXPECT_EQ(parallel.stats().live_bytes_, sequential.stats().live_bytes_);
+    EXPECT_EQ(parallel.stats().dead_bytes_, sequential.stats().dead_bytes_);
+
+    ASSERT_FALSE(parallel.close());
+    ASSERT_FALSE(sequential.close());
+    KeyValue::destroy(test_db);
+}
+
+TEST(KVTest, Checkpoint) {
+    KeyValue::destroy(test_db);
+
+    KVOptions opts{
+        .sync_         = SyncPolicy::none(),
+        .compaction_   = CompactionPolicy::manual(),
+        .segment_size_ = 4096,
+    };
+    KeyValue kv(test_db, opts);
+    ASSERT_FALSE(kv.open());
+    for (int round = 0; round < 3; ++round)
+        for (int i = 0; i < 100; ++i)
+            ASSERT_TRUE(kv.set(to_bytes("k" + std::to_string(i)), to_bytes("v" + std::to_string(round))).has_value());
+    ASSERT_FALSE(kv.checkpoint());
+
+    // Records after the checkpoint are replayed on top of it
+    ASSERT_TRUE(kv.set(to_bytes("k0"), to_bytes("after")).value());
+    ASSERT_TRUE(kv.del(to_bytes("k1")).value());
+    WriteBatch batch;
+    batch.put(to_bytes("k2"), to_bytes("batch"));
+    ASSERT_FALSE(kv.write(batch));
+    auto before = kv.stats();
+    ASSERT_FALSE(kv.close());
+
+    // Damage a record the checkpoint covers: open never reads it
+    {
+        std::fstream fs(test_db, std::ios::in | std::ios::out | std::ios::binary);
+        fs.seekp(log_format::HEADER_SIZE + EntryCodec::HEADER_SIZE);
+        fs.put('X');
+    }
+    for (unsigned threads : { 1u, 4u }) {
+        opts.replay_threads_ = threads;
+        KeyValue loaded(test_db, opts);
+        ASSERT_FALSE(loaded.open()) << "threads " << threads;
+        EXPECT_EQ(loaded.get(to_bytes("k0")).value(), to_bytes("after"));
+        EXPECT_FALSE(loaded.get(to_bytes("k1")).value().has_value());
+        EXPECT_EQ(loaded.get(to_bytes("k2")).value(), to_bytes("batch"));
+        for (int i = 3; i < 100; ++i)
+            EXPECT_EQ(loaded.get(to_bytes("k" + std::to_string(i))).value(), to_bytes("v2"));
+        EXPECT_EQ(loaded.stats().live_bytes_, before.live_bytes_);
+        EXPECT_EQ(loaded.stats().dead_bytes_, before.dead_bytes_);
+        ASSERT_FALSE(loaded.close());
+    }
+
+    // A damaged checkpoint is ignored, so the full replay hits the bad record
+    {
+        std::fstream fs(test_db + ".checkpoint", std::ios::in | std::ios::out | std::ios::binary);
+        fs.seekp(-1, std::ios::end);
+        fs.put('\0');
+    }
+    EXPECT_EQ(kv.open(), make_error_code(db_error::bad_checksum));
+    kv.close();
+
+    // Compaction rewrites the segments a checkpoint points into and drops it
+    KeyValue::destroy(test_db);
+    ASSERT_FALSE(kv.open());
+    ASSERT_TRUE(kv.set(to_bytes("k0"), to_bytes("v0")).value());
+    ASSERT_FALSE(kv.checkpoint());
+    ASSERT_TRUE(std::filesystem::exists(test_db + ".checkpoint"));
+    ASSERT_FALSE(kv.compact());
+    EXPECT_FALSE(std::filesystem::exists(test_db + ".checkpoint"));
+    ASSERT_FALSE(kv.close());
+    ASSERT_FALSE(kv.open());
+    EXPECT_EQ(kv.get(to_bytes("k0")).value(), to_bytes("v0"));
+
+    ASSERT_FALSE(kv.close());
+    KeyValue::destroy(test_db);
+    EXPECT_FALSE(std::filesystem::exists(test_db + ".checkpoint"));
+}
+
+TEST(KVTest, DiskValues) {
+    KeyValue::destroy(test_db);
+
+    KVOptions opts{
+        .sync_         = SyncPolicy::none(),
+        .compaction_   = CompactionPolicy::manual(),
+        .segment_size_ = 4096,
+        .values_       = ValueStorage::Disk,
+    };
+    KeyValue kv(test_db, opts);
+    ASSERT_FALSE(kv.open());
+
+    for (int round = 0; round < 3; ++round)
+        for (int i = 0; i < 100; ++i)
+            ASSERT_TRUE(kv.set(to_bytes("k" + std::to_string(i)), to_bytes("v" + std::to_string(round))).has_value());
+    WriteBatch batch;
+    batch.put(to_bytes("k1"), to_bytes("batch"));
+    batch.del(to_bytes("k2"));
+    batch.put(to_bytes("k3"), to_bytes("batch3"));
+    ASSERT_FALSE(kv.write(batch));
+    ASSERT_TRUE(kv.del(to_bytes("k4")).value());
+
+    // Equal-length values are compared against the copy on disk
+    EXPECT_FALSE(kv.set(to_bytes("k5"), to_bytes("v2")).value());
+    EXPECT_TRUE(kv.set(to_bytes("k5"), to_bytes("v3")).value());
+    EXPECT_FALSE(kv.set_ex(to_bytes("k6"), to_bytes("v2"), KeyValue::WriteMode::Update).value());
+    EXPECT_FALSE(kv.set_ex(to_bytes("k6"), to_bytes("x"), KeyValue::WriteMode::Insert).value());
+
+    auto check = [](KeyValue &store) {
+        EXPECT_EQ(store.get(to_bytes("k0")).value(), to_bytes("v2"));
+        EXPECT_EQ(store.get(to_bytes("k1")).value(), to_bytes("batch"));
+        EXPECT_FALSE(store.get(to_bytes("k2")).value().has_value());
+        EXPECT_EQ(store.get(to_bytes("k3")).value(), to_bytes("batch3"));
+        EXPECT_FALSE(store.get(to_bytes("k4")).value().has_value());
+        EXPECT_EQ(store.get(to_bytes("k5")).value(), to_bytes("v3"));
+        for (int i = 6; i < 100; ++i)
+            EXPECT_EQ(store.get(to_bytes("k" + std::to_string(i))).value(), to_bytes("v2"));
+    };
+    check(kv);
+    EXPECT_EQ(kv.checkpoint(), std::make_error_code(std::errc::operation_not_supported));
+
+    // Replay rebuilds the same locations and counters as the writes did
+    auto before = kv.stats();
+    ASSERT_FALSE(kv.close());
+    ASSERT_FALSE(kv.open());
+    check(kv);
+    EXPECT_EQ(kv.stats().live_bytes_, before.live_bytes_);
+    EXPECT_EQ(kv.stats().dead_bytes_, before.dead_bytes_);
+
+    // Compaction moves every reference into the rewritten segments
+    ASSERT_FALSE(kv.compact());
+    check(kv);
+    ASSERT_TRUE(kv.set(to_bytes("k0"), to_bytes("after")).value());
+    ASSERT_FALSE(kv.close());
+    ASSERT_FALSE(kv.open());
+    EXPECT_EQ(kv.get(to_bytes("k0")).value(), to_bytes("after"));
+    EXPECT_EQ(kv.get(to_bytes("k99")).value(), to_bytes("v2"));
+
+    // The same files open in the default mode too
+    ASSERT_FALSE(kv.close());
+    KeyValue memory(test_db, { .sync_ = SyncPolicy::none(), .compaction_ = CompactionPolicy::manual() });
+    ASSERT_FALSE(memory.open());
+    EXPECT_EQ(memory.get(to_bytes("k0")).value(), to_bytes("after"));
+    EXPECT_EQ(memory.get(to_bytes("k1")).value(), to_bytes("batch"));
+
+    ASSERT_FALSE(memory.close());
+    KeyValue::destroy(test_db);
+}
+
+TEST(KVTest, GetIntoBuffer) {
+    for (auto values : { ValueStorage::Memory, ValueStorage::Disk }) {
+        KeyValue::destroy(test_db);
+        KeyValue kv(test_db, { .sync_ = SyncPolicy::none(), .compaction_ = CompactionPolicy::manual(),
+                               .values_ = values });
+        ASSERT_FALSE(kv.open());
+        ASSERT_TRUE(kv.set(to_bytes("long"), to_bytes(std::string(200, 'l'))).value());
+        ASSERT_TRUE(kv.set(to_bytes("short"), to_bytes("s")).value());
+
+        bytes out = to_bytes("untouched");
+        EXPECT_FALSE(kv.get(to_bytes("missing"), out).value());
+        EXPECT_EQ(out, to_bytes("untouched"));
+
+        ASSERT_TRUE(kv.get(to_bytes("long"), out).value());
+        EXPECT_EQ(out, to_bytes(std::string(200, 'l')));
+
+        // A smaller value lands in the same buffer
+        const std::byte *buffer = out.data();
+        ASSERT_TRUE(kv.get(to_bytes("short"), out).value());
+        EXPECT_EQ(out, to_bytes("s"));
+        EXPECT_EQ(out.data(), buffer);
+
+        // Writes take the caller's spans as they are; the index keeps its own copy
+        bytes key = to_bytes("k"), val = to_bytes("first");
+        ASSERT_TRUE(kv.set(key, val).value());
+        val = to_bytes("xxxxx");
+        EXPECT_EQ(kv.get(key).value(), to_bytes("first"));
+        EXPECT_TRUE(kv.del(key).value());
+        EXPECT_FALSE(kv.get(key, out).value());
+
+        ASSERT_FALSE(kv.close());
+    }
+    KeyValue::destroy(test_db);
+}
+
+TEST(KVTest, GetView) {
+    for (auto values : { ValueStorage::Memory, ValueStorage::Disk }) {
+        KeyValue::destroy(test_db);
+        KeyValue kv(test_db, { .sync_ = SyncPolicy::none(), .compaction_ = CompactionPolicy::manual(),
+                               .values_ = values });
+        ASSERT_FALSE(kv.open());
+        const bytes big(1024 * 1024, std::byte{'b'});
+        ASSERT_TRUE(kv.set(to_bytes("big"), big).value());
+
+        bool called = false;
+        auto found = kv.get_view(to_bytes("big"), [&](std::span<const std::byte> val) {
+            called = true;
+            EXPECT_TRUE(std::ranges::equal(val, big));
+            return std::error_code{};
+        });
+        ASSERT_TRUE(found.has_value());
+        EXPECT_TRUE(found.value());
+        EXPECT_TRUE(called);
+
+        // Absent keys never reach the callback
+        called = false;
+        found = kv.get_view(to_bytes("missing"), [&](std::span<const std::byte>) {
+            called = true;
+            return std::error_code{};
+        });
+        EXPECT_FALSE(found.value());
+        EXPECT_FALSE(called);
+
+        // The callback's error comes back as the result
+        found = kv.get_view(to_bytes("big"), [](std::span<const std::byte>) {
+            return make_error_code(db_error::trailing_garbage);
+        });
+        ASSERT_FALSE(found.has_value());
+        EXPECT_EQ(found.error(), db_error::trailing_garbage);
+
+        ASSERT_FALSE(kv.close());
+    }
+    KeyValue::destroy(test_db);
+}
+
+TEST(KVTest, Scan) {
+    auto collect = [](KeyValue::Cursor cursor) {
+        std::vector<std::pair<std::string, std::string>> out;
+        for (; cursor.valid(); cursor.next())
+            out.emplace_back(std::string(reinterpret_cast<const char *>(cursor.key().data()), cursor.key().size()),
+                             std::string(reinterpret_cast<const char *>(cursor.value().data()), cursor.value().size()));
+        EXPECT_FALSE(cursor.error());
+        return out;
+    };
+    auto keys = [](const std::vector<std::pair<std::string, std::string>> &entries) {
+        std::vector<std::string> out;
+        for (const auto &[key, val] : entries) out.push_back(key);
+        return out;
+    };
+
+    for (auto values : { ValueStorage::Memory, ValueStorage::Disk }) {
+        KeyValue::destroy(test_db);
+        KeyValue kv(test_db, { .sync_ = SyncPolicy::none(), .compaction_ = CompactionPolicy::manual(),
+                               .values_ = values });
+        ASSERT_FALSE(kv.open());
+        // Enough keys to span several cursor batches
+        for (int i = 0; i < 300; ++i) {
+            const std::string digits = std::to_string(i);
+            const std::string key = "k" + std::string(3 - digits.size(), '0') + digits;
+            ASSERT_TRUE(kv.set(to_bytes(key), to_bytes("v" + std::to_string(i))).value());
+        }
+        ASSERT_TRUE(kv.set(to_bytes("k"), to_bytes("prefix itself")).value());
+        ASSERT_TRUE(kv.set(to_bytes("j"), to_bytes("before")).value());
+        ASSERT_TRUE(kv.set(to_bytes("l"), to_bytes("after")).value());
+        ASSERT_TRUE(kv.del(to_bytes("k150")).value());
+        ASSERT_TRUE(kv.set(to_bytes("k010"), to_bytes("overwritten")).value());
+
+        auto all = collect(kv.scan(bytes{}, std::nullopt));
+        ASSERT_EQ(all.size(), 302u);
+        EXPECT_EQ(all.front().first, "j");
+        EXPECT_EQ(all[1].first, "k");
+        EXPECT_EQ(all[2], std::make_pair(std::string("k000"), std::string("v0")));
+        EXPECT_EQ(all[12].second, "overwritten");
+        EXPECT_EQ(all.back().first, "l");
+        EXPECT_TRUE(std::ranges::is_sorted(keys(all)));
+
+        // Lower bound inclusive, upper exclusive; the deleted key is skipped
+        auto range = keys(collect(kv.scan(to_bytes("k148"), to_bytes("k152"))));
+        EXPECT_EQ(range, (std::vector<std::string>{ "k148", "k149", "k151" }));
+        auto reverse = keys(collect(kv.scan(to_bytes("k148"), to_bytes("k152"), { .reverse_ = true })));
+        EXPECT_EQ(reverse, (std::vector<std::string>{ "k151", "k149", "k148" }));
+
+        auto prefix = collect(kv.scan_prefix(to_bytes("k")));
+        EXPECT_EQ(prefix.size(), 300u);
+        EXPECT_EQ(prefix.front().first, "k");
+        EXPECT_EQ(prefix.back().first, "k299");
+        EXPECT_EQ(collect(kv.scan_prefix(to_bytes("k29"))).size(), 10u);
+        EXPECT_TRUE(collect(kv.scan_prefix(to_bytes("m"))).empty());
+
+        // Limits cut across batch boundaries, both ways
+        auto limited = keys(collect(kv.scan_prefix(to_bytes("k"), { .limit_ = 70 })));
+        ASSERT_EQ(limited.size(), 70u);
+        EXPECT_EQ(limited.back(), "k068");
+        auto last = keys(collect(kv.scan_prefix(to_bytes("k"), { .reverse_ = true, .limit_ = 2 })));
+        EXPECT_EQ(last, (std::vector<std::string>{ "k299", "k298" }));
+
+        // Writes between batches show up if they lie ahead of the cursor
+        auto cursor = kv.scan_prefix(to_bytes("k2"));
+        ASSERT_TRUE(cursor.valid());
+        ASSERT_TRUE(kv.del(to_bytes("k290")).value());
+        ASSERT_TRUE(kv.set(to_bytes("k2999"), to_bytes("new")).value());
+        auto rest = keys(collect(std::move(cursor)));
+        EXPECT_EQ(rest.back(), "k2999");
+        EXPECT_EQ(std::ranges::count(rest, std::string("k290")), 0);
+
+        // The order is rebuilt on open
+        ASSERT_FALSE(kv.close());
+        ASSERT_FALSE(kv.open());
+        EXPECT_EQ(keys(collect(kv.scan(to_bytes("k148"), to_bytes("k152")))), range);
+        EXPECT_EQ(collect(kv.scan_prefix(to_bytes("k29"))).size(), 10u);
+        ASSERT_FALSE(kv.close());
+    }
+
+    // Without the ordered index scans are refused
+    KeyValue::destroy(test_db);
+    KeyValue unordered(test_db, { .sync_ = SyncPolicy::none(), .compaction_ = CompactionPolicy::manual(),
+                                  .ordered_ = false });
+    ASSERT_FALSE(unordered.open());
+    ASSERT_TRUE(unordered.set(to_bytes("a"), to_bytes("1")).value());
+    auto cursor = unordered.scan(bytes{}, std::nullopt);
+    EXPECT_FALSE(cursor.valid());
+    EXPECT_EQ(cursor.error(), std::make_error_code(std::errc::operation_not_supported));
+    ASSERT_FALSE(unordered.close());
+    KeyValue::destroy(test_db);
+}
+
+TEST(KVTest, ReadModifyWrite) {
+    for (auto values : { ValueStorage::Memory, ValueStorage::Disk }) {
+        KeyValue::destroy(test_db);
+        KeyValue kv(test_db, { .sync_ = SyncPolicy::none(), .compaction_ = CompactionPolicy::manual(),
+                               .values_ = values });
+        ASSERT_FALSE(kv.open());
+
+        // Increments the decimal counter under "n", mirroring it into "copy"
+        auto increment = [&kv] {
+            return kv.read_modify_write(to_bytes("n"), [](std::optional<std::span<const std::byte>> old,
+                                                          WriteBatch &batch) {
+                int n = 0;
+                if (old.has_value()) n = std::stoi(std::string(reinterpret_cast<const char *>(old->data()), old->size()));
+                batch.put(to_bytes("n"), to_bytes(std::to_string(n + 1)));
+                batch.put(to_bytes("copy"), to_bytes(std::to_string(n + 1)));
+                return std::error_code{};
+            });
+        };
+        ASSERT_TRUE(increment().value());
+        EXPECT_EQ(kv.get(to_bytes("n")).value(), to_bytes("1"));
+
+        // An empty batch writes nothing; an error aborts the write
+        auto untouched = kv.read_modify_write(to_bytes("n"), [](auto old, WriteBatch &) {
+            EXPECT_TRUE(old.has_value());
+            return std::error_code{};
+        });
+        EXPECT_FALSE(untouched.value());
+        auto failed = kv.read_modify_write(to_bytes("n"), [](auto, WriteBatch &batch) {
+            batch.put(to_bytes("n"), to_bytes("lost"));
+            return make_error_code(db_error::type_mismatch);
+        });
+        EXPECT_EQ(failed.error(), db_error::type_mismatch);
+        EXPECT_EQ(kv.get(to_bytes("n")).value(), to_bytes("1"));
+
+        // Concurrent read-modify-writes never lose an update
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back([&] { for (int i = 0; i < 50; ++i) ASSERT_TRUE(increment().has_value()); });
+        for (auto &thread : threads) thread.join();
+        EXPECT_EQ(kv.get(to_bytes("n")).value(), to_bytes("201"));
+        EXPECT_EQ(kv.get(to_bytes("copy")).value(), to_bytes("201"));
+
+        ASSERT_FALSE(kv.close());
+        ASSERT_FALSE(kv.open());
+        EXPECT_EQ(kv.get(to_bytes("n")).value(), to_bytes("201"));
+        ASSERT_FALSE(kv.close());
+    }
+    KeyValue::destroy(test_db);
+}
+
+/**
+ * @brief Verifies that writers on disjoint keys, readers and compactions
+ *        can run at once: every read sees a whole value written for its
+ *        key, and the final state survives a reopen.
+ */
+TEST(KVTest, ConcurrentAccess) {
+    for (auto values : { ValueStorage::Memory, ValueStorage::Disk }) {
+        KeyValue::destroy(test_db);
+        KeyValue kv(test_db, { .sync_ = SyncPolicy::none(), .compaction_ = CompactionPolicy::manual(),
+                               .values_ = values });
+        ASSERT_FALSE(kv.open());
+
+        constexpr int WRITERS = 4;
+        constexpr int KEYS    = 50;
+        constexpr int ROUNDS  = 20;
+        auto key_of = [](int t, int k) { return to_bytes("w" + std::to_string(t) + "." + std::to_string(k)); };
+        auto val_of = [](int t, int k, int r) {
+            return to_bytes("w" + std::to_string(t) + "." + std::to_string(k) + "=" + std::to_string(r));
+        };
+
+        std::atomic<bool> done{ false };
+        std::vector<std::thread> threads;
+        for (int t = 0; t < WRITERS; ++t) {
+            threads.emplace_back([&, t] {
+                for (int r = 0; r < ROUNDS; ++r) {
+                    for (int k = 0; k < KEYS; ++k) {
+                        if (k % 5 == 0) {
+                            WriteBatch batch;
+                            batch.put(key_of(t, k), val_of(t, k, r));
+                            batch.put(key_of(t, k + 1), val_of(t, k + 1, r));
+                            ASSERT_FALSE(kv.write(batch));
+                            ++k;
+                        } else if (k % 7 == 0 && r % 2 == 1) {
+                            ASSERT_TRUE(kv.del(key_of(t, k)).has_value());
+                        } else {
+                            ASSERT_TRUE(kv.set(key_of(t, k), val_of(t, k, r)).has_value());
+                        }
+                    }
+                }
+            });
+        }
+        for (int t = 0; t < 2; ++t) {
+            threads.emplace_back([&, t] {
+                bytes out;
+                while (!done) {
+                    for (int k = 0; k < KEYS; ++k) {
+                        const auto key = key_of(t, k);
+                        auto found = kv.get(key, out);
+                        ASSERT_TRUE(found.has_value());
+                        // A value is always the key, '=' and a round number
+                        if (found.value()) {
+                            ASSERT_GT(out.size(), key.size());
+                            ASSERT_TRUE(std::equal(key.begin(), key.end(), out.begin()));
+                            ASSERT_EQ(out[key.size()], std::byte{ '=' });
+                        }
+                    }
+                }
+            });
+        }
+        threads.emplace_back([&] {
+            while (!done) ASSERT_FALSE(kv.compact());
+        });
+        for (int t = 0; t < WRITERS; ++t) threads[t].join();
+        done = true;
+        for (size_t t = WRITERS; t < threads.size(); ++t) threads[t].join();
+
+        auto check = [&] {
+            for (int t = 0; t < WRITERS; ++t) {
+                for (int k = 0; k < KEYS; ++k) {
+                    auto got = kv.get(key_of(t, k));
+                    ASSERT_TRUE(got.has_value());
+                    // Odd rounds delete the keys that even rounds set, and the last round is odd
+                    if (k % 7 == 0 && (k - 1) % 5 != 0 && k % 5 != 0) EXPECT_FALSE(got.value().has_value()) << k;
+                    else EXPECT_EQ(got.value(), val_of(t, k, ROUNDS - 1)) << k;
+                }
+            }
+        };
+        check();
+        ASSERT_FALSE(kv.close());
+        ASSERT_FALSE(kv.open());
+        check();
+        ASSERT_FALSE(kv.close());
+    }
+    KeyValue::destroy(test_db);
+}
+
+/**
+ * @brief Verifies that reads finish while a checkpoint or compaction is
+ *        stuck inside the log's sync, with every stripe held.
+ *
+ * @ref SyncPolicy::on_sync_ stands in for a slow `fsync`: once armed, it
+ * holds the checkpoint (in-memory values) or compaction (disk values)
+ * inside its sync until the reads are done.
+ */
+TEST(KVTest, ReadsDuringSeal) {
+    for (auto values : { ValueStorage::Memory, ValueStorage::Disk }) {
+        std::atomic<bool> armed{ false };
+        std::promise<void> entered, release;
+        auto released = release.get_future().share();
+
+        auto policy = SyncPolicy::none();
+        policy.on_sync_ = [&] {
+            if (!armed.exchange(false)) return;
+            entered.set_value();
+            released.wait();
+        };
+
+        KeyValue::destroy(test_db);
+        KeyValue kv(test_db, { .sync_ = policy, .compaction_ = CompactionPolicy::manual(), .values_ = values });
+        ASSERT_FALSE(kv.open());
+        for (int i = 0; i < 100; ++i)
+            ASSERT_TRUE(kv.set(to_bytes("k" + std::to_string(i)), to_bytes("v" + std::to_string(i))).value());
+
+        armed = true;
+        std::thread background([&] {
+            EXPECT_FALSE(values == ValueStorage::Memory ? kv.checkpoint() : kv.compact());
+        });
+        entered.get_future().wait();
+
+        auto reads = std::async(std::launch::async, [&] {
+            size_t seen = 0;
+            for (auto cursor = kv.scan_prefix(to_bytes("k")); cursor.valid(); cursor.next()) ++seen;
+            EXPECT_EQ(seen, 100u);
+            EXPECT_EQ(kv.get(to_bytes("k7")).value(), to_bytes("v7"));
+            EXPECT_EQ(kv.stats().compactions_, 0u);
+        });
+        EXPECT_EQ(reads.wait_for(std::chrono::seconds(10)), std::future_status::ready)
+            << (values == ValueStorage::Memory ? "checkpoint" : "compaction") << " blocked readers";
+
+        release.set_value();
+        background.join();
+        reads.get();
+        ASSERT_FALSE(kv.close());
+    }
+    KeyValue::destroy(test_db);
 }
@@ -0,0 +1,578 @@
+// test/kv/test_log.cpp
+
+/**
+ * @file test_log.cpp
+ * @brief Unit tests for @ref Log append and replay behaviour.
+ *
+ * Covers: concurrent group-committed writes, segment rolling, the
+ * manifest codec, compaction, preallocation, zeroed holes, mapped replay,
+ * positional value reads and hint files.
+ */
+
+#include <gtest/gtest.h>
+#include <filesystem>       // std::filesystem::remove, temp_directory_path, resize_file
+#include <thread>           // std::thread
+#include <vector>           // std::vector
+#include <string>           // std::string, std::to_string
+#include <set>              // std::set
+#include <fstream>          // std::ofstream, std::fstream
+#include <tuple>            // std::tuple
+#include <algorithm>        // std::all_of
+#include <chrono>           // std::chrono::milliseconds
+#include "kv/log.h"
+#include "test_utils.h"     // to_bytes
+
+/// Temporary log file used by every test in this translation unit.
+const std::string test_log = (std::filesystem::temp_directory_path() / "kvdb_log_test").string();
+
+/**
+ * @brief Replays every entry of @p log from the first entry onwards.
+ * @param log An open log.
+ * @return All decoded entries in log order, batches flattened.
+ */
+static std::vector<Entry> read_all(Log &log) {
+    std::vector<Entry> out;
+    EXPECT_FALSE(log.seek_to_first_entry());
+    while (true) {
+        auto result = log.read();
+        EXPECT_TRUE(result.has_value());
+        if (!result.has_value() || std::holds_alternative<LogEOF>(result.value())) break;
+        if (auto *batch = std::get_if<WriteBatch>(&result.value()))
+            out.insert(out.end(), batch->entries().begin(), batch->entries().end());
+        else
+            out.push_back(std::move(std::get<Entry>(result.value())));
+    }
+    return out;
+}
+
+/**
+ * @brief Writes from many threads at once and verifies that every record
+ *        lands in the log exactly once and intact.
+ */
+TEST(LogTest, ConcurrentGroupCommit) {
+    Log::destroy(test_log);
+
+    constexpr int THREADS = 8;
+    constexpr int PER_THREAD = 50;
+
+    {
+        Log log(test_log);
+        ASSERT_FALSE(log.open());
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&log, t] {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    auto key = to_bytes("k" + std::to_string(t) + "_" + std::to_string(i));
+                    EXPECT_FALSE(log.write(Entry(key, to_bytes("v"), false)));
+                }
+            });
+        }
+        for (auto &th : threads) th.join();
+        ASSERT_FALSE(log.close());
+    }
+
+    Log log(test_log);
+    ASSERT_FALSE(log.open());
+    auto entries = read_all(log);
+    ASSERT_EQ(entries.size(), static_cast<size_t>(THREADS * PER_THREAD));
+
+    std::set<bytes> keys;
+    for (const auto &ent : entries) keys.insert(ent.key_);
+    EXPECT_EQ(keys.size(), entries.size());
+
+    ASSERT_FALSE(log.close());
+    Log::destroy(test_log);
+}
+
+/**
+ * @brief Fills several small segments and checks that the manifest lists
+ *        them in order, that replay crosses every segment boundary, and
+ *        that stray segment files are cleaned up on open.
+ */
+TEST(LogTest, SegmentRoll) {
+    Log::destroy(test_log);
+
+    constexpr int COUNT = 100;
+    {
+        Log log(test_log, {}, 256);
+        ASSERT_FALSE(log.open());
+        for (int i = 0; i < COUNT; ++i)
+            ASSERT_FALSE(log.write(Entry(to_bytes("key" + std::to_string(i)), to_bytes("value"), false)));
+
+        auto segments = log.segments();
+        ASSERT_GT(segments.size(), 5u);
+        EXPECT_EQ(segments.front(), 0u);
+        for (uint64_t id : segments) {
+            EXPECT_TRUE(std::filesystem::exists(log.segment_path(id)));
+            EXPECT_LE(std::filesystem::file_size(log.segment_path(id)), 256u);
+        }
+        EXPECT_TRUE(std::filesystem::exists(test_log + ".manifest"));
+        ASSERT_FALSE(log.close());
+    }
+
+    // A segment a crashed roll never recorded in the manifest
+    {
+        std::ofstream stray(test_log + ".9999", std::ios::binary);
+        stray << "garbage";
+    }
+
+    Log log(test_log, {}, 256);
+    ASSERT_FALSE(log.open());
+    EXPECT_FALSE(std::filesystem::exists(test_log + ".9999"));
+
+    auto entries = read_all(log);
+    ASSERT_EQ(entries.size(), static_cast<size_t>(COUNT));
+    for (int i = 0; i < COUNT; ++i)
+        EXPECT_EQ(entries[i].key_, to_bytes("key" + std::to_string(i)));
+
+    ASSERT_FALSE(log.close());
+    ASSERT_FALSE(Log::destroy(test_log));
+    EXPECT_FALSE(std::filesystem::exists(test_log));
+    EXPECT_FALSE(std::filesystem::exists(test_log + ".manifest"));
+}
+
+/**
+ * @brief Round-trips a manifest and checks that damage is detected.
+ */
+TEST(LogTest, ManifestEncodeDecode) {
+    Manifest m{ { 7, 3, 12 }, 13 };
+    auto data = m.encode();
+
+    auto decoded = Manifest::decode(data);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded.value(), m);
+
+    data[10] ^= std::byte{0x01};
+    EXPECT_EQ(Manifest::decode(data).error(), db_error::bad_manifest);
+    EXPECT_EQ(Manifest::decode(std::span(data).first(8)).error(), db_error::bad_manifest);
+}
+
+/**
+ * @brief Verifies that @ref Log::compact replaces only the sealed segments,
+ *        keeping records written while the live set is being produced.
+ */
+TEST(LogTest, CompactKeepsLateWrites) {
+    Log::destroy(test_log);
+
+    Log log(test_log);
+    ASSERT_FALSE(log.open());
+    ASSERT_FALSE(log.write(Entry(to_bytes("a"), to_bytes("1"), false)));
+    ASSERT_FALSE(log.write(Entry(to_bytes("a"), to_bytes("2"), false)));
+
+    auto keep_from = log.seal();
+    ASSERT_TRUE(keep_from.has_value());
+    EXPECT_EQ(log.segments().size(), 2u);
+
+    auto err = log.compact(keep_from.value(), [&](const Log::Emit &emit) -> std::error_code {
+        // Arrives while the snapshot is being written
+        EXPECT_FALSE(log.write(Entry(to_bytes("b"), to_bytes("late"), false)));
+        return emit(to_bytes("a"), to_bytes("2"));
+    });
+    ASSERT_FALSE(err);
+    EXPECT_FALSE(std::filesystem::exists(test_log));
+
+    // Appends after the swap land in the active segment
+    ASSERT_FALSE(log.write(Entry(to_bytes("c"), {}, true)));
+
+    auto entries = read_all(log);
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_EQ(entries[0], Entry(to_bytes("a"), to_bytes("2"), false));
+    EXPECT_EQ(entries[1], Entry(to_bytes("b"), to_bytes("late"), false));
+    EXPECT_EQ(entries[2], Entry(to_bytes("c"), {}, true));
+
+    ASSERT_FALSE(log.close());
+    Log::destroy(test_log);
+}
+
+/**
+ * @brief Checks that the active segment is preallocated while open and
+ *        trimmed on close, and that a log left untrimmed by a crash reopens
+ *        at the end of its records.
+ */
+TEST(LogTest, Preallocation) {
+    Log::destroy(test_log);
+
+    constexpr uint64_t CHUNK = 64 * 1024;
+    uint64_t used = 0;
+    {
+        Log log(test_log, {}, log_format::DEFAULT_SEGMENT_SIZE, CHUNK);
+        ASSERT_FALSE(log.open());
+        ASSERT_FALSE(log.write(Entry(to_bytes("a"), to_bytes("1"), false)));
+        used = log_format::HEADER_SIZE + EntryCodec::encode(Entry(to_bytes("a"), to_bytes("1"), false)).size();
+
+        // Either preallocated, or the filesystem declined and appends are plain
+        auto size = std::filesystem::file_size(test_log);
+        EXPECT_TRUE(size == used || size >= CHUNK);
+        ASSERT_FALSE(log.close());
+        EXPECT_EQ(std::filesystem::file_size(test_log), used);
+    }
+
+    // What a crash leaves behind: records followed by zeroed space
+    std::filesystem::resize_file(test_log, used + CHUNK);
+
+    {
+        Log log(test_log, {}, log_format::DEFAULT_SEGMENT_SIZE, CHUNK);
+        ASSERT_FALSE(log.open());
+        ASSERT_FALSE(log.write(Entry(to_bytes("b"), to_bytes("2"), false)));
+        ASSERT_FALSE(log.close());
+    }
+
+    Log log(test_log);
+    ASSERT_FALSE(log.open());
+    auto entries = read_all(log);
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0], Entry(to_bytes("a"), to_bytes("1"), false));
+    EXPECT_EQ(entries[1], Entry(to_bytes("b"), to_bytes("2"), false));
+
+    ASSERT_FALSE(log.close());
+    Log::destroy(test_log);
+}
+
+/**
+ * @brief Writes from many threads into small preallocated chunks and
+ *        segments, so the background zero-fill runs alongside appends,
+ *        rolls and trims, and checks that it never overwrites a record.
+ */
+TEST(LogTest, PreallocationFill) {
+    Log::destroy(test_log);
+
+    constexpr int THREADS = 8;
+    constexpr int PER_THREAD = 200;
+    const bytes val(100, std::byte{'v'});
+    {
+        Log log(test_log, {}, 64 * 1024, 4 * 1024);
+        ASSERT_FALSE(log.open());
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&log, &val, t] {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    auto key = to_bytes("k" + std::to_string(t) + "_" + std::to_string(i));
+                    EXPECT_FALSE(log.write(Entry(key, val, false)));
+                }
+            });
+        }
+        for (auto &th : threads) th.join();
+        ASSERT_GT(log.segments().size(), 2u);
+        ASSERT_FALSE(log.close());
+    }
+
+    Log log(test_log, {}, 64 * 1024, 4 * 1024);
+    ASSERT_FALSE(log.open());
+    auto entries = read_all(log);
+    ASSERT_EQ(entries.size(), static_cast<size_t>(THREADS * PER_THREAD));
+    std::set<bytes> keys;
+    for (const auto &ent : entries) {
+        EXPECT_EQ(ent.val_, val);
+        keys.insert(ent.key_);
+    }
+    EXPECT_EQ(keys.size(), entries.size());
+
+    ASSERT_FALSE(log.close());
+    Log::destroy(test_log);
+}
+
+/**
+ * @brief Checks that a zeroed header with a record after it ends the
+ *        active segment and is cut off on every replay path, so that
+ *        appends made after the reopen survive the next one, and that the
+ *        same hole in a sealed segment is reported as corruption.
+ */
+TEST(LogTest, ZeroHole) {
+    auto entry_of = [](const std::string &key) { return Entry(to_bytes(key), to_bytes("v"), false); };
+    auto replay_with = [](Log &log, int how) {
+        std::vector<Entry> out;
+        if (how == 0) return read_all(log);
+        if (how == 1) {
+            EXPECT_FALSE(log.replay([&](const RecordView &rec, const LogPosition &) {
+                out.emplace_back(std::get<EntryView>(rec));
+            }));
+        } else {
+            EXPECT_FALSE(log.replay_parallel(2, [&](std::span<const EntryView> ops) {
+                for (const auto &op : ops) out.emplace_back(op);
+            }));
+        }
+        return out;
+    };
+
+    for (int how = 0; how < 3; ++how) {
+        Log::destroy(test_log);
+        {
+            Log log(test_log, {}, log_format::DEFAULT_SEGMENT_SIZE, 0);
+            ASSERT_FALSE(log.open());
+            ASSERT_FALSE(log.write(entry_of("a")));
+            ASSERT_FALSE(log.close());
+        }
+        const auto good_size = std::filesystem::file_size(test_log);
+
+        // What a crash can leave behind: a group that never reached the disk, then one that did
+        {
+            std::ofstream out(test_log, std::ios::binary | std::ios::app);
+            const std::string zeros(32, '\0');
+            out.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+            auto late = EntryCodec::encode(entry_of("late"));
+            out.write(reinterpret_cast<const char *>(late.data()), static_cast<std::streamsize>(late.size()));
+        }
+
+        {
+            Log log(test_log, {}, log_format::DEFAULT_SEGMENT_SIZE, 0);
+            ASSERT_FALSE(log.open());
+            EXPECT_EQ(replay_with(log, how), std::vector<Entry>{ entry_of("a") }) << how;
+            EXPECT_EQ(std::filesystem::file_size(test_log), good_size) << how;
+            ASSERT_FALSE(log.write(entry_of("b")));
+            ASSERT_FALSE(log.close());
+        }
+
+        Log log(test_log, {}, log_format::DEFAULT_SEGMENT_SIZE, 0);
+        ASSERT_FALSE(log.open());
+        EXPECT_EQ(replay_with(log, how), (std::vector<Entry>{ entry_of("a"), entry_of("b") })) << how;
+        ASSERT_FALSE(log.close());
+    }
+
+    // The same hole at the start of a sealed segment
+    Log::destroy(test_log);
+    std::string sealed;
+    {
+        Log log(test_log, {}, 256, 0);
+        ASSERT_FALSE(log.open());
+        for (int i = 0; i < 40; ++i) ASSERT_FALSE(log.write(entry_of("key" + std::to_string(i))));
+        ASSERT_GT(log.segments().size(), 2u);
+        sealed = log.segment_path(log.segments().front());
+        ASSERT_FALSE(log.close());
+    }
+    {
+        std::fstream file(sealed, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(log_format::HEADER_SIZE);
+        const std::string zeros(EntryCodec::HEADER_SIZE, '\0');
+        file.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+    }
+    Log log(test_log, {}, 256, 0);
+    ASSERT_FALSE(log.open());
+    EXPECT_EQ(log.replay([](const RecordView &, const LogPosition &) {}), db_error::trailing_garbage);
+    EXPECT_EQ(log.replay_parallel(2, [](std::span<const EntryView>) {}), db_error::trailing_garbage);
+    ASSERT_FALSE(log.seek_to_first_entry());
+    auto first = log.read();
+    ASSERT_FALSE(first.has_value());
+    EXPECT_EQ(first.error(), db_error::trailing_garbage);
+    ASSERT_FALSE(log.close());
+    Log::destroy(test_log);
+}
+
+/**
+ * @brief Checks that @ref Log::replay visits the same records as
+ *        @ref Log::read across segments and batches, and that it cuts a
+ *        torn tail off the active segment.
+ */
+TEST(LogTest, MappedReplay) {
+    Log::destroy(test_log);
+
+    {
+        Log log(test_log, {}, 256);
+        ASSERT_FALSE(log.open());
+        for (int i = 0; i < 40; ++i)
+            ASSERT_FALSE(log.write(Entry(to_bytes("key" + std::to_string(i)), to_bytes("value"), i % 5 == 0)));
+        WriteBatch batch;
+        batch.put(to_bytes("b1"), to_bytes("x"));
+        batch.del(to_bytes("key1"));
+        ASSERT_FALSE(log.write(batch));
+        ASSERT_FALSE(log.close());
+    }
+
+    // Half a record at the end of the active segment
+    Log probe(test_log, {}, 256);
+    ASSERT_FALSE(probe.open());
+    const std::string active = probe.segment_path(probe.segments().back());
+    ASSERT_FALSE(probe.close());
+    const auto good_size = std::filesystem::file_size(active);
+    {
+        std::ofstream torn(active, std::ios::binary | std::ios::app);
+        auto partial = EntryCodec::encode(Entry(to_bytes("torn"), to_bytes("record"), false));
+        torn.write(reinterpret_cast<const char *>(partial.data()), 10);
+    }
+
+    Log log(test_log, {}, 256);
+    ASSERT_FALSE(log.open());
+    std::vector<Entry> viewed;
+    ASSERT_FALSE(log.replay([&](const RecordView &rec, const LogPosition &) {
+        if (auto *batch = std::get_if<BatchView>(&rec))
+            batch->for_each([&](const EntryView &op) { viewed.emplace_back(op); });
+        else
+            viewed.emplace_back(std::get<EntryView>(rec));
+    }));
+    EXPECT_EQ(std::filesystem::file_size(active), good_size);
+
+    ASSERT_EQ(viewed.size(), 42u);
+    EXPECT_EQ(viewed, read_all(log));
+
+    ASSERT_FALSE(log.close());
+    Log::destroy(test_log);
+}
+
+/**
+ * @brief Checks that @ref Log::replay_parallel, with ranges much smaller
+ *        than a segment, delivers the records of @ref Log::read in order,
+ *        and that it cuts a torn tail like the sequential paths.
+ */
+TEST(LogTest, ParallelReplay) {
+    Log::destroy(test_log);
+
+    {
+        Log log(test_log, {}, 2048);
+        ASSERT_FALSE(log.open());
+        for (int i = 0; i < 300; ++i) {
+            if (i % 50 == 0) {
+                WriteBatch batch;
+                batch.put(to_bytes("b" + std::to_string(i)), to_bytes("x"));
+                batch.del(to_bytes("key" + std::to_string(i - 1)));
+                ASSERT_FALSE(log.write(batch));
+            }
+            ASSERT_FALSE(log.write(Entry(to_bytes("key" + std::to_string(i)), to_bytes("value"), i % 9 == 0)));
+        }
+        ASSERT_FALSE(log.close());
+    }
+
+    Log probe(test_log);
+    ASSERT_FALSE(probe.open());
+    const std::string active = probe.segment_path(probe.segments().back());
+    ASSERT_FALSE(probe.close());
+    const auto good_size = std::filesystem::file_size(active);
+    {
+        std::ofstream torn(active, std::ios::binary | std::ios::app);
+        torn.write("\x01\x02\x03\x04\x05\x06\x07", 7);
+    }
+
+    Log log(test_log, {}, 2048);
+    ASSERT_FALSE(log.open());
+    std::vector<Entry> replayed;
+    size_t chunks = 0;
+    ASSERT_FALSE(log.replay_parallel(4, [&](std::span<const EntryView> ops) {
+        ++chunks;
+        for (const auto &op : ops) replayed.emplace_back(op);
+    }, std::nullopt, 64));
+    EXPECT_GT(chunks, log.segments().size());
+    EXPECT_EQ(std::filesystem::file_size(active), good_size);
+
+    auto expected = read_all(log);
+    ASSERT_EQ(expected.size(), 312u);
+    EXPECT_EQ(replayed, expected);
+
+    ASSERT_FALSE(log.close());
+    Log::destroy(test_log);
+}
+
+TEST(LogTest, ReadValue) {
+    Log::destroy(test_log);
+    Log log(test_log, {}, 256);
+    ASSERT_FALSE(log.open());
+
+    // Enough records to roll a few segments; each write reports where it went
+    std::vector<std::pair<ValueRef, bytes>> written;
+    for (int i = 0; i < 40; ++i) {
+        Entry ent(to_bytes("key" + std::to_string(i)), to_bytes("value" + std::to_string(i)), false);
+        LogPosition at;
+        ASSERT_FALSE(log.write(ent, &at));
+        written.push_back({ { at, static_cast<uint32_t>(EntryCodec::HEADER_SIZE + ent.key_.size() + ent.val_.size()),
+                              static_cast<uint32_t>(EntryCodec::HEADER_SIZE + ent.key_.size()),
+                              static_cast<uint32_t>(ent.val_.size()) }, ent.val_ });
+    }
+    ASSERT_GT(log.segments().size(), 2u);
+
+    // The positions replay reports are the ones the writes returned
+    size_t seen = 0;
+    ASSERT_FALSE(log.replay([&](const RecordView &, const LogPosition &at) {
+        ASSERT_LT(seen, written.size());
+        EXPECT_EQ(at, written[seen++].first.record_);
+    }));
+    EXPECT_EQ(seen, written.size());
+
+    for (const auto &[ref, val] : written)
+        EXPECT_EQ(log.read_value(ref).value(), val);
+
+    // A damaged record is reported instead of returned
+    const auto &[ref, val] = written.back();
+    {
+        std::fstream fs(log.segment_path(ref.record_.segment_), std::ios::in | std::ios::out | std::ios::binary);
+        fs.seekp(static_cast<std::streamoff>(ref.record_.offset_ + ref.val_offset_));
+        fs.put('X');
+    }
+    EXPECT_EQ(log.read_value(ref).error(), make_error_code(db_error::bad_checksum));
+    EXPECT_EQ(log.read_value({ { 999, log_format::HEADER_SIZE }, 20, 13, 7 }).error(),
+              make_error_code(db_error::missing_segment));
+
+    ASSERT_FALSE(log.close());
+    Log::destroy(test_log);
+}
+
+TEST(LogTest, HintFiles) {
+    Log::destroy(test_log);
+    Log log(test_log, SyncPolicy::none(), 256, log_format::DEFAULT_PREALLOC_SIZE, true);
+    ASSERT_FALSE(log.open());
+    for (int i = 0; i < 40; ++i) {
+        ASSERT_FALSE(log.write(Entry(to_bytes("key" + std::to_string(i % 15)), to_bytes("value" + std::to_string(i)), false)));
+        if (i % 10 == 9) {
+            WriteBatch batch;
+            batch.put(to_bytes("b" + std::to_string(i)), to_bytes("batched"));
+            batch.del(to_bytes("key3"));
+            ASSERT_FALSE(log.write(batch));
+        }
+    }
+    const auto ids = log.segments();
+    ASSERT_GT(ids.size(), 3u);
+
+    // The background writer hints every sealed segment, never the active one
+    for (int i = 0; i < 500 && !std::all_of(ids.begin(), ids.end() - 1, [&](uint64_t id) {
+             return std::filesystem::exists(log.hint_path(id)); }); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    for (size_t i = 0; i + 1 < ids.size(); ++i) EXPECT_TRUE(std::filesystem::exists(log.hint_path(ids[i])));
+    EXPECT_FALSE(std::filesystem::exists(log.hint_path(ids.back())));
+    EXPECT_EQ(log.write_hint(ids.back()), std::make_error_code(std::errc::invalid_argument));
+    ASSERT_FALSE(log.close());
+
+    auto collect = [](Log &log) {
+        std::vector<std::tuple<bytes, bool, uint64_t, uint64_t, uint32_t, uint32_t, uint32_t>> out;
+        auto err = log.replay_keys([&](const KeyRecord &rec) {
+            out.emplace_back(to_bytes(rec.key_), rec.deleted_, rec.ref_.record_.segment_, rec.ref_.record_.offset_,
+                             rec.ref_.size_, rec.ref_.val_offset_, rec.ref_.val_size_);
+        });
+        EXPECT_FALSE(err) << err.message();
+        return out;
+    };
+
+    // Damage a value in a sealed segment: the hints never read it
+    {
+        std::fstream fs(log.segment_path(ids[0]), std::ios::in | std::ios::out | std::ios::binary);
+        fs.seekp(static_cast<std::streamoff>(log_format::HEADER_SIZE + EntryCodec::HEADER_SIZE + 4));
+        fs.put('X');
+    }
+    Log reopened(test_log, SyncPolicy::none(), 256);
+    ASSERT_FALSE(reopened.open());
+    auto hinted = collect(reopened);
+    ASSERT_EQ(hinted.size(), 48u);
+    EXPECT_EQ(std::get<0>(hinted.front()), to_bytes("key0"));
+    EXPECT_EQ(reopened.read_value({ { std::get<2>(hinted[1]), std::get<3>(hinted[1]) },
+                                    std::get<4>(hinted[1]), std::get<5>(hinted[1]), std::get<6>(hinted[1]) }).value(),
+              to_bytes("value1"));
+
+    // Without its hint, or with a damaged one, the segment is scanned
+    std::filesystem::remove(reopened.hint_path(ids[0]));
+    EXPECT_EQ(reopened.replay_keys([](const KeyRecord &) {}), make_error_code(db_error::bad_checksum));
+    {
+        std::fstream fs(reopened.segment_path(ids[0]), std::ios::in | std::ios::out | std::ios::binary);
+        fs.seekp(static_cast<std::streamoff>(log_format::HEADER_SIZE + EntryCodec::HEADER_SIZE + 4));
+        fs.put('v');
+    }
+    {
+        std::fstream fs(reopened.hint_path(ids[1]), std::ios::in | std::ios::out | std::ios::binary);
+        fs.seekp(-1, std::ios::end);
+        fs.put('\0');
+    }
+    EXPECT_EQ(collect(reopened), hinted);
+
+    // Rebuilt on demand, and deleted along with the log
+    ASSERT_FALSE(reopened.write_hint(ids[0]));
+    EXPECT_EQ(collect(reopened), hinted);
+    ASSERT_FALSE(reopened.close());
+    Log::destroy(test_log);
+    EXPECT_FALSE(std::filesystem::exists(reopened.hint_path(ids[0])));
+    EXPECT_FALSE(std::filesystem::exists(reopened.hint_path(ids[1])));
+}
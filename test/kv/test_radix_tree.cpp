@@ -0,0 +1,143 @@
+// test/kv/test_radix_tree.cpp
+
+/**
+ * @file test_radix_tree.cpp
+ * @brief Unit tests for @ref RadixTree.
+ *
+ * Covers: insertion and erasure of keys that are prefixes of one another,
+ * node growth and shrinkage across all four node sizes, and bounded walks
+ * in both directions, all checked against an `std::set` model.
+ */
+
+#include <gtest/gtest.h>
+#include "kv/radix_tree.h"
+#include "core/types.h"     // bytes, to_bytes
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+
+/// Keys visited by @ref RadixTree::walk, stopping after @p limit.
+std::vector<bytes> walk(const RadixTree &tree, std::optional<std::span<const std::byte>> from, bool inclusive,
+                        bool reverse, size_t limit = SIZE_MAX) {
+    std::vector<bytes> out;
+    tree.walk(from, inclusive, reverse, [&](std::span<const std::byte> key) {
+        out.emplace_back(key.begin(), key.end());
+        return out.size() < limit;
+    });
+    return out;
+}
+
+/// What @ref walk should return, computed from @p model.
+std::vector<bytes> expected_walk(const std::set<bytes> &model, const bytes &from, bool inclusive, bool reverse,
+                                 size_t limit) {
+    std::vector<bytes> out;
+    if (!reverse) {
+        for (auto it = inclusive ? model.lower_bound(from) : model.upper_bound(from);
+             it != model.end() && out.size() < limit; ++it)
+            out.push_back(*it);
+    } else {
+        for (auto it = inclusive ? model.upper_bound(from) : model.lower_bound(from);
+             it != model.begin() && out.size() < limit;)
+            out.push_back(*--it);
+    }
+    return out;
+}
+
+} // namespace
+
+/**
+ * @brief Verifies insert/erase/contains and walk order on keys that are
+ *        prefixes of each other, including the empty key.
+ */
+TEST(RadixTreeTest, Basic) {
+    RadixTree tree;
+    EXPECT_TRUE(tree.empty());
+    EXPECT_TRUE(walk(tree, std::nullopt, true, false).empty());
+
+    for (const char *key : { "abc", "ab", "abcd", "b", "", "abd" })
+        EXPECT_TRUE(tree.insert(to_bytes(key)));
+    EXPECT_FALSE(tree.insert(to_bytes("ab")));
+    EXPECT_EQ(tree.size(), 6u);
+    EXPECT_TRUE(tree.contains(bytes{}));
+    EXPECT_FALSE(tree.contains(to_bytes("a")));
+
+    const std::vector<bytes> sorted = { bytes{}, to_bytes("ab"), to_bytes("abc"), to_bytes("abcd"),
+                                        to_bytes("abd"), to_bytes("b") };
+    EXPECT_EQ(walk(tree, std::nullopt, true, false), sorted);
+    EXPECT_EQ(walk(tree, std::nullopt, true, true), std::vector<bytes>(sorted.rbegin(), sorted.rend()));
+    EXPECT_EQ(walk(tree, to_bytes("abc"), false, false, 2), (std::vector<bytes>{ to_bytes("abcd"), to_bytes("abd") }));
+    EXPECT_EQ(walk(tree, to_bytes("abca"), true, true), (std::vector<bytes>{ to_bytes("abc"), to_bytes("ab"), bytes{} }));
+
+    EXPECT_TRUE(tree.erase(to_bytes("ab")));
+    EXPECT_FALSE(tree.erase(to_bytes("ab")));
+    EXPECT_TRUE(tree.contains(to_bytes("abc")));
+    EXPECT_TRUE(tree.erase(to_bytes("abc")));
+    EXPECT_EQ(walk(tree, to_bytes("a"), true, false),
+              (std::vector<bytes>{ to_bytes("abcd"), to_bytes("abd"), to_bytes("b") }));
+
+    RadixTree moved = std::move(tree);
+    EXPECT_EQ(moved.size(), 4u);
+    EXPECT_TRUE(tree.empty());
+    moved.clear();
+    EXPECT_TRUE(moved.empty());
+    EXPECT_FALSE(moved.contains(to_bytes("b")));
+}
+
+/**
+ * @brief Drives random inserts and erases over alphabets from 2 to 256
+ *        byte values, so every node size is grown into and shrunk out of,
+ *        checking bounded walks from random keys and finally draining the
+ *        tree in random order.
+ */
+TEST(RadixTreeTest, MatchesModel) {
+    std::mt19937 rng(7);
+    const int alphabets[] = { 2, 5, 20, 60, 256 };
+    for (int round = 0; round < 15; ++round) {
+        RadixTree tree;
+        std::set<bytes> model;
+        const int alphabet = alphabets[round % 5];
+        const size_t max_len = 1 + round % 7 * 6;
+        auto random_key = [&](size_t max) {
+            bytes key(rng() % (max + 1));
+            for (auto &b : key) b = std::byte(static_cast<uint8_t>(rng() % alphabet * (round % 3 ? 1 : 97)));
+            return key;
+        };
+
+        for (int i = 0; i < 20000; ++i) {
+            auto key = random_key(max_len);
+            if (rng() % 3 == 0) {
+                ASSERT_EQ(tree.erase(key), model.erase(key) == 1);
+            } else {
+                ASSERT_EQ(tree.insert(key), model.insert(key).second);
+            }
+            ASSERT_EQ(tree.size(), model.size());
+
+            if (i % 2000 != 0) continue;
+            ASSERT_EQ(walk(tree, std::nullopt, true, false), std::vector<bytes>(model.begin(), model.end()));
+            for (const auto &k : model) ASSERT_TRUE(tree.contains(k));
+            for (int q = 0; q < 50; ++q) {
+                const auto from = random_key(max_len + 1);
+                const size_t limit = rng() % 20 + 1;
+                for (bool inclusive : { false, true })
+                    for (bool reverse : { false, true })
+                        ASSERT_EQ(walk(tree, std::span<const std::byte>(from), inclusive, reverse, limit),
+                                  expected_walk(model, from, inclusive, reverse, limit));
+            }
+        }
+
+        std::vector<bytes> keys(model.begin(), model.end());
+        std::shuffle(keys.begin(), keys.end(), rng);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            ASSERT_TRUE(tree.erase(keys[i]));
+            model.erase(keys[i]);
+            if (i % 500 == 0) {
+                ASSERT_EQ(walk(tree, std::nullopt, true, true), std::vector<bytes>(model.rbegin(), model.rend()));
+            }
+        }
+        EXPECT_TRUE(tree.empty());
+    }
+}
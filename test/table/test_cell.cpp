@@ -66,3 +66,40 @@ TEST(CellTest, EncodeDecode) {
         ASSERT_TRUE(decode_buf.empty());
     }
 }
+
+/**
+ * @brief Checks the order-preserving key encoding of `i64` and `str` cells,
+ *        including a string with embedded zero bytes.
+ *
+ * Expected key formats:
+ * - `i64(-2)` → sign bit flipped, big-endian: `7F FF FF FF FF FF FF FE`
+ * - `str("a\0b")` → `61 00 FF 62` (escaped zero) + `00 01` (terminator)
+ */
+TEST(CellTest, KeyEncodeDecode) {
+    struct Case { Cell cell; Cell::Type type; bytes expected; };
+    const Case cases[] = {
+        { Cell::make_i64(-2), Cell::Type::i64, bytes{
+            std::byte{0x7f}, std::byte{0xff}, std::byte{0xff}, std::byte{0xff},
+            std::byte{0xff}, std::byte{0xff}, std::byte{0xff}, std::byte{0xfe} } },
+        { Cell::make_str(std::string_view("a\0b", 3)), Cell::Type::str, bytes{
+            std::byte{'a'}, std::byte{0x00}, std::byte{0xff}, std::byte{'b'},
+            std::byte{0x00}, std::byte{0x01} } },
+        { Cell::make_str(""), Cell::Type::str, bytes{ std::byte{0x00}, std::byte{0x01} } },
+    };
+    for (const auto &[cell, type, expected] : cases) {
+        bytes encoded;
+        ASSERT_FALSE(CellCodec::encode_key(cell, type, encoded));
+        EXPECT_EQ(encoded, expected);
+
+        // Trailing bytes belong to the next key column and are left alone
+        encoded.push_back(std::byte{0x42});
+        std::span<const std::byte> decode_buf(encoded);
+        auto decoded = CellCodec::decode_key(decode_buf, type);
+        ASSERT_TRUE(decoded.has_value());
+        EXPECT_EQ(decoded.value(), cell);
+        ASSERT_EQ(decode_buf.size(), 1u);
+    }
+
+    bytes encoded;
+    EXPECT_TRUE(CellCodec::encode_key(Cell::make_i64(1), Cell::Type::str, encoded));
+}
@@ -6,9 +6,10 @@
  *
  * Uses a concrete three-column schema (`time i64, src str, dst str`) with
  * a composite primary key of (`src`, `dst`) to verify the exact binary
- * layout and full round-trip correctness.
+ * layout and full round-trip correctness, and that keys in the ordered
+ * format sort like their primary keys.
  *
- * Expected key bytes:
+ * Expected key bytes (@ref KeyFormat::raw):
  * ```
  * 01 00 00 00       schema_id = 1 (LE)
  * 00                ID_SEPARATOR
@@ -27,10 +28,12 @@
 #include "table/row_codec.h"    // RowCodec
 #include "table/cell.h"         // Cell
 #include "table/schema.h"       // Schema, ColumnHeader
-#include "table/schema_codec.h" // SchemaCodec (included for completeness)
+#include "table/schema_codec.h" // SchemaCodec
+#include "core/db_error.h"      // db_error
 #include <vector>               // std::vector
 #include <string>               // std::string
 #include <cstdint>              // uint32_t
+#include <algorithm>            // std::ranges::sort
 
 /**
  * @brief Verifies key encoding, value encoding, and full decode round-trip
@@ -45,7 +48,8 @@ TEST(RowTest, BasicOps) {
             ColumnHeader{"src", Cell::Type::str},
             ColumnHeader{"dst", Cell::Type::str}
         },
-        std::vector<size_t>{1, 2}
+        std::vector<size_t>{1, 2},
+        KeyFormat::raw
     };
 
     auto row = Row{
@@ -70,3 +74,124 @@ TEST(RowTest, BasicOps) {
     ASSERT_FALSE(err_2);
     EXPECT_EQ(d_row, row);
 }
+
+/**
+ * @brief Verifies the ordered key layout of a composite (i64, str) key and
+ *        that sorting encoded keys bytewise sorts the rows by primary key.
+ */
+TEST(RowTest, OrderedKeys) {
+    auto schema = Schema{
+        7,
+        std::string{"events"},
+        std::vector<ColumnHeader>{
+            ColumnHeader{"note", Cell::Type::str},
+            ColumnHeader{"time", Cell::Type::i64},
+            ColumnHeader{"name", Cell::Type::str}
+        },
+        std::vector<size_t>{1, 2}
+    };
+    ASSERT_EQ(schema.key_format_, KeyFormat::ordered);
+
+    auto row = Row{ Cell::make_str("x"), Cell::make_i64(-1), Cell::make_str("a") };
+    auto key = bytes{
+        std::byte{7}, std::byte{0}, std::byte{0}, std::byte{0}, std::byte{0x00},
+        std::byte{0x7f}, std::byte{0xff}, std::byte{0xff}, std::byte{0xff},
+        std::byte{0xff}, std::byte{0xff}, std::byte{0xff}, std::byte{0xff},
+        std::byte{'a'}, std::byte{0x00}, std::byte{0x01}
+    };
+    auto e_key = RowCodec::encode_key(schema, row);
+    ASSERT_TRUE(e_key.has_value());
+    EXPECT_EQ(e_key.value(), key);
+
+    auto d_row = RowCodec::new_row(schema);
+    ASSERT_FALSE(RowCodec::decode_key(schema, d_row, key));
+    EXPECT_EQ(d_row[1], row[1]);
+    EXPECT_EQ(d_row[2], row[2]);
+
+    // Listed in primary-key order; the encoded keys must sort the same way
+    const std::vector<std::pair<int64_t, std::string>> pkeys = {
+        { INT64_MIN, "" }, { -300, "b" }, { -1, "" }, { -1, std::string("\0", 1) },
+        { -1, std::string("\0\0", 2) }, { -1, std::string("\0\x01", 2) }, { -1, "a" },
+        { -1, std::string("a\0", 2) }, { -1, "ab" }, { 0, "" }, { 1, "z" }, { 256, "a" },
+        { INT64_MAX, "zz" }
+    };
+    std::vector<bytes> keys;
+    for (const auto &[time, name] : pkeys) {
+        auto encoded = RowCodec::encode_key(schema, Row{ Cell::make_empty(), Cell::make_i64(time), Cell::make_str(name) });
+        ASSERT_TRUE(encoded.has_value());
+        keys.push_back(std::move(encoded.value()));
+
+        auto decoded = RowCodec::new_row(schema);
+        ASSERT_FALSE(RowCodec::decode_key(schema, decoded, keys.back()));
+        EXPECT_EQ(decoded[1], Cell::make_i64(time));
+        EXPECT_EQ(decoded[2], Cell::make_str(name));
+    }
+    auto sorted = keys;
+    std::ranges::sort(sorted);
+    EXPECT_EQ(sorted, keys);
+
+    // A string whose terminator is missing or whose escape is malformed
+    auto cut = key;
+    cut.pop_back();
+    EXPECT_EQ(RowCodec::decode_key(schema, d_row, cut), db_error::expect_more_data);
+    auto bad = key;
+    bad.back() = std::byte{0x02};
+    EXPECT_EQ(RowCodec::decode_key(schema, d_row, bad), std::errc::illegal_byte_sequence);
+}
+
+/**
+ * @brief Verifies that the key format survives a schema round-trip, that a
+ *        schema written without one reads as @ref KeyFormat::raw, and that an
+ *        unknown format is rejected.
+ */
+TEST(RowTest, SchemaKeyFormat) {
+    auto schema = Schema{ 3, "t", { { "id", Cell::Type::i64 } }, { 0 } };
+    auto encoded = SchemaCodec::encode(schema);
+    auto decoded = SchemaCodec::decode(encoded);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->key_format_, KeyFormat::ordered);
+
+    encoded.pop_back();
+    decoded = SchemaCodec::decode(encoded);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->key_format_, KeyFormat::raw);
+
+    encoded.push_back(std::byte{9});
+    EXPECT_EQ(SchemaCodec::decode(encoded).error(), db_error::unsupported_version);
+}
+
+/**
+ * @brief Verifies the secondary-index entry layout, its decoding, prefix
+ *        matching, and that index definitions survive a schema round-trip.
+ */
+TEST(RowTest, IndexKeys) {
+    auto schema = Schema{ 2, "users", { { "id", Cell::Type::i64 }, { "email", Cell::Type::str } }, { 0 } };
+    schema.indexes_ = { { "by_email", { 1 } } };
+
+    auto row = Row{ Cell::make_i64(5), Cell::make_str("a") };
+    auto key = bytes{
+        std::byte{2}, std::byte{0}, std::byte{0}, std::byte{0}, std::byte{0x01},
+        std::byte{'a'}, std::byte{0x00}, std::byte{0x01},
+        std::byte{0x80}, std::byte{0}, std::byte{0}, std::byte{0},
+        std::byte{0}, std::byte{0}, std::byte{0}, std::byte{5}
+    };
+    auto e_key = RowCodec::encode_index_key(schema, 0, row);
+    ASSERT_TRUE(e_key.has_value());
+    EXPECT_EQ(e_key.value(), key);
+
+    auto d_row = RowCodec::new_row(schema);
+    ASSERT_FALSE(RowCodec::decode_index_key(schema, 0, d_row, key));
+    EXPECT_EQ(d_row, row);
+
+    auto prefix = RowCodec::encode_index_prefix(schema, 0, Row{ Cell::make_str("a") });
+    ASSERT_TRUE(prefix.has_value());
+    EXPECT_TRUE(std::equal(prefix->begin(), prefix->end(), key.begin()));
+    EXPECT_EQ(RowCodec::encode_index_prefix(schema, 0, Row{ Cell::make_str("a"), Cell::make_str("b") }).error(),
+              db_error::inconsistent_length);
+
+    auto decoded = SchemaCodec::decode(SchemaCodec::encode(schema));
+    ASSERT_TRUE(decoded.has_value());
+    ASSERT_EQ(decoded->indexes_.size(), 1u);
+    EXPECT_EQ(decoded->indexes_[0].name_, "by_email");
+    EXPECT_EQ(decoded->indexes_[0].cols_, std::vector<size_t>{ 1 });
+}
@@ -286,3 +286,177 @@ TEST_F(TableTest, Persistence) {
     ASSERT_TRUE(sel.value());
     EXPECT_EQ(query[0].as_i64(), 123);
 }
+
+/**
+ * @brief Verifies primary-key range and prefix scans: bounds, partial
+ *        bounds, reverse order, limits, and that rows of other tables and
+ *        schema entries stay out of the range.
+ */
+TEST_F(TableTest, Scan) {
+    auto result = Table::create(kv, make_link_schema());
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+    Table &table = result.value();
+    auto other = Table::create(kv, Schema(0, "other", { { "id", Cell::Type::i64 } }, { 0 }));
+    ASSERT_TRUE(other.has_value()) << other.error().message();
+    ASSERT_TRUE(other->Insert(Row{ Cell::make_i64(1) }).value());
+
+    // (src, dst) for src in a..d and dst in 1..3, inserted out of order
+    for (const char *src : { "c", "a", "d", "b" }) {
+        for (const char *dst : { "3", "1", "2" }) {
+            Row row = table.new_row();
+            row[0] = Cell::make_i64(static_cast<int64_t>(src[0]) * 10 + dst[0] - '0');
+            row[1] = Cell::make_str(to_bytes(src));
+            row[2] = Cell::make_str(to_bytes(dst));
+            ASSERT_TRUE(table.Insert(row).value());
+        }
+    }
+
+    // Collects "srcdst" for each row, checking the decoded time column too
+    auto collect = [](std::expected<Table::Cursor, std::error_code> cursor) {
+        std::vector<std::string> out;
+        EXPECT_TRUE(cursor.has_value());
+        if (!cursor) return out;
+        Row row;
+        for (; cursor->valid(); cursor->next()) {
+            EXPECT_FALSE(cursor->row(row));
+            std::string key(reinterpret_cast<const char *>(row[1].as_str().data()), row[1].as_str().size());
+            key.append(reinterpret_cast<const char *>(row[2].as_str().data()), row[2].as_str().size());
+            EXPECT_EQ(row[0].as_i64(), key[0] * 10 + key[1] - '0');
+            out.push_back(key);
+        }
+        EXPECT_FALSE(cursor->error());
+        return out;
+    };
+    using Keys = std::vector<std::string>;
+    const Row b2 = { Cell::make_str(to_bytes("b")), Cell::make_str(to_bytes("2")) };
+    const Row c  = { Cell::make_str(to_bytes("c")) };
+
+    EXPECT_EQ(collect(table.Scan(std::nullopt, std::nullopt)),
+              (Keys{ "a1", "a2", "a3", "b1", "b2", "b3", "c1", "c2", "c3", "d1", "d2", "d3" }));
+    // A full lower bound is inclusive; a partial upper bound excludes every row under it
+    EXPECT_EQ(collect(table.Scan(b2, c)), (Keys{ "b2", "b3" }));
+    EXPECT_EQ(collect(table.Scan(c, std::nullopt)), (Keys{ "c1", "c2", "c3", "d1", "d2", "d3" }));
+    EXPECT_EQ(collect(table.Scan(std::nullopt, b2, { .reverse_ = true })), (Keys{ "b1", "a3", "a2", "a1" }));
+    EXPECT_EQ(collect(table.Scan(b2, std::nullopt, { .limit_ = 3 })), (Keys{ "b2", "b3", "c1" }));
+
+    EXPECT_EQ(collect(table.ScanPrefix(c)), (Keys{ "c1", "c2", "c3" }));
+    EXPECT_EQ(collect(table.ScanPrefix(c, { .reverse_ = true, .limit_ = 2 })), (Keys{ "c3", "c2" }));
+    EXPECT_EQ(collect(table.ScanPrefix(b2)), (Keys{ "b2" }));
+    EXPECT_EQ(collect(table.ScanPrefix(Row{ Cell::make_str(to_bytes("e")) })), Keys{});
+    EXPECT_EQ(collect(table.ScanPrefix({})).size(), 12u);
+
+    // Bounds must fit the key columns
+    const Row wrong_type = { Cell::make_i64(1) };
+    EXPECT_EQ(table.Scan(wrong_type, std::nullopt).error(), db_error::type_mismatch);
+    const Row too_long = { b2[0], b2[1], b2[1] };
+    EXPECT_EQ(table.ScanPrefix(too_long).error(), db_error::inconsistent_length);
+}
+
+/**
+ * @brief Verifies that secondary indexes follow every write: lookups by
+ *        indexed values after inserts, updates that move a row between
+ *        index values, upserts, deletes, a reopen, and schema validation.
+ */
+TEST_F(TableTest, SecondaryIndex) {
+    auto schema = Schema(0, "users", {
+        { "id",    Cell::Type::i64 },
+        { "email", Cell::Type::str },
+        { "city",  Cell::Type::str },
+        { "age",   Cell::Type::i64 },
+    }, { 0 });
+    schema.indexes_ = { { "by_email", { 1 } }, { "by_city_age", { 2, 3 } } };
+    auto result = Table::create(kv, schema);
+    ASSERT_TRUE(result.has_value()) << result.error().message();
+    Table &table = result.value();
+
+    auto user = [](int64_t id, const char *email, const char *city, int64_t age) {
+        return Row{ Cell::make_i64(id), Cell::make_str(email), Cell::make_str(city), Cell::make_i64(age) };
+    };
+    // Ids of the rows a lookup returns, in order
+    auto ids = [&](const char *index, const Row &values, ScanOptions options = {}) {
+        std::vector<int64_t> out;
+        auto cursor = table.Lookup(index, values, options);
+        EXPECT_TRUE(cursor.has_value());
+        if (!cursor) return out;
+        Row row;
+        for (; cursor->valid(); cursor->next()) {
+            EXPECT_FALSE(cursor->row(row));
+            out.push_back(row[0].as_i64());
+        }
+        EXPECT_FALSE(cursor->error());
+        return out;
+    };
+    using Ids = std::vector<int64_t>;
+
+    ASSERT_TRUE(table.Insert(user(1, "ann@x", "oslo", 30)).value());
+    ASSERT_TRUE(table.Insert(user(2, "bob@x", "oslo", 25)).value());
+    ASSERT_TRUE(table.Insert(user(3, "cat@x", "rome", 30)).value());
+    EXPECT_FALSE(table.Insert(user(3, "dup@x", "rome", 30)).value());
+
+    EXPECT_EQ(ids("by_email", { Cell::make_str("bob@x") }), Ids{ 2 });
+    EXPECT_EQ(ids("by_email", { Cell::make_str("dup@x") }), Ids{});
+    EXPECT_EQ(ids("by_city_age", { Cell::make_str("oslo") }), (Ids{ 2, 1 }));
+    EXPECT_EQ(ids("by_city_age", { Cell::make_str("oslo") }, { .reverse_ = true }), (Ids{ 1, 2 }));
+    EXPECT_EQ(ids("by_city_age", { Cell::make_str("oslo"), Cell::make_i64(30) }), Ids{ 1 });
+
+    // Lookups return whole rows
+    auto cursor = table.Lookup("by_email", Row{ Cell::make_str("cat@x") });
+    ASSERT_TRUE(cursor.has_value() && cursor->valid());
+    Row found;
+    ASSERT_FALSE(cursor->row(found));
+    EXPECT_EQ(found, user(3, "cat@x", "rome", 30));
+
+    // An update moves the row's entries; an unchanged row writes nothing
+    ASSERT_TRUE(table.Update(user(2, "bob@y", "rome", 25)).value());
+    EXPECT_FALSE(table.Update(user(2, "bob@y", "rome", 25)).value());
+    EXPECT_FALSE(table.Update(user(9, "ghost@x", "rome", 1)).value());
+    EXPECT_EQ(ids("by_email", { Cell::make_str("bob@x") }), Ids{});
+    EXPECT_EQ(ids("by_email", { Cell::make_str("bob@y") }), Ids{ 2 });
+    EXPECT_EQ(ids("by_city_age", { Cell::make_str("oslo") }), Ids{ 1 });
+    EXPECT_EQ(ids("by_city_age", { Cell::make_str("rome") }), (Ids{ 2, 3 }));
+    EXPECT_EQ(ids("by_email", { Cell::make_str("ghost@x") }), Ids{});
+
+    // Only the changed index is rewritten; the other keeps its entry
+    ASSERT_TRUE(table.Upsert(user(3, "cat@y", "rome", 30)).value());
+    ASSERT_TRUE(table.Upsert(user(4, "dan@x", "oslo", 40)).value());
+    EXPECT_EQ(ids("by_email", { Cell::make_str("cat@x") }), Ids{});
+    EXPECT_EQ(ids("by_email", { Cell::make_str("cat@y") }), Ids{ 3 });
+    EXPECT_EQ(ids("by_city_age", { Cell::make_str("rome"), Cell::make_i64(30) }), Ids{ 3 });
+
+    ASSERT_TRUE(table.Delete(Row{ Cell::make_i64(1), Cell::make_empty(), Cell::make_empty(), Cell::make_empty() }).value());
+    EXPECT_EQ(ids("by_email", { Cell::make_str("ann@x") }), Ids{});
+    EXPECT_EQ(ids("by_city_age", { Cell::make_str("oslo") }), Ids{ 4 });
+
+    // Index entries stay out of row scans
+    auto rows = table.Scan(std::nullopt, std::nullopt);
+    ASSERT_TRUE(rows.has_value());
+    size_t count = 0;
+    for (; rows->valid(); rows->next()) ++count;
+    EXPECT_EQ(count, 3u);
+
+    EXPECT_EQ(table.Lookup("by_name", Row{}).error(), db_error::index_not_found);
+    EXPECT_EQ(table.Lookup("by_email", Row{ Cell::make_i64(1) }).error(), db_error::type_mismatch);
+
+    // Indexes are part of the stored schema
+    ASSERT_FALSE(kv.close());
+    ASSERT_FALSE(kv.open());
+    auto reopened = Table::open(kv, "users");
+    ASSERT_TRUE(reopened.has_value()) << reopened.error().message();
+    ASSERT_EQ(reopened->schema().indexes_.size(), 2u);
+    EXPECT_EQ(reopened->schema().indexes_[1].cols_, (std::vector<size_t>{ 2, 3 }));
+    auto again = reopened->Lookup("by_email", Row{ Cell::make_str("bob@y") });
+    ASSERT_TRUE(again.has_value() && again->valid());
+    ASSERT_FALSE(again->row(found));
+    EXPECT_EQ(found, user(2, "bob@y", "rome", 25));
+
+    // Indexes must name distinct, existing, non-key columns
+    for (auto indexes : { std::vector<IndexHeader>{ { "pk", { 0 } } },
+                          std::vector<IndexHeader>{ { "none", {} } },
+                          std::vector<IndexHeader>{ { "far", { 7 } } },
+                          std::vector<IndexHeader>{ { "a", { 1 } }, { "a", { 2 } } } }) {
+        auto bad = schema;
+        bad.name_ = "bad";
+        bad.indexes_ = indexes;
+        EXPECT_EQ(Table::create(kv, bad).error(), std::errc::invalid_argument);
+    }
+}